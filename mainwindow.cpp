@@ -81,7 +81,10 @@ MainWindow::MainWindow(QWidget *parent)
 	zodiacScene->updateStyle();
 	zodiacView->updateStyle();
 
+	// build the logo in a single batch, so every node is arranged only once
+	zodiacScene->beginBatch();
 	createZodiacLogo(m_mainCtrl);
+	zodiacScene->endBatch();
 }
 
 void MainWindow::closeEvent(QCloseEvent *event)
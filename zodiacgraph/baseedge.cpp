@@ -2,10 +2,17 @@
 
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
+#include <QtMath>
+#include <QtNumeric>
 #include "edgearrow.h"
 #include "edgelabel.h"
 #include "utils.h"
 #include "scene.h"
+#include "view.h"
+
+static qreal distanceToPolyline(const QPointF &point, const QPolygonF &polyline);
+
+static bool segmentsIntersect(const QPointF &a1, const QPointF &a2, const QPointF &b1, const QPointF &b2);
 
 namespace zodiac
 {
@@ -19,7 +26,9 @@ namespace zodiac
 	QPen BaseEdge::s_pen = QPen(QBrush(s_color), s_width, Qt::SolidLine, Qt::RoundCap);
 
 	BaseEdge::BaseEdge(Scene *scene)
-			: QGraphicsObject(nullptr), m_scene(scene), m_arrow(nullptr), m_path(QPainterPath()), m_secondaryOpacity(0.), m_label(nullptr)
+			: QGraphicsObject(nullptr), m_scene(scene), m_arrow(nullptr), m_path(QPainterPath()),
+			  m_stroke(QPainterPath()), m_isStrokeValid(false), m_secondaryOpacity(0.), m_label(nullptr),
+			  m_labelText(QString()), m_isLabelStale(false)
 	{
 		m_scene->addItem(this);
 
@@ -29,6 +38,9 @@ namespace zodiac
 		// edges deform too much to be cached meaningfully
 		setCacheMode(NoCache);
 
+		// report translations to the spatial index of the scene
+		setFlag(ItemSendsGeometryChanges);
+
 		// by default, edges react to hover events
 		setAcceptHoverEvents(true);
 
@@ -42,6 +54,7 @@ namespace zodiac
 		m_secondaryFadeOut.setTargetObject(this);
 		m_secondaryFadeOut.setPropertyName("secondaryOpacity");
 		m_secondaryFadeOut.setEndValue(0.);
+		connect(&m_secondaryFadeOut, SIGNAL(finished()), this, SLOT(releaseLabel()));
 	}
 
 	BaseEdge::~BaseEdge()
@@ -51,29 +64,36 @@ namespace zodiac
 
 	void BaseEdge::setLabelText(const QString &text)
 	{
+		m_labelText = text;
+		if (!m_label)
+		{
+			return;
+		}
 		if (text.isEmpty())
 		{
 			// remove an existing label
-			if (m_label)
-			{
-				m_arrow->setLabel(nullptr);
-				m_scene->removeItem(m_label);
-				delete m_label;
-				m_label = nullptr;
-			}
+			deleteLabel();
 		} else
 		{
-			// create a new or modify an existing label
-			if (!m_label)
-			{
-				m_label = new EdgeLabel();
-				m_scene->addItem(m_label);
-				m_arrow->setLabel(m_label);
-			}
+			// modify the label that is currently shown
 			m_label->setText(text);
 		}
 	}
 
+	void BaseEdge::updateLabel()
+	{
+	}
+
+	void BaseEdge::invalidateLabel()
+	{
+		m_isLabelStale = true;
+		if (m_secondaryOpacity > 0.)
+		{
+			m_isLabelStale = false;
+			updateLabel();
+		}
+	}
+
 	void BaseEdge::setVisible(bool visible)
 	{
 		// if you turn invisible, make sure all secondaries are invisible too
@@ -81,6 +101,7 @@ namespace zodiac
 		{
 			m_secondaryFadeIn.stop(); // in case the secondaries are currently fading in
 			updateSecondaryOpacity(0.);
+			releaseLabel();
 		}
 		return QGraphicsObject::setVisible(visible);
 	}
@@ -95,14 +116,62 @@ namespace zodiac
 		update();
 	}
 
+	void BaseEdge::refreshGeometry()
+	{
+		updateShape();
+	}
+
+	void BaseEdge::setOffset(const QPointF &offset)
+	{
+		// the label is not a child item and has to be moved along manually
+		if (m_label)
+		{
+			QPointF delta = offset - pos();
+			m_label->moveBy(delta.x(), delta.y());
+		}
+		setPos(offset);
+	}
+
+	void BaseEdge::detach()
+	{
+		if (!scene())
+		{
+			return;
+		}
+		if (m_label)
+		{
+			m_scene->removeItem(m_label);
+		}
+		m_scene->removeItem(this);
+	}
+
+	void BaseEdge::attach()
+	{
+		if (scene())
+		{
+			return;
+		}
+		m_scene->addItem(this);
+		if (m_label)
+		{
+			m_scene->addItem(m_label);
+		}
+	}
+
 	QRectF BaseEdge::boundingRect() const
 	{
 		qreal overdraw = s_width / 2.;
 		return m_path.boundingRect().marginsAdded(QMarginsF(overdraw, overdraw, overdraw, overdraw));
 	}
 
-	void BaseEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /* widget */)
+	void BaseEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 	{
+		// the edge is already part of the tiles
+		if (isTileable() && View::isTiled(widget))
+		{
+			return;
+		}
+
 		painter->setClipRect(option->exposedRect);
 		painter->setPen(s_pen);
 		painter->drawPath(m_path);
@@ -110,11 +179,89 @@ namespace zodiac
 
 	QPainterPath BaseEdge::shape() const
 	{
-		return QPainterPathStroker(s_pen).createStroke(m_path);
+		if (!m_isStrokeValid)
+		{
+			m_stroke = QPainterPathStroker(s_pen).createStroke(m_path);
+			m_isStrokeValid = true;
+		}
+		return m_stroke;
+	}
+
+	bool BaseEdge::contains(const QPointF &point) const
+	{
+		if (!boundingRect().contains(point))
+		{
+			return false;
+		}
+		return distanceToPolyline(point, getCenterLine()) <= getHitRadius();
+	}
+
+	bool BaseEdge::collidesWithPath(const QPainterPath &path, Qt::ItemSelectionMode mode) const
+	{
+		if ((mode == Qt::IntersectsItemBoundingRect) || (mode == Qt::ContainsItemBoundingRect))
+		{
+			return QGraphicsObject::collidesWithPath(path, mode);
+		}
+
+		QPolygonF centerLine = getCenterLine();
+		if (mode == Qt::ContainsItemShape)
+		{
+			for (const QPointF &point: centerLine)
+			{
+				if (!path.contains(point))
+				{
+					return false;
+				}
+			}
+			return !centerLine.isEmpty();
+		}
+
+		if (!path.controlPointRect().intersects(boundingRect()))
+		{
+			return false;
+		}
+
+		// the center line enters the path
+		for (const QPointF &point: centerLine)
+		{
+			if (path.contains(point))
+			{
+				return true;
+			}
+		}
+		for (const QPolygonF &outline: path.toSubpathPolygons())
+		{
+			for (int index = 1; index < outline.size(); ++index)
+			{
+				for (int segment = 1; segment < centerLine.size(); ++segment)
+				{
+					if (segmentsIntersect(outline.at(index - 1), outline.at(index), centerLine.at(segment - 1),
+					                      centerLine.at(segment)))
+					{
+						return true;
+					}
+				}
+			}
+		}
+
+		// the path is small enough to lie completely on the edge
+		return (path.elementCount() > 0) && (distanceToPolyline(path.elementAt(0), centerLine) <= getHitRadius());
 	}
 
 	void BaseEdge::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
 	{
+		// generate the label text only now that it is about to be shown
+		if (m_isLabelStale)
+		{
+			m_isLabelStale = false;
+			updateLabel();
+		}
+
+		// the label item is only created when it is about to be shown
+		if (!m_label && !m_labelText.isEmpty())
+		{
+			createLabel();
+		}
 		if (m_label)
 		{
 			m_secondaryFadeIn.setStartValue(m_secondaryOpacity);
@@ -137,6 +284,63 @@ namespace zodiac
 		QGraphicsObject::hoverLeaveEvent(event);
 	}
 
+	QVariant BaseEdge::itemChange(GraphicsItemChange change, const QVariant &value)
+	{
+		if ((change == ItemPositionHasChanged) || (change == ItemSceneHasChanged) || (change == ItemVisibleHasChanged))
+		{
+			m_scene->markIndexDirty(this);
+		}
+		return QGraphicsObject::itemChange(change, value);
+	}
+
+	bool BaseEdge::isTileable() const
+	{
+		return false;
+	}
+
+	qreal BaseEdge::getHitRadius() const
+	{
+		return s_width / 2.;
+	}
+
+	void BaseEdge::setPath(QPainterPath &path)
+	{
+		m_path.swap(path);
+		m_isStrokeValid = false;
+	}
+
+	void BaseEdge::releaseLabel()
+	{
+		if (m_label && (m_secondaryOpacity <= 0.))
+		{
+			deleteLabel();
+		}
+	}
+
+	void BaseEdge::createLabel()
+	{
+		m_label = new EdgeLabel(m_scene);
+		m_label->setText(m_labelText);
+		m_label->setOpacity(m_secondaryOpacity);
+		if (scene())
+		{
+			m_scene->addItem(m_label); // a detached edge adds its label when it is attached again
+		}
+		m_arrow->setLabel(m_label);
+		placeArrowAt(.5);
+	}
+
+	void BaseEdge::deleteLabel()
+	{
+		m_arrow->setLabel(nullptr);
+		if (m_label->scene())
+		{
+			m_scene->removeItem(m_label);
+		}
+		delete m_label;
+		m_label = nullptr;
+	}
+
 	void BaseEdge::updateSecondaryOpacity(qreal opacity)
 	{
 		if (m_label)
@@ -145,4 +349,63 @@ namespace zodiac
 		}
 		m_secondaryOpacity = opacity;
 	}
+
 } // namespace zodiac
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER
+//
+
+///
+/// \brief Calculates the shortest distance from a point to a polyline.
+///
+/// \param point     Point to measure the distance from.
+/// \param polyline  Connected line segments, a single point is treated as a segment of length zero.
+///
+/// \return          Shortest distance, or infinity if the polyline is empty.
+///
+static qreal distanceToPolyline(const QPointF &point, const QPolygonF &polyline)
+{
+	if (polyline.isEmpty())
+	{
+		return qInf();
+	}
+	qreal minDistanceSquared = qInf();
+	for (int index = qMin(1, polyline.size() - 1); index < polyline.size(); ++index)
+	{
+		// project the point onto the segment and clamp it to its ends
+		QPointF start = polyline.at(qMax(0, index - 1));
+		QPointF segment = polyline.at(index) - start;
+		qreal lengthSquared = QPointF::dotProduct(segment, segment);
+		qreal fraction = lengthSquared > 0. ? qBound(0., QPointF::dotProduct(point - start, segment) / lengthSquared, 1.) : 0.;
+		QPointF delta = point - (start + (segment * fraction));
+		minDistanceSquared = qMin(minDistanceSquared, QPointF::dotProduct(delta, delta));
+	}
+	return qSqrt(minDistanceSquared);
+}
+
+///
+/// \brief Tests, whether two line segments intersect.
+///
+/// \param a1    Start of the first segment.
+/// \param a2    End of the first segment.
+/// \param b1    Start of the second segment.
+/// \param b2    End of the second segment.
+///
+/// \return      <i>true</i> if the segments cross or touch -- <i>false</i> otherwise.
+///
+static bool segmentsIntersect(const QPointF &a1, const QPointF &a2, const QPointF &b1, const QPointF &b2)
+{
+	QPointF a = a2 - a1;
+	QPointF b = b2 - b1;
+	qreal denominator = (a.x() * b.y()) - (a.y() * b.x());
+	if (qFuzzyIsNull(denominator))
+	{
+		return false; // parallel segments only touch in degenerate cases that do not matter for hit-testing
+	}
+	QPointF offset = b1 - a1;
+	qreal alongA = ((offset.x() * b.y()) - (offset.y() * b.x())) / denominator;
+	qreal alongB = ((offset.x() * a.y()) - (offset.y() * a.x())) / denominator;
+	return (alongA >= 0.) && (alongA <= 1.) && (alongB >= 0.) && (alongB <= 1.);
+}
@@ -34,6 +34,7 @@
 
 #include <QGraphicsObject>
 #include <QPen>
+#include <QPolygonF>
 #include <QPropertyAnimation>
 #include <QtGlobal>
 
@@ -102,14 +103,30 @@ namespace zodiac
 		///
 		/// \brief Sets the text of this edge's EdgeLabel.
 		///
-		/// To create a label, call setLabelText() with the text of the new label.
-		/// This function can also be used to redefine the text of an existing EdgeLabel.
-		/// And lastly, it is also used to delete the EdgeLabel by setting its text to "" (the empty string).
+		/// The EdgeLabel item itself only exists while the label is faded in on hover, so this only stores the text and
+		/// updates a label that is currently shown.
+		/// Setting the text to "" (the empty string) removes the label altogether.
 		///
 		/// \param [in] text    Text to set this label to. Remove an existing EdgeLabel by passing "" (the empty string).
 		///
 		virtual void setLabelText(const QString &text);
 
+		///
+		/// \brief Generates the text of this edge's EdgeLabel right away.
+		///
+		/// The default implementation does nothing, edges without a source for their label text have no label.
+		///
+		virtual void updateLabel();
+
+		///
+		/// \brief Marks the text of this edge's EdgeLabel as outdated.
+		///
+		/// Label texts are only needed when the label is faded in, so instead of regenerating the text on every change
+		/// of the graph, it is generated by updateLabel() right before the label is about to become visible.
+		/// If the label is visible already, it is updated immediately.
+		///
+		void invalidateLabel();
+
 		///
 		/// \brief Defines the visiblity of the BaseEdge.
 		///
@@ -133,6 +150,75 @@ namespace zodiac
 		///
 		virtual void updateStyle();
 
+		///
+		/// \brief Rebuilds the path, the bounds and the EdgeArrow of this edge from the current state of its ends.
+		///
+		/// Is called by the Scene once per frame for every edge that was marked with Scene::markEdgeDirty().
+		///
+		virtual void refreshGeometry();
+
+		///
+		/// \brief Translates the complete edge, including its EdgeLabel, away from its current geometry.
+		///
+		/// Used by the Scene to move edges rigidly while both of their ends are dragged by the same offset, without
+		/// rebuilding their path.
+		/// The offset is absolute, pass a null point to move the edge back onto its geometry.
+		///
+		/// \param [in] offset  Offset of the edge from its geometry.
+		///
+		void setOffset(const QPointF &offset);
+
+		///
+		/// \brief Tests, whether a point lies on this edge, without building its stroke.
+		///
+		/// \param [in] point   Point in local coordinates.
+		///
+		/// \return             <i>true</i> if the point is within getHitRadius() of the center line -- <i>false</i> otherwise.
+		///
+		bool contains(const QPointF &point) const;
+
+		///
+		/// \brief Tests, whether this edge collides with a path, without building its stroke.
+		///
+		/// The edge intersects the path if its center line enters the path or the path lies on the edge.
+		/// The edge is contained in the path, if every point of its center line is.
+		/// The bounding rect modes are handled by QGraphicsItem.
+		///
+		/// \param [in] path    Path in local coordinates.
+		/// \param [in] mode    How to test for the collision.
+		///
+		/// \return             <i>true</i> if the edge collides with the path -- <i>false</i> otherwise.
+		///
+		bool collidesWithPath(const QPainterPath &path, Qt::ItemSelectionMode mode = Qt::IntersectsItemShape) const;
+
+		///
+		/// \brief Removes this edge and its EdgeLabel from the Scene without deleting them.
+		///
+		/// Do not call this directly, use Scene::detachEdge() which keeps track of how often the edge was detached.
+		///
+		void detach();
+
+		///
+		/// \brief Adds an edge removed with detach() back to the Scene, along with its EdgeLabel.
+		///
+		void attach();
+
+		///
+		/// \brief The EdgeArrow of this edge.
+		///
+		/// \return EdgeArrow child item.
+		///
+		inline EdgeArrow *getArrow() const { return m_arrow; }
+
+		///
+		/// \brief Tests, whether this edge is currently part of the static content drawn by the TileCache of a View.
+		///
+		/// Tiled edges and their EdgeArrow%s skip their paint() call in View%s with an enabled TileCache.
+		///
+		/// \return <i>true</i> if the edge is drawn from the tiles -- <i>false</i> if it is always painted live.
+		///
+		virtual bool isTileable() const;
+
 	public: // static methods
 
 		///
@@ -248,6 +334,9 @@ namespace zodiac
 		///
 		/// \brief Exact boundary of the item used for collision detection among other things.
 		///
+		/// The stroke is only built when it is first needed after the path has changed.
+		/// Hit-testing through contains() and collidesWithPath() does not need it at all.
+		///
 		/// \return Shape in local coordinates.
 		///
 		QPainterPath shape() const;
@@ -266,6 +355,18 @@ namespace zodiac
 		///
 		void hoverLeaveEvent(QGraphicsSceneHoverEvent *event);
 
+		///
+		/// \brief Called when the state of this item changes.
+		///
+		/// Keeps the Scene's spatial index up-to-date when this edge is moved, added to or removed from the Scene.
+		///
+		/// \param [in] change  What has changed.
+		/// \param [in] value   New value of the change.
+		///
+		/// \return             Adjusted value.
+		///
+		QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
 		///
 		/// \brief Sets a new opacity value [0-1] for the secondary edge items.
 		///
@@ -284,6 +385,29 @@ namespace zodiac
 		///
 		virtual void updateShape() = 0;
 
+		///
+		/// \brief The center line of this edge as a polyline in local coordinates, used for hit-testing.
+		///
+		/// Is pure virtual in BaseEdge.
+		///
+		/// \return Center line of the edge.
+		///
+		virtual QPolygonF getCenterLine() const = 0;
+
+		///
+		/// \brief Distance from the center line, within which a point is on this edge.
+		///
+		/// \return Half the width of the edge.
+		///
+		virtual qreal getHitRadius() const;
+
+		///
+		/// \brief Replaces the path of this edge, should be called from updateShape().
+		///
+		/// \param [in] path    New path, is swapped with the current one.
+		///
+		void setPath(QPainterPath &path);
+
 	protected: // members
 
 		///
@@ -301,6 +425,16 @@ namespace zodiac
 		///
 		QPainterPath m_path;
 
+		///
+		/// \brief Stroke of the path returned by shape(), built lazily after the path has changed.
+		///
+		mutable QPainterPath m_stroke;
+
+		///
+		/// \brief Whether m_stroke matches the current path.
+		///
+		mutable bool m_isStrokeValid;
+
 		///
 		/// \brief Fade-in animation of this edge's secondary items.
 		///
@@ -353,13 +487,42 @@ namespace zodiac
 		///
 		static QPen s_pen;
 
+	private slots:
+
+		///
+		/// \brief Called, when the fade-out animation has finished, deletes the then invisible EdgeLabel.
+		///
+		void releaseLabel();
+
+	private: // methods
+
+		///
+		/// \brief Creates the EdgeLabel item showing the current label text, right before it is faded in.
+		///
+		void createLabel();
+
+		///
+		/// \brief Removes the EdgeLabel item from the Scene and deletes it.
+		///
+		void deleteLabel();
+
 	private: // members
 
 		///
-		/// \brief Label of this BaseEdge, can be <i>nullptr</i>.
+		/// \brief Label of this BaseEdge, only exists while it is (partially) visible -- <i>nullptr</i> otherwise.
 		///
 		EdgeLabel *m_label;
 
+		///
+		/// \brief Text of the label, also while there is no EdgeLabel item.
+		///
+		QString m_labelText;
+
+		///
+		/// \brief <i>true</i> if the label text has to be generated before the label is shown -- <i>false</i> otherwise.
+		///
+		bool m_isLabelStale;
+
 	};
 
 } // namespace zodiac
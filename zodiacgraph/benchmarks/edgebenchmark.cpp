@@ -0,0 +1,125 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+/// \file edgebenchmark.cpp
+///
+/// \brief Times the creation and removal of PlugEdge%s in a Scene, one at a time and in batches.
+///
+
+#include <chrono>
+#include <cstdio>
+
+#include <QApplication>
+#include <QList>
+#include <QVector>
+
+#include "node.h"
+#include "plug.h"
+#include "plugedge.h"
+#include "scene.h"
+
+static double getMilliseconds(const std::chrono::steady_clock::time_point &start);
+
+int main(int argc, char *argv[])
+{
+	QApplication app(argc, argv);
+
+	// every Node has one outgoing Plug, that connects to one incoming Plug of each of the next inPlugCount Nodes
+	const int nodeCount = 200;
+	const int inPlugCount = 50;
+	const int roundCount = 5;
+
+	zodiac::Scene scene(nullptr);
+	QVector<zodiac::Plug *> outPlugs;
+	QVector<zodiac::Plug *> inPlugs;
+	outPlugs.reserve(nodeCount);
+	inPlugs.reserve(nodeCount * inPlugCount);
+	for (int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+	{
+		zodiac::Node *node = scene.createNode(QString("node%1").arg(nodeIndex));
+		outPlugs.append(node->createPlug("out", zodiac::PlugDirection::OUT));
+		for (int plugIndex = 0; plugIndex < inPlugCount; ++plugIndex)
+		{
+			inPlugs.append(node->createPlug(QString("in%1").arg(plugIndex), zodiac::PlugDirection::IN));
+		}
+	}
+
+	for (int round = 0; round < roundCount; ++round)
+	{
+		// create and remove the edges one by one
+		QList<zodiac::PlugEdge *> edges;
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+		{
+			for (int plugIndex = 0; plugIndex < inPlugCount; ++plugIndex)
+			{
+				edges.append(scene.createEdge(outPlugs[(nodeIndex + plugIndex + 1) % nodeCount],
+				                              inPlugs[(nodeIndex * inPlugCount) + plugIndex]));
+			}
+		}
+		const double createTime = getMilliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+		for (zodiac::PlugEdge *edge: edges)
+		{
+			scene.removeEdge(edge);
+		}
+		const double removeTime = getMilliseconds(start);
+
+		// create and remove the same edges in a batch
+		edges.clear();
+		start = std::chrono::steady_clock::now();
+		scene.beginBatch();
+		for (int nodeIndex = 0; nodeIndex < nodeCount; ++nodeIndex)
+		{
+			for (int plugIndex = 0; plugIndex < inPlugCount; ++plugIndex)
+			{
+				edges.append(scene.createEdge(outPlugs[(nodeIndex + plugIndex + 1) % nodeCount],
+				                              inPlugs[(nodeIndex * inPlugCount) + plugIndex]));
+			}
+		}
+		scene.endBatch();
+		const double batchCreateTime = getMilliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+		scene.removeEdges(edges);
+		const double batchRemoveTime = getMilliseconds(start);
+
+		std::printf("%d edges: create %9.3f ms, remove %9.3f ms | batched create %9.3f ms, remove %9.3f ms\n",
+		            edges.size(), createTime, removeTime, batchCreateTime, batchRemoveTime);
+	}
+
+	return 0;
+}
+
+// HELPER
+
+///
+/// \brief Milliseconds passed since the given point in time.
+///
+static double getMilliseconds(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,161 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+/// \file plugarrangerbenchmark.cpp
+///
+/// \brief Checks zodiac::arrangePlugsOptimally() against a brute force search and compares it with the greedy
+/// zodiac::arrangePlugs() in time and quality.
+///
+/// Returns a non-zero exit code, if the exact solver ever misses the cheapest path.
+///
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <QVector>
+
+#include "plugarranger.h"
+
+static qreal getCheapestCost(const QVector<qreal> &costTable, const int rowCount, const int columnCount,
+                             QVector<bool> &usedColumns, const int row);
+static QVector<qreal> createCostTable(std::mt19937 &random, const int rowCount, const int columnCount);
+static double getMilliseconds(const std::chrono::steady_clock::time_point &start);
+
+int main()
+{
+	std::mt19937 random(42);
+
+	// the exact solver has to find the cheapest path in every small table
+	const int checkCount = 300;
+	for (int check = 0; check < checkCount; ++check)
+	{
+		const int rowCount = 1 + int(random() % 6);
+		const int columnCount = rowCount + int(random() % 3);
+		QVector<qreal> costTable = createCostTable(random, rowCount, columnCount);
+
+		QVector<int> path = zodiac::arrangePlugsOptimally(costTable, rowCount, columnCount);
+		QVector<int> sortedPath = path;
+		std::sort(sortedPath.begin(), sortedPath.end());
+		if (std::adjacent_find(sortedPath.begin(), sortedPath.end()) != sortedPath.end())
+		{
+			std::printf("%d x %d table: a zone was assigned twice\n", rowCount, columnCount);
+			return 1;
+		}
+
+		QVector<bool> usedColumns(columnCount, false);
+		const qreal cheapestCost = getCheapestCost(costTable, rowCount, columnCount, usedColumns, 0);
+		const qreal pathCost = zodiac::getPathCost(costTable, columnCount, path);
+		if (std::abs(pathCost - cheapestCost) > 1e-9)
+		{
+			std::printf("%d x %d table: cost %f instead of %f\n", rowCount, columnCount, pathCost, cheapestCost);
+			return 1;
+		}
+	}
+	std::printf("exact on %d random tables\n", checkCount);
+
+	// compare both solvers on tables of a realistic shape, with one zone more than plugs for odd plug counts
+	for (int plugCount: {8, 32, 64, 128, 256, 512, 1024, 2048})
+	{
+		const int zoneCount = plugCount + (plugCount % 2);
+		QVector<qreal> costTable = createCostTable(random, plugCount, zoneCount);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		QVector<int> greedyPath = zodiac::arrangePlugs(costTable, plugCount, zoneCount);
+		const double greedyTime = getMilliseconds(start);
+
+		start = std::chrono::steady_clock::now();
+		QVector<int> optimalPath = zodiac::arrangePlugsOptimally(costTable, plugCount, zoneCount);
+		const double optimalTime = getMilliseconds(start);
+
+		std::printf("%5d plugs: greedy %10.3f ms, cost %10.3f | optimal %10.3f ms, cost %10.3f\n", plugCount,
+		            greedyTime, zodiac::getPathCost(costTable, zoneCount, greedyPath),
+		            optimalTime, zodiac::getPathCost(costTable, zoneCount, optimalPath));
+	}
+
+	return 0;
+}
+
+// HELPER
+
+///
+/// \brief Finds the cost of the cheapest path through the remaining rows of the cost-table by trying all of them.
+///
+static qreal getCheapestCost(const QVector<qreal> &costTable, const int rowCount, const int columnCount,
+                             QVector<bool> &usedColumns, const int row)
+{
+	if (row == rowCount)
+	{
+		return 0.;
+	}
+	qreal cheapestCost = HUGE_VAL;
+	for (int column = 0; column < columnCount; ++column)
+	{
+		if (usedColumns[column])
+		{
+			continue;
+		}
+		usedColumns[column] = true;
+		cheapestCost = std::min(cheapestCost, costTable[(row * columnCount) + column]
+		                                      + getCheapestCost(costTable, rowCount, columnCount, usedColumns, row + 1));
+		usedColumns[column] = false;
+	}
+	return cheapestCost;
+}
+
+///
+/// \brief Builds a cost-table for Plug%s and zones in random directions, the same way a Node does.
+///
+static QVector<qreal> createCostTable(std::mt19937 &random, const int rowCount, const int columnCount)
+{
+	std::uniform_real_distribution<qreal> directions(-M_PI, M_PI);
+	std::uniform_real_distribution<qreal> priorities(1., 4.);
+	QVector<qreal> plugDirections(rowCount);
+	QVector<qreal> plugPriorities(rowCount);
+	for (int row = 0; row < rowCount; ++row)
+	{
+		plugDirections[row] = directions(random);
+		plugPriorities[row] = priorities(random);
+	}
+	QVector<qreal> zoneDirections(columnCount);
+	for (int column = 0; column < columnCount; ++column)
+	{
+		zoneDirections[column] = directions(random);
+	}
+
+	QVector<qreal> costTable;
+	zodiac::fillCostTable(costTable, plugDirections, plugPriorities, zoneDirections);
+	return costTable;
+}
+
+///
+/// \brief Milliseconds passed since the given point in time.
+///
+static double getMilliseconds(const std::chrono::steady_clock::time_point &start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
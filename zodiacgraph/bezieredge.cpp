@@ -1,8 +1,13 @@
 #include "bezieredge.h"
 
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
 #include "edgearrow.h"
 #include "node.h"
 #include "plug.h"
+#include "scene.h"
+#include "view.h"
 
 #include <cmath>
 
@@ -13,7 +18,8 @@ namespace zodiac
 	qreal BezierEdge::s_ctrlExpansionFactor = 0.4;
 
 	BezierEdge::BezierEdge(Scene *scene)
-			: BaseEdge(scene), m_startPoint(QPointF()), m_ctrlPoint1(QPointF()), m_ctrlPoint2(QPointF()), m_endPoint(QPointF())
+			: BaseEdge(scene), m_startPoint(QPointF()), m_ctrlPoint1(QPointF()), m_ctrlPoint2(QPointF()), m_endPoint(QPointF()),
+			  m_centerLine(QPolygonF())
 	{
 		// initialize the shape of the edge
 		updateShape();
@@ -34,19 +40,50 @@ namespace zodiac
 		m_arrow->setTransformation(edgeCenter, std::atan2(edgeDirection.y(), edgeDirection.x()));
 	}
 
+	void BezierEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+	{
+		// when the nodes are drawn as dots, the bend of the curve cannot be made out anyway
+		if (View::isDetailed(Node::getCoreRadius(), painter))
+		{
+			BaseEdge::paint(painter, option, widget);
+			return;
+		}
+		painter->setClipRect(option->exposedRect);
+		painter->setPen(s_pen);
+		painter->drawLine(m_startPoint, m_endPoint);
+	}
+
 	void BezierEdge::updateShape()
 	{
 		prepareGeometryChange();
+		m_scene->markIndexDirty(this);
 
 		// create the path
 		QPainterPath bezierPath;
 		bezierPath.moveTo(m_startPoint);
 		bezierPath.cubicTo(m_ctrlPoint1, m_ctrlPoint2, m_endPoint);
-		m_path.swap(bezierPath);
+		setPath(bezierPath);
+
+		// subdivide the center line for hit-testing
+		// with the maximal control point distance, 32 segments deviate less than a pixel from the curve
+		static const int SEGMENT_COUNT = 32;
+		m_centerLine.resize(SEGMENT_COUNT + 1);
+		for (int index = 0; index <= SEGMENT_COUNT; ++index)
+		{
+			qreal t = qreal(index) / SEGMENT_COUNT;
+			qreal u = 1. - t;
+			m_centerLine[index] = (m_startPoint * (u * u * u)) + (m_ctrlPoint1 * (3. * u * u * t))
+			                      + (m_ctrlPoint2 * (3. * u * t * t)) + (m_endPoint * (t * t * t));
+		}
 
 		placeArrowAt(0.5);
 	}
 
+	QPolygonF BezierEdge::getCenterLine() const
+	{
+		return m_centerLine;
+	}
+
 	QPointF BezierEdge::getCtrlPointFor(Plug *plug)
 	{
 		qreal factor;
@@ -69,7 +106,7 @@ namespace zodiac
 		// calculate the control point distance
 		qreal manhattanLength = (m_endPoint - m_startPoint).manhattanLength();
 		qreal ctrlDistance = qMin(s_maxCtrlDistance, manhattanLength * s_ctrlExpansionFactor);
-		return plug->scenePos() + ((plug->getNormal() * ctrlDistance).toPointF() * factor);
+		return plug->getExpansionScenePos() + ((plug->getNormal() * ctrlDistance).toPointF() * factor);
 	}
 
 } // namespace zodiac
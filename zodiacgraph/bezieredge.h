@@ -87,6 +87,15 @@ namespace zodiac
 		///
 		void placeArrowAt(qreal fraction) override;
 
+		///
+		/// \brief Paints this BezierEdge, as a straight line if its Node%s are too small to be drawn in detail.
+		///
+		/// \param [in] painter Painter used to paint the item.
+		/// \param [in] option  Provides style options for the item.
+		/// \param [in] widget  Optional widget that this item is painted on.
+		///
+		void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
 	public: // static methods
 
 		///
@@ -134,6 +143,15 @@ namespace zodiac
 		///
 		virtual void updateShape() override;
 
+		///
+		/// \brief The center line of this BezierEdge, the curve subdivided into straight segments.
+		///
+		/// Is subdivided once in updateShape(), not for every hit-test.
+		///
+		/// \return Center line of the edge.
+		///
+		QPolygonF getCenterLine() const override;
+
 		///
 		/// \brief Returns the position of the control point of the edge for a given Plug.
 		///
@@ -169,6 +187,13 @@ namespace zodiac
 		///
 		QPointF m_endPoint;
 
+	private: // members
+
+		///
+		/// \brief Center line of the BezierEdge in scene coordinates, updated with its path.
+		///
+		QPolygonF m_centerLine;
+
 	private: // static members
 
 		///
@@ -0,0 +1,589 @@
+#include "clusterlayer.h"
+
+#include <QHash>
+#include <QSet>
+
+#include "edgegroup.h"
+#include "edgegrouppair.h"
+#include "graphstore.h"
+#include "node.h"
+#include "plugedge.h"
+#include "scene.h"
+#include "straightdoubleedge.h"
+#include "straightedge.h"
+#include "viewportlayer.h"
+
+static bool fitsLinkCounts(zodiac::StraightEdge *edge, const QPair<int, int> &counts);
+
+namespace zodiac
+{
+
+	ClusterLink::ClusterLink()
+			: EdgeGroupInterface(), forwardCount(0), backwardCount(0)
+	{
+	}
+
+	QString ClusterLink::getLabelText()
+	{
+		return QString::number(forwardCount + backwardCount);
+	}
+
+	ClusterLayer::ClusterLayer(Scene *scene)
+			: QObject(scene), m_scene(scene), m_assignedClusters(QHash<SlotId, QString>()), m_isDetecting(false),
+			  m_zoomThreshold(0.25), m_minimumClusterSize(3), m_zoomFactor(1.), m_isCollapsed(false),
+			  m_isRebuildPending(false), m_detachedNodes(QSet<Node *>()), m_detachedEdges(QSet<BaseEdge *>()),
+			  m_aggregateNodes(QList<Node *>()), m_aggregateEdges(QList<StraightEdge *>()), m_links(QList<ClusterLink *>())
+	{
+	}
+
+	void ClusterLayer::setNodeCluster(Node *node, const QString &cluster)
+	{
+		if (cluster.isEmpty())
+		{
+			m_assignedClusters.remove(node->getGraphId());
+		} else
+		{
+			m_assignedClusters.insert(node->getGraphId(), cluster);
+		}
+		scheduleRebuild();
+	}
+
+	QString ClusterLayer::getNodeCluster(Node *node) const
+	{
+		return m_assignedClusters.value(node->getGraphId(), QString());
+	}
+
+	void ClusterLayer::setDetectingClusters(bool enabled)
+	{
+		m_isDetecting = enabled;
+		scheduleRebuild();
+	}
+
+	void ClusterLayer::setZoomThreshold(qreal threshold)
+	{
+		m_zoomThreshold = threshold;
+		scheduleRebuild();
+	}
+
+	void ClusterLayer::setMinimumClusterSize(int size)
+	{
+		m_minimumClusterSize = qMax(2, size);
+		scheduleRebuild();
+	}
+
+	void ClusterLayer::updateZoom(qreal zoomFactor)
+	{
+		m_zoomFactor = zoomFactor;
+		if (m_zoomFactor >= m_zoomThreshold)
+		{
+			expand();
+			return;
+		}
+		if (m_isCollapsed)
+		{
+			return;
+		}
+
+		// the Scene calls rebuild() once the batch is closed
+		if (m_scene->isInBatch())
+		{
+			m_isRebuildPending = true;
+		} else
+		{
+			collapse();
+		}
+	}
+
+	void ClusterLayer::invalidate()
+	{
+		if (m_isCollapsed)
+		{
+			scheduleRebuild();
+		}
+	}
+
+	void ClusterLayer::forgetNode(Node *node)
+	{
+		m_detachedNodes.remove(node);
+
+		// aggregate edges to an unclustered node cannot outlive it
+		for (int index = m_aggregateEdges.size() - 1; index >= 0; --index)
+		{
+			StraightEdge *edge = m_aggregateEdges.at(index);
+			if ((edge->getFromNode() == node) || (edge->getToNode() == node))
+			{
+				deleteAggregateEdge(index);
+			}
+		}
+	}
+
+	void ClusterLayer::forgetEdge(BaseEdge *edge)
+	{
+		m_detachedEdges.remove(edge);
+	}
+
+	void ClusterLayer::expand()
+	{
+		if (!m_isCollapsed)
+		{
+			return;
+		}
+		m_isCollapsed = false;
+
+		// delete the aggregate edges before the aggregates they are registered with
+		while (!m_aggregateEdges.isEmpty())
+		{
+			deleteAggregateEdge(m_aggregateEdges.size() - 1);
+		}
+		for (Node *aggregate: m_aggregateNodes)
+		{
+			m_scene->removeItem(aggregate);
+			delete aggregate;
+		}
+		m_aggregateNodes.clear();
+
+		// put the members and their edges back into the scene
+		for (Node *node: m_detachedNodes)
+		{
+			m_scene->attachNode(node);
+		}
+		m_detachedNodes.clear();
+		for (BaseEdge *edge: m_detachedEdges)
+		{
+			m_scene->attachEdge(edge);
+		}
+		m_detachedEdges.clear();
+
+		// the ViewportLayer pauses while the clusters are collapsed
+		m_scene->getViewportLayer()->scheduleUpdate();
+	}
+
+	void ClusterLayer::updateStyle()
+	{
+		for (Node *aggregate: m_aggregateNodes)
+		{
+			aggregate->updateStyle();
+		}
+		for (StraightEdge *edge: m_aggregateEdges)
+		{
+			edge->updateStyle();
+		}
+	}
+
+	void ClusterLayer::rebuild()
+	{
+		if (!m_isRebuildPending || m_scene->isInBatch())
+		{
+			return;
+		}
+		m_isRebuildPending = false;
+		if (m_zoomFactor >= m_zoomThreshold)
+		{
+			expand();
+		} else
+		{
+			collapse();
+		}
+	}
+
+	void ClusterLayer::scheduleRebuild()
+	{
+		if (m_isRebuildPending || (!m_isCollapsed && (m_zoomFactor >= m_zoomThreshold)))
+		{
+			return;
+		}
+		m_isRebuildPending = true;
+		QMetaObject::invokeMethod(this, "rebuild", Qt::QueuedConnection);
+	}
+
+	void ClusterLayer::collapse()
+	{
+		QList<QString> names;
+		QVector<int> clusters = findClusters(names);
+		if (names.isEmpty())
+		{
+			expand();
+			m_isCollapsed = true;
+			return;
+		}
+		m_isCollapsed = true;
+
+		// find the members that have items
+		const GraphStore &graph = m_scene->getGraph();
+		int nodeCount = graph.getNodeCount();
+		QSet<Node *> members;
+		for (int position = 0; position < nodeCount; ++position)
+		{
+			if (clusters.at(position) >= 0)
+			{
+				Node *node = m_scene->getNode(graph.getNodeIdAt(position));
+				if (node)
+				{
+					members.insert(node);
+				}
+			}
+		}
+		if (m_scene->isDraggingNodes() && !m_detachedNodes.contains(members))
+		{
+			m_scene->endNodeDrag();
+		}
+
+		// move every aggregate to the center of its cluster, reusing the existing ones
+		QVector<QPointF> centers(names.size(), QPointF());
+		QVector<int> sizes(names.size(), 0);
+		for (int position = 0; position < nodeCount; ++position)
+		{
+			int cluster = clusters.at(position);
+			if (cluster >= 0)
+			{
+				centers[cluster] += graph.getNodePos(graph.getNodeIdAt(position));
+				++sizes[cluster];
+			}
+		}
+		for (int cluster = 0; cluster < names.size(); ++cluster)
+		{
+			Node *aggregate;
+			if (cluster < m_aggregateNodes.size())
+			{
+				aggregate = m_aggregateNodes.at(cluster);
+				aggregate->setDisplayName(names.at(cluster));
+			} else
+			{
+				aggregate = new Node(m_scene, names.at(cluster));
+				aggregate->setFlag(QGraphicsItem::ItemIsMovable, false);
+				aggregate->setFlag(QGraphicsItem::ItemIsSelectable, false);
+				m_scene->addItem(aggregate);
+				m_aggregateNodes.append(aggregate);
+			}
+			aggregate->setPos(centers.at(cluster) / sizes.at(cluster));
+		}
+
+		// only put back the nodes that left their cluster and only take out the new members
+		for (Node *node: m_detachedNodes - members)
+		{
+			m_scene->attachNode(node);
+		}
+		for (Node *node: members - m_detachedNodes)
+		{
+			node->setSelected(false);
+			m_scene->detachNode(node);
+		}
+		m_detachedNodes.swap(members);
+
+		// find every edge touching a member and count the connections between the aggregates
+		QSet<BaseEdge *> edges;
+		QSet<EdgeGroupPair *> groupPairs;
+		FlatHashMap<QPair<Node *, Node *>, int> linkLookup;
+		QList<QPair<Node *, Node *> > linkEnds;
+		QVector<QPair<int, int> > linkCounts;
+		for (int position = 0; position < graph.getEdgeCount(); ++position)
+		{
+			SlotId edgeId = graph.getEdgeIdAt(position);
+			int fromPosition = graph.getNodePosition(graph.getPlugNode(graph.getEdgeFrom(edgeId)));
+			int toPosition = graph.getNodePosition(graph.getPlugNode(graph.getEdgeTo(edgeId)));
+			int fromCluster = clusters.at(fromPosition);
+			int toCluster = clusters.at(toPosition);
+			if ((fromCluster < 0) && (toCluster < 0))
+			{
+				continue;
+			}
+
+			// edges to nodes without items are only counted
+			PlugEdge *edge = m_scene->getEdge(edgeId);
+			if (edge)
+			{
+				edges.insert(edge);
+				EdgeGroupPair *edgeGroupPair = edge->getGroup()->getEdgeGroupPair();
+				if (!groupPairs.contains(edgeGroupPair))
+				{
+					groupPairs.insert(edgeGroupPair);
+					edges << edgeGroupPair->getFirstGroup()->getStraightEdge()
+					      << edgeGroupPair->getSecondGroup()->getStraightEdge() << edgeGroupPair->getDoubleEdge();
+				}
+			}
+
+			// connections within a cluster are not shown at all
+			if (fromCluster == toCluster)
+			{
+				continue;
+			}
+			Node *fromNode = fromCluster < 0 ? m_scene->getNode(graph.getNodeIdAt(fromPosition)) : m_aggregateNodes.at(fromCluster);
+			Node *toNode = toCluster < 0 ? m_scene->getNode(graph.getNodeIdAt(toPosition)) : m_aggregateNodes.at(toCluster);
+			if (!fromNode || !toNode)
+			{
+				continue;
+			}
+
+			// both directions between the same ends share a link
+			bool isForward = quintptr(fromNode) < quintptr(toNode);
+			QPair<Node *, Node *> key = isForward ? qMakePair(fromNode, toNode) : qMakePair(toNode, fromNode);
+			int link = linkLookup.value(key, -1);
+			if (link < 0)
+			{
+				link = linkEnds.size();
+				linkLookup.insert(key, link);
+				linkEnds.append(key);
+				linkCounts.append(qMakePair(0, 0));
+			}
+			if (isForward)
+			{
+				++linkCounts[link].first;
+			} else
+			{
+				++linkCounts[link].second;
+			}
+		}
+
+		// only put back the edges that do not touch a member anymore and only take out the new ones
+		for (BaseEdge *edge: m_detachedEdges - edges)
+		{
+			m_scene->attachEdge(edge);
+		}
+		for (BaseEdge *edge: edges - m_detachedEdges)
+		{
+			m_scene->detachEdge(edge);
+		}
+		m_detachedEdges.swap(edges);
+
+		// keep the aggregate edges whose ends and kind have not changed and update the counts of their links
+		QVector<bool> isLinkShown(linkEnds.size(), false);
+		for (int index = m_aggregateEdges.size() - 1; index >= 0; --index)
+		{
+			StraightEdge *edge = m_aggregateEdges.at(index);
+			bool isForward = quintptr(edge->getFromNode()) < quintptr(edge->getToNode());
+			QPair<Node *, Node *> key = isForward ? qMakePair(edge->getFromNode(), edge->getToNode())
+			                                      : qMakePair(edge->getToNode(), edge->getFromNode());
+			int link = linkLookup.value(key, -1);
+			if ((link < 0) || !fitsLinkCounts(edge, linkCounts.at(link)))
+			{
+				deleteAggregateEdge(index);
+				continue;
+			}
+			isLinkShown[link] = true;
+			ClusterLink *clusterLink = m_links.at(index);
+			if ((clusterLink->forwardCount != linkCounts.at(link).first)
+			    || (clusterLink->backwardCount != linkCounts.at(link).second))
+			{
+				clusterLink->forwardCount = linkCounts.at(link).first;
+				clusterLink->backwardCount = linkCounts.at(link).second;
+				edge->invalidateLabel();
+			}
+		}
+
+		// create the missing aggregate edges
+		for (int link = 0; link < linkEnds.size(); ++link)
+		{
+			if (isLinkShown.at(link))
+			{
+				continue;
+			}
+			ClusterLink *clusterLink = new ClusterLink();
+			clusterLink->forwardCount = linkCounts.at(link).first;
+			clusterLink->backwardCount = linkCounts.at(link).second;
+			const QPair<Node *, Node *> &ends = linkEnds.at(link);
+			if ((clusterLink->forwardCount > 0) && (clusterLink->backwardCount > 0))
+			{
+				m_aggregateEdges.append(new StraightDoubleEdge(m_scene, clusterLink, ends.first, ends.second));
+			} else if (clusterLink->forwardCount > 0)
+			{
+				m_aggregateEdges.append(new StraightEdge(m_scene, clusterLink, ends.first, ends.second));
+			} else
+			{
+				m_aggregateEdges.append(new StraightEdge(m_scene, clusterLink, ends.second, ends.first));
+			}
+			m_links.append(clusterLink);
+		}
+
+		// aggregates of clusters that have disappeared are no longer connected to anything
+		while (m_aggregateNodes.size() > names.size())
+		{
+			Node *aggregate = m_aggregateNodes.takeLast();
+			m_scene->removeItem(aggregate);
+			delete aggregate;
+		}
+	}
+
+	void ClusterLayer::deleteAggregateEdge(int index)
+	{
+		StraightEdge *edge = m_aggregateEdges.takeAt(index);
+		edge->getFromNode()->removeStraightEdge(edge);
+		edge->getToNode()->removeStraightEdge(edge);
+		m_scene->forgetEdge(edge);
+		m_scene->takeItem(edge);
+		delete edge;
+		delete m_links.takeAt(index);
+	}
+
+	QVector<int> ClusterLayer::findClusters(QList<QString> &names) const
+	{
+		const GraphStore &graph = m_scene->getGraph();
+		int nodeCount = graph.getNodeCount();
+		QVector<int> result(nodeCount, -1);
+		QVector<bool> isAssigned(nodeCount, false);
+		QList<QString> candidateNames;
+		QVector<int> sizes;
+
+		// user-defined clusters
+		QHash<QString, int> assignedIndices;
+		for (int position = 0; position < nodeCount; ++position)
+		{
+			QString cluster = m_assignedClusters.value(graph.getNodeIdAt(position), QString());
+			if (cluster.isEmpty())
+			{
+				continue;
+			}
+			int index = assignedIndices.value(cluster, -1);
+			if (index < 0)
+			{
+				index = candidateNames.size();
+				assignedIndices.insert(cluster, index);
+				candidateNames.append(cluster);
+				sizes.append(0);
+			}
+			isAssigned[position] = true;
+			result[position] = index;
+			++sizes[index];
+		}
+
+		// detected communities among the remaining nodes
+		if (m_isDetecting)
+		{
+			QVector<int> communities = detectCommunities(isAssigned);
+			QHash<int, int> communityIndices;
+			for (int position = 0; position < nodeCount; ++position)
+			{
+				if (isAssigned.at(position))
+				{
+					continue;
+				}
+				int index = communityIndices.value(communities.at(position), -1);
+				if (index < 0)
+				{
+					index = candidateNames.size();
+					communityIndices.insert(communities.at(position), index);
+					candidateNames.append(QString());
+					sizes.append(0);
+				}
+				result[position] = index;
+				++sizes[index];
+			}
+		}
+
+		// only keep clusters that are large enough and number them densely
+		QVector<int> keptIndices(candidateNames.size(), -1);
+		names.clear();
+		for (int index = 0; index < candidateNames.size(); ++index)
+		{
+			if (sizes.at(index) < m_minimumClusterSize)
+			{
+				continue;
+			}
+			keptIndices[index] = names.size();
+			QString count = QString::number(sizes.at(index));
+			names.append(candidateNames.at(index).isEmpty() ? count + " nodes" : candidateNames.at(index) + " (" + count + ")");
+		}
+		for (int position = 0; position < nodeCount; ++position)
+		{
+			if (result.at(position) >= 0)
+			{
+				result[position] = keptIndices.at(result.at(position));
+			}
+		}
+		return result;
+	}
+
+	QVector<int> ClusterLayer::detectCommunities(const QVector<bool> &isAssigned) const
+	{
+		static const int maxRounds = 20;
+
+		// collect the neighbours of every unassigned node
+		const GraphStore &graph = m_scene->getGraph();
+		int nodeCount = graph.getNodeCount();
+		QVector<QVector<int> > neighbours(nodeCount);
+		for (int position = 0; position < graph.getEdgeCount(); ++position)
+		{
+			SlotId edgeId = graph.getEdgeIdAt(position);
+			int fromPosition = graph.getNodePosition(graph.getPlugNode(graph.getEdgeFrom(edgeId)));
+			int toPosition = graph.getNodePosition(graph.getPlugNode(graph.getEdgeTo(edgeId)));
+			if (isAssigned.at(fromPosition) || isAssigned.at(toPosition))
+			{
+				continue;
+			}
+			neighbours[fromPosition].append(toPosition);
+			neighbours[toPosition].append(fromPosition);
+		}
+
+		// every node starts out as its own community
+		QVector<int> labels(nodeCount);
+		for (int position = 0; position < nodeCount; ++position)
+		{
+			labels[position] = position;
+		}
+
+		// let every node adopt the most frequent label of its neighbours until the communities are stable
+		QHash<int, int> frequencies;
+		for (int round = 0; round < maxRounds; ++round)
+		{
+			bool hasChanged = false;
+			for (int position = 0; position < nodeCount; ++position)
+			{
+				const QVector<int> &nodeNeighbours = neighbours.at(position);
+				if (nodeNeighbours.isEmpty())
+				{
+					continue;
+				}
+				frequencies.clear();
+				int bestLabel = labels.at(position);
+				int bestCount = 0;
+				for (int neighbour: nodeNeighbours)
+				{
+					int label = labels.at(neighbour);
+					int count = ++frequencies[label];
+					if ((count > bestCount) || ((count == bestCount) && (label < bestLabel)))
+					{
+						bestLabel = label;
+						bestCount = count;
+					}
+				}
+
+				// keep the current label on a tie, so the labels do not oscillate
+				if (frequencies.value(labels.at(position), 0) == bestCount)
+				{
+					continue;
+				}
+				labels[position] = bestLabel;
+				hasChanged = true;
+			}
+			if (!hasChanged)
+			{
+				break;
+			}
+		}
+		return labels;
+	}
+
+} // namespace zodiac
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER
+//
+
+///
+/// \brief Checks if an aggregate edge still has the right kind and direction for the counts of its link.
+///
+/// \param [in] edge    Aggregate edge whose ends are already known to match the link.
+/// \param [in] counts  Number of connections in forward and backward direction of the link.
+///
+/// \return             <i>true</i> if the edge can be kept -- <i>false</i> if it has to be created anew.
+///
+static bool fitsLinkCounts(zodiac::StraightEdge *edge, const QPair<int, int> &counts)
+{
+	bool isDouble = (counts.first > 0) && (counts.second > 0);
+	if (qobject_cast<zodiac::StraightDoubleEdge *>(edge))
+	{
+		return isDouble;
+	}
+	bool isForward = quintptr(edge->getFromNode()) < quintptr(edge->getToNode());
+	return !isDouble && (isForward == (counts.first > 0));
+}
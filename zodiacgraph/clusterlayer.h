@@ -0,0 +1,360 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_CLUSTERLAYER_H
+#define ZODIAC_CLUSTERLAYER_H
+
+///
+/// \file clusterlayer.h
+///
+/// \brief Contains the definition of the zodiac::ClusterLayer class.
+///
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include "edgegroupinterface.h"
+#include "flathashmap.h"
+#include "slotmap.h"
+
+namespace zodiac
+{
+
+	class BaseEdge;
+
+	class Node;
+
+	class Scene;
+
+	class StraightEdge;
+
+///
+/// \brief Connection between two aggregates (or an aggregate and a Node) of a collapsed ClusterLayer.
+///
+/// Is the EdgeGroupInterface of the StraightEdge standing in for all PlugEdge%s between its two ends.
+///
+	class Q_DECL_EXPORT ClusterLink final : public EdgeGroupInterface
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		ClusterLink();
+
+		///
+		/// \brief Generates a text used for the label of the aggregate edge.
+		///
+		/// \return The number of connections represented by this link.
+		///
+		QString getLabelText() override;
+
+	public: // members
+
+		///
+		/// \brief Number of PlugEdge%s from the start to the end of the link.
+		///
+		int forwardCount;
+
+		///
+		/// \brief Number of PlugEdge%s from the end to the start of the link.
+		///
+		int backwardCount;
+
+	};
+
+///
+/// \brief Semantic zoom for large graphs, collapses clusters of Node%s into single aggregate Node%s when zoomed out.
+///
+/// Below the zoom threshold, every cluster with at least getMinimumClusterSize() members is taken out of the Scene,
+/// along with all PlugEdge%s and StraightEdge%s touching its members.
+/// In its place, the ClusterLayer shows a single aggregate Node at the center of the cluster, connected to other
+/// aggregates and to unclustered Node%s with aggregate StraightEdge%s.
+/// The members are only put back into the Scene when the zoom rises above the threshold again, so the number of items
+/// follows what can actually be read on screen.
+///
+/// Clusters are either assigned by the user with setNodeCluster() or found by an automatic community detection pass
+/// (label propagation) over all unassigned Node%s, if enabled with setDetectingClusters().
+///
+/// Aggregates are not selectable or movable and are not part of the GraphStore.
+/// Any structural change to the Scene brings the collapsed clusters up to date the next time control returns to the
+/// event loop.
+/// The update is done in place: only Node%s and edges that joined or left a cluster are taken out of or put back into
+/// the Scene, and aggregates and aggregate edges are reused as long as their ends and kind have not changed.
+///
+	class Q_DECL_EXPORT ClusterLayer : public QObject
+	{
+	Q_OBJECT
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] scene   Scene whose Node%s to cluster, is also the Qt parent of this ClusterLayer.
+		///
+		explicit ClusterLayer(Scene *scene);
+
+		///
+		/// \brief Assigns a Node to a user-defined cluster.
+		///
+		/// All Node%s assigned to the same name are collapsed together, regardless of their connections.
+		///
+		/// \param [in] node    Node to assign.
+		/// \param [in] cluster Name of the cluster, pass an empty string to remove the assignment.
+		///
+		void setNodeCluster(Node *node, const QString &cluster);
+
+		///
+		/// \brief The name of the user-defined cluster of a Node.
+		///
+		/// \param [in] node    Node to look up.
+		///
+		/// \return             Name of the cluster, or an empty string if the Node was not assigned to a cluster.
+		///
+		QString getNodeCluster(Node *node) const;
+
+		///
+		/// \brief Enables or disables the automatic detection of clusters among the unassigned Node%s.
+		///
+		/// \param [in] enabled <i>true</i> to detect clusters -- <i>false</i> to only collapse assigned clusters.
+		///
+		void setDetectingClusters(bool enabled);
+
+		///
+		/// \brief Tests whether clusters are automatically detected among the unassigned Node%s.
+		///
+		/// \return <i>true</i> if clusters are detected -- <i>false</i> otherwise.
+		///
+		inline bool isDetectingClusters() const { return m_isDetecting; }
+
+		///
+		/// \brief Sets the zoom factor below which clusters are collapsed.
+		///
+		/// \param [in] threshold   New zoom threshold.
+		///
+		void setZoomThreshold(qreal threshold);
+
+		///
+		/// \brief The zoom factor below which clusters are collapsed.
+		///
+		/// \return Zoom threshold.
+		///
+		inline qreal getZoomThreshold() const { return m_zoomThreshold; }
+
+		///
+		/// \brief Sets the minimum number of members of a collapsible cluster.
+		///
+		/// \param [in] size    New minimum cluster size, must be at least 2.
+		///
+		void setMinimumClusterSize(int size);
+
+		///
+		/// \brief The minimum number of members of a collapsible cluster.
+		///
+		/// \return Minimum cluster size.
+		///
+		inline int getMinimumClusterSize() const { return m_minimumClusterSize; }
+
+		///
+		/// \brief Is called by a View whenever its zoom factor changes.
+		///
+		/// Collapses the clusters if the zoom drops below the threshold and expands them if it rises above it.
+		/// If the Scene is shown in several View%s, the last zoom factor reported wins.
+		///
+		/// \param [in] zoomFactor  New zoom factor of the View.
+		///
+		void updateZoom(qreal zoomFactor);
+
+		///
+		/// \brief Tests whether the clusters are currently collapsed.
+		///
+		/// \return <i>true</i> if the clusters are collapsed -- <i>false</i> otherwise.
+		///
+		inline bool isCollapsed() const { return m_isCollapsed; }
+
+		///
+		/// \brief Is called by the Scene before any structural change.
+		///
+		/// Schedules an update of collapsed clusters, the collapsed items stay out of the Scene in the meantime.
+		///
+		void invalidate();
+
+		///
+		/// \brief Makes sure that the ClusterLayer does not reference a Node that is about to be deleted.
+		///
+		/// Is called by Scene::forgetNode(), also deletes the aggregate edges to the Node.
+		///
+		/// \param [in] node    Node that is about to be deleted.
+		///
+		void forgetNode(Node *node);
+
+		///
+		/// \brief Makes sure that the ClusterLayer does not reference an edge that is about to be deleted.
+		///
+		/// Is called by Scene::forgetEdge().
+		///
+		/// \param [in] edge    Edge that is about to be deleted.
+		///
+		void forgetEdge(BaseEdge *edge);
+
+		///
+		/// \brief Puts all collapsed items back into the Scene and deletes the aggregates.
+		///
+		void expand();
+
+		///
+		/// \brief Applies style changes to the aggregate Node%s and edges.
+		///
+		void updateStyle();
+
+	public slots:
+
+		///
+		/// \brief Collapses or updates the clusters after invalidate(), if the zoom is still below the threshold.
+		///
+		/// Does nothing while the Scene is in a batch, the Scene calls this function again when the batch is closed.
+		///
+		void rebuild();
+
+	private: // methods
+
+		///
+		/// \brief Schedules a call to rebuild().
+		///
+		void scheduleRebuild();
+
+		///
+		/// \brief Takes the clusters out of the Scene and creates their aggregates, or updates them if they are collapsed.
+		///
+		/// Only applies the differences to the current state.
+		///
+		void collapse();
+
+		///
+		/// \brief Deletes an aggregate edge and its ClusterLink.
+		///
+		/// \param [in] index   Index of the edge in m_aggregateEdges.
+		///
+		void deleteAggregateEdge(int index);
+
+		///
+		/// \brief Assigns every Node in the GraphStore to a cluster.
+		///
+		/// \param [out] names  Display name of every cluster.
+		///
+		/// \return             Index of the cluster of every Node at its dense position, -1 for unclustered Node%s.
+		///
+		QVector<int> findClusters(QList<QString> &names) const;
+
+		///
+		/// \brief Finds communities among the unassigned Node%s with label propagation.
+		///
+		/// \param [in] isAssigned  Flag for every Node at its dense position, assigned Node%s are ignored.
+		///
+		/// \return                 Community label of every Node at its dense position.
+		///
+		QVector<int> detectCommunities(const QVector<bool> &isAssigned) const;
+
+	private: // members
+
+		///
+		/// \brief Scene whose Node%s are clustered.
+		///
+		Scene *m_scene;
+
+		///
+		/// \brief User-defined cluster of every assigned Node, by the Node's id in the GraphStore.
+		///
+		/// The assignment outlives the items of the Node, if they are released by the Scene.
+		///
+		QHash<SlotId, QString> m_assignedClusters;
+
+		///
+		/// \brief Whether clusters are detected among the unassigned Node%s.
+		///
+		bool m_isDetecting;
+
+		///
+		/// \brief Zoom factor below which clusters are collapsed.
+		///
+		qreal m_zoomThreshold;
+
+		///
+		/// \brief Minimum number of members of a collapsible cluster.
+		///
+		int m_minimumClusterSize;
+
+		///
+		/// \brief Last zoom factor reported by a View.
+		///
+		qreal m_zoomFactor;
+
+		///
+		/// \brief Whether the clusters are currently collapsed.
+		///
+		bool m_isCollapsed;
+
+		///
+		/// \brief Whether a call to rebuild() is pending.
+		///
+		bool m_isRebuildPending;
+
+		///
+		/// \brief Member Node%s taken out of the Scene.
+		///
+		QSet<Node *> m_detachedNodes;
+
+		///
+		/// \brief Edges taken out of the Scene.
+		///
+		QSet<BaseEdge *> m_detachedEdges;
+
+		///
+		/// \brief Aggregate Node%s standing in for the collapsed clusters, by the index of their cluster.
+		///
+		QList<Node *> m_aggregateNodes;
+
+		///
+		/// \brief Aggregate edges between the aggregates and unclustered Node%s.
+		///
+		QList<StraightEdge *> m_aggregateEdges;
+
+		///
+		/// \brief Links represented by the aggregate edges at the same index, owned by the ClusterLayer.
+		///
+		QList<ClusterLink *> m_links;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_CLUSTERLAYER_H
@@ -19,7 +19,7 @@ namespace zodiac
 	void DrawEdge::fromPlugToPoint(Plug *plug, const QPointF &endPoint)
 	{
 		// return early, if the shape of the edge has not changed
-		QPointF startPoint = plug->scenePos();
+		QPointF startPoint = plug->getExpansionScenePos();
 		if ((startPoint == m_startPoint) && (endPoint == m_endPoint))
 		{
 			return;
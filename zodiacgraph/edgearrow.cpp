@@ -6,6 +6,7 @@
 
 #include "edgelabel.h"
 #include "baseedge.h"
+#include "view.h"
 
 namespace zodiac
 {
@@ -98,8 +99,14 @@ namespace zodiac
 		return m_arrowPolygon.boundingRect();
 	}
 
-	void EdgeArrow::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /* widget */)
+	void EdgeArrow::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 	{
+		// skip arrows that are too small to be made out or that are already part of the tiles
+		if (!View::isReadable(getArrowLength(), painter) || (m_edge->isTileable() && View::isTiled(widget)))
+		{
+			return;
+		}
+
 		painter->setClipRect(option->exposedRect);
 		painter->setPen(Qt::NoPen);
 		painter->setBrush(QBrush(s_arrowColor));
@@ -85,6 +85,13 @@ namespace zodiac
 		///
 		inline void setKind(ArrowKind kind) { m_kind = kind; }
 
+		///
+		/// \brief The transformed arrow shape, as drawn by this EdgeArrow.
+		///
+		/// \return Arrow polygon in the coordinates of the BaseEdge.
+		///
+		inline const QPolygonF &getPolygon() const { return m_arrowPolygon; }
+
 	public: // static methods
 
 		///
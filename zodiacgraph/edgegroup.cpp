@@ -6,6 +6,7 @@
 #include "plug.h"
 #include "plugedge.h"
 #include "straightedge.h"
+#include "straightedgelayer.h"
 #include "scene.h"
 
 namespace zodiac
@@ -20,6 +21,7 @@ namespace zodiac
 		// create an invisible StraightEdge
 		m_straightEdge = new StraightEdge(m_scene, this, fromNode, toNode);
 		m_straightEdge->setVisible(false);
+		m_scene->getStraightEdgeLayer()->addEdge(m_straightEdge);
 
 		// let the StraightEdge request removal of this group
 		connect(m_straightEdge, SIGNAL(removalRequested()), this, SLOT(removalRequested()));
@@ -31,8 +33,10 @@ namespace zodiac
 
 		m_straightEdge->getFromNode()->removeStraightEdge(m_straightEdge);
 		m_straightEdge->getToNode()->removeStraightEdge(m_straightEdge);
+		m_scene->forgetEdge(m_straightEdge);
+		m_scene->getStraightEdgeLayer()->removeEdge(m_straightEdge);
 
-		m_scene->removeItem(m_straightEdge);
+		m_scene->takeItem(m_straightEdge);
 		delete m_straightEdge; // valgrind seems to mind a call to deleteLater() here... I've read it's not real but this works also
 		m_straightEdge = nullptr;
 	}
@@ -51,8 +55,7 @@ namespace zodiac
 		m_edges.insert(edge);
 
 		// update the labels
-		m_straightEdge->updateLabel();
-		m_pair->updateLabel();
+		updateLabelText();
 	}
 
 	void EdgeGroup::removeEdge(PlugEdge *edge)
@@ -78,6 +81,24 @@ namespace zodiac
 		updateLabelText();
 	}
 
+	void EdgeGroup::takeEdge(PlugEdge *edge)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_edges.contains(edge));
+#else
+		if (!m_edges.contains(edge))
+		{
+			return;
+		}
+#endif
+		m_edges.remove(edge);
+		if (edge->isBent())
+		{
+			--m_bentEdgesCount;
+			Q_ASSERT(m_bentEdgesCount >= 0);
+		}
+	}
+
 	void EdgeGroup::increaseBentCount()
 	{
 		++m_bentEdgesCount;
@@ -105,11 +126,6 @@ namespace zodiac
 		}
 	}
 
-	uint EdgeGroup::getHash() const
-	{
-		return getHashOf(m_fromNode, m_toNode);
-	}
-
 	bool EdgeGroup::isVisible() const
 	{
 		return m_straightEdge->isVisible();
@@ -127,7 +143,7 @@ namespace zodiac
 
 	void EdgeGroup::updateLabelText()
 	{
-		m_straightEdge->updateLabel();
+		m_straightEdge->invalidateLabel();
 		m_pair->updateLabel();
 	}
 
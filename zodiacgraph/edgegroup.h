@@ -105,6 +105,20 @@ namespace zodiac
 		///
 		void removeEdge(PlugEdge *edge);
 
+		///
+		/// \brief Removes an existing PlugEdge from this EdgeGroup without updating its visibility or labels.
+		///
+		/// Is used by the Scene to remove many PlugEdge%s at once.
+		/// Afterwards, the Scene either deletes the EdgeGroupPair or calls EdgeGroupPair::updateVisibility() and
+		/// updateLabelText() once.
+		///
+		/// Make sure that the PlugEdge is part of this EdgeGroup.
+		/// If it is not, this function will raise an assertion error in debug mode and do nothing in release mode.
+		///
+		/// \param [in] edge    Existing PlugEdge to remove.
+		///
+		void takeEdge(PlugEdge *edge);
+
 		///
 		/// \brief Increase the number of bent curves in this group.
 		///
@@ -127,11 +141,11 @@ namespace zodiac
 		void updateVisibility();
 
 		///
-		/// \brief The hash of this EdgeGroup, as calculated by \ref zodiac::EdgeGroup::getHashOf() "getHashOf()".
+		/// \brief The key of this EdgeGroup, as calculated by \ref zodiac::EdgeGroup::getKeyOf() "getKeyOf()".
 		///
-		/// \return Hash of this EdgeGroup..
+		/// \return Key of this EdgeGroup.
 		///
-		uint getHash() const;
+		inline QPair<Node *, Node *> getKey() const { return getKeyOf(m_fromNode, m_toNode); }
 
 		///
 		/// \brief <i>true</i> if the straight edge of this group is visible -- <i>false</i> otherwise.
@@ -169,6 +183,13 @@ namespace zodiac
 		///
 		inline EdgeGroupPair *getEdgeGroupPair() const { return m_pair; }
 
+		///
+		/// \brief The StraightEdge shown in place of the PlugEdge%s of this EdgeGroup.
+		///
+		/// \return This EdgeGroup's StraightEdge.
+		///
+		inline StraightEdge *getStraightEdge() const { return m_straightEdge; }
+
 		///
 		/// \brief Generates the label text for this EdgeGroup.
 		///
@@ -177,7 +198,9 @@ namespace zodiac
 		QString getLabelText();
 
 		///
-		/// \brief Updates the label text of the EdgeGroup's StraightEdge, as well as the StraightDouleEdge label.
+		/// \brief Marks the label text of the EdgeGroup's StraightEdge, as well as the StraightDouleEdge label as outdated.
+		///
+		/// The texts are generated once the labels are about to be shown.
 		///
 		void updateLabelText();
 
@@ -191,20 +214,19 @@ namespace zodiac
 	public: // static methods
 
 		///
-		/// \brief Calculates a hash value based on two nodes.
+		/// \brief The key under which the Scene registers the EdgeGroup connecting two Node%s.
 		///
 		/// The order of nodes matters.
+		/// Unlike a hash value, the key is unique for every directed pair of Node%s.
 		///
 		/// \param [in] fromNode    Node from which the PlugEdge%s originate.
 		/// \param [in] toNode      Target Node of the PlugEdge%s in this group.
-		/// \param [in] seed        Seed value for the <a href="http://doc.qt.io/qt-5/qhash.html#qHash-33">qhash</a>
-		///                         function.
 		///
-		/// \return                 Hash value of an EdgeGroup connecting the two given Node%s from fromNode to toNode.
+		/// \return                 Key of an EdgeGroup connecting the two given Node%s from fromNode to toNode.
 		///
-		static inline uint getHashOf(Node *fromNode, Node *toNode, uint seed = 0)
+		static inline QPair<Node *, Node *> getKeyOf(Node *fromNode, Node *toNode)
 		{
-			return qHash(QPair<Node *, Node *>(fromNode, toNode), seed);
+			return QPair<Node *, Node *>(fromNode, toNode);
 		}
 
 	private slots:
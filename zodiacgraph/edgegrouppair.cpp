@@ -9,6 +9,7 @@
 #include "plugedge.h"
 #include "scene.h"
 #include "straightdoubleedge.h"
+#include "straightedgelayer.h"
 
 namespace zodiac
 {
@@ -19,6 +20,7 @@ namespace zodiac
 	{
 		// upon creation, the PlugEdge creating the first EdgeGroup is still bent and visible.
 		m_edge->setVisible(false);
+		m_scene->getStraightEdgeLayer()->addEdge(m_edge);
 	}
 
 	EdgeGroupPair::~EdgeGroupPair()
@@ -35,8 +37,10 @@ namespace zodiac
 		// delete the double edge
 		m_edge->getFromNode()->removeStraightEdge(m_edge);
 		m_edge->getToNode()->removeStraightEdge(m_edge);
+		m_scene->forgetEdge(m_edge);
+		m_scene->getStraightEdgeLayer()->removeEdge(m_edge);
 
-		m_scene->removeItem(m_edge);
+		m_scene->takeItem(m_edge);
 		delete m_edge; // valgrind seems to mind a call to deleteLater() here... I've read it's not real but this works also
 		m_edge = nullptr;
 	}
@@ -70,9 +74,27 @@ namespace zodiac
 		m_secondGroup->updateVisibility();
 	}
 
+	void EdgeGroupPair::updateVisibility()
+	{
+		// let both groups start from scratch
+		hideDoubleEdge();
+
+		// an empty group has nothing to show
+		if (m_firstGroup->getEdgeCount() == 0)
+		{
+			m_firstGroup->setVisibility(false);
+		}
+		if (m_secondGroup->getEdgeCount() == 0)
+		{
+			m_secondGroup->setVisibility(false);
+		}
+
+		updateDoubleEdgeVisibility();
+	}
+
 	void EdgeGroupPair::updateLabel()
 	{
-		m_edge->updateLabel();
+		m_edge->invalidateLabel();
 	}
 
 	QString EdgeGroupPair::getLabelText()
@@ -86,6 +86,13 @@ namespace zodiac
 		///
 		inline EdgeGroup *getSecondGroup() const { return m_secondGroup; }
 
+		///
+		/// \brief The StraightDoubleEdge shown in place of both EdgeGroup%s.
+		///
+		/// \return This EdgeGroupPair's StraightDoubleEdge.
+		///
+		inline StraightDoubleEdge *getDoubleEdge() const { return m_edge; }
+
 		///
 		/// \brief Tests if none of the two EdgeGroup%s in this pair contain any PlugEdge%s.
 		///
@@ -104,7 +111,14 @@ namespace zodiac
 		void hideDoubleEdge();
 
 		///
-		/// \brief Updates the label of the DoubleStraightEdge.
+		/// \brief Re-evaluates which edges of the pair are visible, after PlugEdge%s were taken out of its groups.
+		///
+		/// The StraightEdge of an EdgeGroup that was emptied is hidden.
+		///
+		void updateVisibility();
+
+		///
+		/// \brief Marks the label of the DoubleStraightEdge as outdated.
 		///
 		void updateLabel();
 
@@ -2,7 +2,10 @@
 
 #include <QBrush>
 
+#include "itemcache.h"
+#include "scene.h"
 #include "utils.h"
+#include "view.h"
 
 namespace zodiac
 {
@@ -11,14 +14,14 @@ namespace zodiac
 	QColor EdgeLabel::s_color = QColor(200, 200, 200, 180);
 	qreal EdgeLabel::s_verticalOffset = 0.5;
 
-	EdgeLabel::EdgeLabel()
-			: QGraphicsSimpleTextItem(nullptr)
+	EdgeLabel::EdgeLabel(Scene *scene)
+			: QGraphicsSimpleTextItem(nullptr), m_scene(scene), m_cacheId(ItemCache::createId())
 	{
 		// the label does not react to mouse events
 		setAcceptHoverEvents(false);
 
-		// cache the label
-		setCacheMode(DeviceCoordinateCache);
+		// the label is cached in the budgeted ItemCache of the scene instead of Qt's unbounded item cache
+		setCacheMode(NoCache);
 
 		// define settings
 		setOpacity(0.); // start out hidden
@@ -26,6 +29,11 @@ namespace zodiac
 		updateStyle();
 	}
 
+	EdgeLabel::~EdgeLabel()
+	{
+		m_scene->getItemCache().remove(m_cacheId);
+	}
+
 	void EdgeLabel::setPos(qreal x, qreal y)
 	{
 		// apply offsets to the given position
@@ -34,6 +42,12 @@ namespace zodiac
 		QGraphicsItem::setPos(x, y);
 	}
 
+	void EdgeLabel::setText(const QString &text)
+	{
+		QGraphicsSimpleTextItem::setText(text);
+		m_scene->getItemCache().invalidate(m_cacheId);
+	}
+
 	void EdgeLabel::updateStyle()
 	{
 		// update the font, if the static label font has changed
@@ -47,6 +61,19 @@ namespace zodiac
 		{
 			setBrush(s_color);
 		}
+
+		m_scene->getItemCache().invalidate(m_cacheId);
+	}
+
+	void EdgeLabel::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+	{
+		if (View::isReadable(s_font.pointSizeF(), painter))
+		{
+			m_scene->getItemCache().draw(m_cacheId, painter, boundingRect(), [this, option, widget](QPainter *cachePainter)
+			{
+				QGraphicsSimpleTextItem::paint(cachePainter, option, widget);
+			});
+		}
 	}
 
 } // namespace zodiac
@@ -39,6 +39,8 @@
 namespace zodiac
 {
 
+	class Scene;
+
 ///
 /// \brief The label of a BaseEdge.
 ///
@@ -55,7 +57,23 @@ namespace zodiac
 		/// The EdgeLabel is a free-standing QGraphicsItem without a parent, even though it is closely managed by a
 		/// BaseEdge instance.
 		///
-		explicit EdgeLabel();
+		/// \param [in] scene  Scene containing the BaseEdge of this label.
+		///
+		explicit EdgeLabel(Scene *scene);
+
+		///
+		/// \brief Destructor.
+		///
+		/// EdgeLabel%s are deleted after every fade-out, so the cached pixmap and its entry are released right away.
+		///
+		~EdgeLabel();
+
+		///
+		/// \brief Sets the text of the label and invalidates its cached pixmap.
+		///
+		/// \param [in] text   New label text.
+		///
+		void setText(const QString &text);
 
 		///
 		/// \brief Extends the QGraphcisSimpleTextItem by adding an offset in relation to the size of the label.
@@ -76,6 +94,15 @@ namespace zodiac
 		///
 		void updateStyle();
 
+		///
+		/// \brief Paints this EdgeLabel, unless it is too small to be read.
+		///
+		/// \param [in] painter Painter used to paint the item.
+		/// \param [in] option  Provides style options for the item.
+		/// \param [in] widget  Optional widget that this item is painted on.
+		///
+		void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
 	public: // static methods
 
 		///
@@ -171,6 +198,18 @@ namespace zodiac
 		///
 		static inline void setVerticalOffset(qreal offset) { s_verticalOffset = offset; }
 
+	private: // members
+
+		///
+		/// \brief Scene containing the BaseEdge of this label.
+		///
+		Scene *m_scene;
+
+		///
+		/// \brief Key of this label in the ItemCache of its Scene.
+		///
+		quint64 m_cacheId;
+
 	private: // static members
 
 		///
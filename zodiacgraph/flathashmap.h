@@ -0,0 +1,346 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_FLATHASHMAP_H
+#define ZODIAC_FLATHASHMAP_H
+
+///
+/// \file flathashmap.h
+///
+/// \brief Contains the definition of the zodiac::FlatHashMap class.
+///
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+#include <QtGlobal>
+
+namespace zodiac
+{
+
+///
+/// \brief Default hash functor for the FlatHashMap.
+///
+/// Specialized for pointers and pairs of pointers, which are the keys used by the Scene registries.
+///
+	template<typename Key>
+	struct FlatHash;
+
+///
+/// \brief Hashes a pointer by mixing all of its bits (the finalizer of splitmix64).
+///
+	template<typename T>
+	struct FlatHash<T *>
+	{
+		///
+		/// \brief Hash function.
+		///
+		/// \param [in] key Pointer to hash.
+		///
+		/// \return         64-bit hash of the pointer.
+		///
+		inline quint64 operator()(T *key) const
+		{
+			quint64 hash = quint64(quintptr(key));
+			hash = (hash ^ (hash >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+			hash = (hash ^ (hash >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+			return hash ^ (hash >> 31);
+		}
+	};
+
+///
+/// \brief Hashes an ordered pair by combining the hashes of both elements.
+///
+	template<typename A, typename B>
+	struct FlatHash<QPair<A, B>>
+	{
+		///
+		/// \brief Hash function.
+		///
+		/// \param [in] key Pair to hash.
+		///
+		/// \return         64-bit hash of the pair.
+		///
+		inline quint64 operator()(const QPair<A, B> &key) const
+		{
+			quint64 first = FlatHash<A>()(key.first);
+			return first ^ (FlatHash<B>()(key.second) + Q_UINT64_C(0x9e3779b97f4a7c15) + (first << 6) + (first >> 2));
+		}
+	};
+
+///
+/// \brief An open-addressing hash map storing its entries in a single flat array.
+///
+/// Unlike QHash, the FlatHashMap does not allocate a node per entry and resolves collisions by linear probing through
+/// neighboring entries, which is friendly to the cache.
+/// Removal uses backward shifting, so there are no tombstones and lookups never degrade after many removals.
+///
+/// Keys are always compared in full, two different keys with the same hash never share an entry.
+/// Key and value types need to be default-constructible and copyable, pointers are explicitly intended.
+///
+	template<typename Key, typename Value, typename Hash = FlatHash<Key>>
+	class FlatHashMap
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		FlatHashMap()
+				: m_entries(QVector<Entry>()), m_size(0) {}
+
+		///
+		/// \brief Number of entries in the map.
+		///
+		/// \return Number of entries.
+		///
+		inline int size() const { return m_size; }
+
+		///
+		/// \brief Tests whether the map is empty.
+		///
+		/// \return <i>true</i> if the map has no entries -- <i>false</i> otherwise.
+		///
+		inline bool isEmpty() const { return m_size == 0; }
+
+		///
+		/// \brief Tests whether the map contains a key.
+		///
+		/// \param [in] key Key to look for.
+		///
+		/// \return         <i>true</i> if the key was found -- <i>false</i> otherwise.
+		///
+		inline bool contains(const Key &key) const { return findSlot(key) >= 0; }
+
+		///
+		/// \brief Looks up the value of a key.
+		///
+		/// \param [in] key             Key to look for.
+		/// \param [in] defaultValue    Value to return, if the key is not in the map.
+		///
+		/// \return                     The value of the key or the default value.
+		///
+		inline Value value(const Key &key, const Value &defaultValue = Value()) const
+		{
+			int slot = findSlot(key);
+			return slot >= 0 ? m_entries.at(slot).value : defaultValue;
+		}
+
+		///
+		/// \brief Inserts a new entry or replaces the value of an existing one.
+		///
+		/// \param [in] key     Key of the entry.
+		/// \param [in] value   Value of the entry.
+		///
+		void insert(const Key &key, const Value &value)
+		{
+			// keep the load factor at or below 3/4
+			if ((m_size + 1) * 4 > m_entries.size() * 3)
+			{
+				rehash(qMax(16, m_entries.size() * 2));
+			}
+
+			int mask = m_entries.size() - 1;
+			int slot = int(Hash()(key) & quint64(mask));
+			while (m_entries.at(slot).isUsed)
+			{
+				if (m_entries.at(slot).key == key)
+				{
+					m_entries[slot].value = value;
+					return;
+				}
+				slot = (slot + 1) & mask;
+			}
+			Entry &entry = m_entries[slot];
+			entry.key = key;
+			entry.value = value;
+			entry.isUsed = true;
+			++m_size;
+		}
+
+		///
+		/// \brief Removes an entry from the map.
+		///
+		/// \param [in] key Key of the entry to remove.
+		///
+		/// \return         <i>true</i> if an entry was removed -- <i>false</i> if the key was not in the map.
+		///
+		bool remove(const Key &key)
+		{
+			int slot = findSlot(key);
+			if (slot < 0)
+			{
+				return false;
+			}
+
+			// shift following entries of the same probe sequence back into the hole
+			int mask = m_entries.size() - 1;
+			int hole = slot;
+			int next = (hole + 1) & mask;
+			while (m_entries.at(next).isUsed)
+			{
+				int home = int(Hash()(m_entries.at(next).key) & quint64(mask));
+				// move the entry, if its home slot is not cyclically in (hole, next]
+				if (((next - home) & mask) >= ((next - hole) & mask))
+				{
+					m_entries[hole] = m_entries.at(next);
+					hole = next;
+				}
+				next = (next + 1) & mask;
+			}
+			m_entries[hole] = Entry();
+			--m_size;
+			return true;
+		}
+
+		///
+		/// \brief Removes all entries from the map.
+		///
+		void clear()
+		{
+			m_entries.clear();
+			m_size = 0;
+		}
+
+		///
+		/// \brief Reserves enough space to hold the given number of entries without rehashing.
+		///
+		/// \param [in] count   Number of entries.
+		///
+		void reserve(int count)
+		{
+			int capacity = 16;
+			while (count * 4 > capacity * 3)
+			{
+				capacity *= 2;
+			}
+			if (capacity > m_entries.size())
+			{
+				rehash(capacity);
+			}
+		}
+
+		///
+		/// \brief All values in the map in no particular order.
+		///
+		/// \return All values.
+		///
+		QList<Value> values() const
+		{
+			QList<Value> result;
+			result.reserve(m_size);
+			for (const Entry &entry: m_entries)
+			{
+				if (entry.isUsed)
+				{
+					result.append(entry.value);
+				}
+			}
+			return result;
+		}
+
+	private: // methods
+
+		///
+		/// \brief Finds the slot of a key.
+		///
+		/// \param [in] key Key to look for.
+		///
+		/// \return         Slot of the key or -1, if the key is not in the map.
+		///
+		int findSlot(const Key &key) const
+		{
+			if (m_size == 0)
+			{
+				return -1;
+			}
+			int mask = m_entries.size() - 1;
+			int slot = int(Hash()(key) & quint64(mask));
+			while (m_entries.at(slot).isUsed)
+			{
+				if (m_entries.at(slot).key == key)
+				{
+					return slot;
+				}
+				slot = (slot + 1) & mask;
+			}
+			return -1;
+		}
+
+		///
+		/// \brief Re-inserts all entries into a new array of the given capacity.
+		///
+		/// \param [in] capacity    New capacity, must be a power of two.
+		///
+		void rehash(int capacity)
+		{
+			QVector<Entry> oldEntries(capacity);
+			oldEntries.swap(m_entries);
+			int mask = capacity - 1;
+			for (const Entry &entry: oldEntries)
+			{
+				if (!entry.isUsed)
+				{
+					continue;
+				}
+				int slot = int(Hash()(entry.key) & quint64(mask));
+				while (m_entries.at(slot).isUsed)
+				{
+					slot = (slot + 1) & mask;
+				}
+				m_entries[slot] = entry;
+			}
+		}
+
+	private: // members
+
+		///
+		/// \brief A single entry in the flat array.
+		///
+		struct Entry
+		{
+			Entry()
+					: key(Key()), value(Value()), isUsed(false) {}
+
+			Key key;
+			Value value;
+			bool isUsed;
+		};
+
+		///
+		/// \brief All entries, the size is always zero or a power of two.
+		///
+		QVector<Entry> m_entries;
+
+		///
+		/// \brief Number of used entries.
+		///
+		int m_size;
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_FLATHASHMAP_H
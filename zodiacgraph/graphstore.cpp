@@ -0,0 +1,847 @@
+#include "graphstore.h"
+
+#include <QMarginsF>
+#include <cmath>
+
+namespace zodiac
+{
+
+	GraphStore::GraphStore()
+			: m_nodeIds(SlotIndex()), m_plugIds(SlotIndex()), m_edgeIds(SlotIndex()),
+			  m_nodeX(QVector<qreal>()), m_nodeY(QVector<qreal>()), m_nodeRadius(QVector<qreal>()),
+			  m_nodeName(QVector<QString>()), m_nodeUuid(QVector<QUuid>()), m_nodePlugs(QVector<QVector<int>>()),
+			  m_plugNode(QVector<int>()), m_plugName(QVector<NameAtom>()), m_plugDirection(QVector<PlugDirection>()),
+			  m_plugNormalX(QVector<qreal>()), m_plugNormalY(QVector<qreal>()), m_plugEdges(QVector<QVector<int>>()),
+			  m_edgeFrom(QVector<int>()), m_edgeTo(QVector<int>()), m_cellSize(100.), m_maxNodeRadius(0.),
+			  m_nodeCells(QHash<quint64, QVector<int>>()), m_nodeCell(QVector<quint64>()),
+			  m_edgeGrids(QVector<QHash<quint64, QVector<int>>>()), m_edgeLevel(QVector<int>()),
+			  m_edgeCells(QVector<QRect>())
+	{
+	}
+
+	void GraphStore::clear()
+	{
+		m_nodeIds.clear();
+		m_plugIds.clear();
+		m_edgeIds.clear();
+		m_nodeX.clear();
+		m_nodeY.clear();
+		m_nodeRadius.clear();
+		m_nodeName.clear();
+		m_nodeUuid.clear();
+		m_nodePlugs.clear();
+		m_nodeCells.clear();
+		m_nodeCell.clear();
+		m_maxNodeRadius = 0.;
+		m_plugNode.clear();
+		m_plugName.clear();
+		m_plugDirection.clear();
+		m_plugNormalX.clear();
+		m_plugNormalY.clear();
+		m_plugEdges.clear();
+		m_edgeFrom.clear();
+		m_edgeTo.clear();
+		m_edgeGrids.clear();
+		m_edgeLevel.clear();
+		m_edgeCells.clear();
+	}
+
+	void GraphStore::reserve(int nodeCount, int plugCount, int edgeCount)
+	{
+		m_nodeIds.reserve(nodeCount);
+		m_plugIds.reserve(plugCount);
+		m_edgeIds.reserve(edgeCount);
+		m_nodeX.reserve(nodeCount);
+		m_nodeY.reserve(nodeCount);
+		m_nodeRadius.reserve(nodeCount);
+		m_nodeName.reserve(nodeCount);
+		m_nodeUuid.reserve(nodeCount);
+		m_nodePlugs.reserve(nodeCount);
+		m_nodeCell.reserve(nodeCount);
+		m_plugNode.reserve(plugCount);
+		m_plugName.reserve(plugCount);
+		m_plugDirection.reserve(plugCount);
+		m_plugNormalX.reserve(plugCount);
+		m_plugNormalY.reserve(plugCount);
+		m_plugEdges.reserve(plugCount);
+		m_edgeFrom.reserve(edgeCount);
+		m_edgeTo.reserve(edgeCount);
+		m_edgeLevel.reserve(edgeCount);
+		m_edgeCells.reserve(edgeCount);
+	}
+
+	SlotId GraphStore::addNode(const QPointF &pos, qreal radius)
+	{
+		m_nodeX.append(pos.x());
+		m_nodeY.append(pos.y());
+		m_nodeRadius.append(radius);
+		m_nodeName.append(QString());
+		m_nodeUuid.append(QUuid());
+		m_nodePlugs.append(QVector<int>());
+		m_nodeCell.append(getCellKeyAt(pos.x(), pos.y()));
+		m_nodeCells[m_nodeCell.last()].append(m_nodeCell.size() - 1);
+		m_maxNodeRadius = qMax(m_maxNodeRadius, radius);
+		return m_nodeIds.insert();
+	}
+
+	bool GraphStore::removeNode(const SlotId &node)
+	{
+		int position = m_nodeIds.indexOf(node);
+#ifdef QT_DEBUG
+		Q_ASSERT(position >= 0);
+		Q_ASSERT(m_nodePlugs.at(position).isEmpty());
+#else
+		if ((position < 0) || (!m_nodePlugs.at(position).isEmpty()))
+		{
+			return false;
+		}
+#endif
+		m_nodeIds.remove(node);
+
+		// take the node out of its grid cell
+		QVector<int> &cell = m_nodeCells[m_nodeCell.at(position)];
+		removePosition(cell, position);
+		if (cell.isEmpty())
+		{
+			m_nodeCells.remove(m_nodeCell.at(position));
+		}
+
+		// move the last node into the freed position
+		int last = getNodeCount() - 1;
+		if (position != last)
+		{
+			m_nodeCell[position] = m_nodeCell.at(last);
+			replacePosition(m_nodeCells[m_nodeCell.at(position)], last, position);
+			m_nodeX[position] = m_nodeX.at(last);
+			m_nodeY[position] = m_nodeY.at(last);
+			m_nodeRadius[position] = m_nodeRadius.at(last);
+			m_nodeName[position] = m_nodeName.at(last);
+			m_nodeUuid[position] = m_nodeUuid.at(last);
+			m_nodePlugs[position] = m_nodePlugs.at(last);
+			for (int plug: m_nodePlugs.at(position))
+			{
+				m_plugNode[plug] = position;
+			}
+		}
+		m_nodeX.removeLast();
+		m_nodeY.removeLast();
+		m_nodeRadius.removeLast();
+		m_nodeName.removeLast();
+		m_nodeUuid.removeLast();
+		m_nodePlugs.removeLast();
+		m_nodeCell.removeLast();
+
+		return true;
+	}
+
+	SlotId GraphStore::addPlug(const SlotId &node, PlugDirection direction)
+	{
+		int nodePosition = m_nodeIds.indexOf(node);
+#ifdef QT_DEBUG
+		Q_ASSERT(nodePosition >= 0);
+		Q_ASSERT(direction != PlugDirection::BOTH);
+#else
+		if (nodePosition < 0)
+		{
+			return SlotId();
+		}
+		if (direction == PlugDirection::BOTH)
+		{
+			direction = PlugDirection::IN;
+		}
+#endif
+		m_nodePlugs[nodePosition].append(m_plugNode.size());
+		m_plugNode.append(nodePosition);
+		m_plugName.append(NameAtom());
+		m_plugDirection.append(direction);
+		m_plugNormalX.append(1.);
+		m_plugNormalY.append(0.);
+		m_plugEdges.append(QVector<int>());
+		return m_plugIds.insert();
+	}
+
+	bool GraphStore::removePlug(const SlotId &plug)
+	{
+		int position = m_plugIds.indexOf(plug);
+#ifdef QT_DEBUG
+		Q_ASSERT(position >= 0);
+		Q_ASSERT(m_plugEdges.at(position).isEmpty());
+#else
+		if ((position < 0) || (!m_plugEdges.at(position).isEmpty()))
+		{
+			return false;
+		}
+#endif
+		m_plugIds.remove(plug);
+
+		// unregister the plug from its node
+		removePosition(m_nodePlugs[m_plugNode.at(position)], position);
+
+		// move the last plug into the freed position
+		int last = getPlugCount() - 1;
+		if (position != last)
+		{
+			m_plugNode[position] = m_plugNode.at(last);
+			m_plugName[position] = m_plugName.at(last);
+			m_plugDirection[position] = m_plugDirection.at(last);
+			m_plugNormalX[position] = m_plugNormalX.at(last);
+			m_plugNormalY[position] = m_plugNormalY.at(last);
+			m_plugEdges[position] = m_plugEdges.at(last);
+			replacePosition(m_nodePlugs[m_plugNode.at(position)], last, position);
+			for (int edge: m_plugEdges.at(position))
+			{
+				if (m_edgeFrom.at(edge) == last)
+				{
+					m_edgeFrom[edge] = position;
+				} else
+				{
+					m_edgeTo[edge] = position;
+				}
+			}
+		}
+		m_plugNode.removeLast();
+		m_plugName.removeLast();
+		m_plugDirection.removeLast();
+		m_plugNormalX.removeLast();
+		m_plugNormalY.removeLast();
+		m_plugEdges.removeLast();
+
+		return true;
+	}
+
+	SlotId GraphStore::addEdge(const SlotId &fromPlug, const SlotId &toPlug)
+	{
+		int fromPosition = m_plugIds.indexOf(fromPlug);
+		int toPosition = m_plugIds.indexOf(toPlug);
+		bool isValid = (fromPosition >= 0) && (toPosition >= 0)
+		               && (m_plugDirection.at(fromPosition) == PlugDirection::OUT)
+		               && (m_plugDirection.at(toPosition) == PlugDirection::IN);
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return SlotId();
+		}
+#endif
+		int position = m_edgeFrom.size();
+		m_edgeFrom.append(fromPosition);
+		m_edgeTo.append(toPosition);
+		m_plugEdges[fromPosition].append(position);
+		m_plugEdges[toPosition].append(position);
+		m_edgeLevel.append(-1);
+		m_edgeCells.append(QRect());
+		updateEdgeCells(position);
+		return m_edgeIds.insert();
+	}
+
+	bool GraphStore::removeEdge(const SlotId &edge)
+	{
+		int position = m_edgeIds.indexOf(edge);
+#ifdef QT_DEBUG
+		Q_ASSERT(position >= 0);
+#else
+		if (position < 0)
+		{
+			return false;
+		}
+#endif
+		m_edgeIds.remove(edge);
+
+		// unregister the edge from its plugs and grid cells
+		removePosition(m_plugEdges[m_edgeFrom.at(position)], position);
+		removePosition(m_plugEdges[m_edgeTo.at(position)], position);
+		removeEdgeCells(position);
+
+		// move the last edge into the freed position
+		int last = getEdgeCount() - 1;
+		if (position != last)
+		{
+			m_edgeFrom[position] = m_edgeFrom.at(last);
+			m_edgeTo[position] = m_edgeTo.at(last);
+			replacePosition(m_plugEdges[m_edgeFrom.at(position)], last, position);
+			replacePosition(m_plugEdges[m_edgeTo.at(position)], last, position);
+			m_edgeLevel[position] = m_edgeLevel.at(last);
+			m_edgeCells[position] = m_edgeCells.at(last);
+			QHash<quint64, QVector<int>> &grid = m_edgeGrids[m_edgeLevel.at(position)];
+			const QRect &cells = m_edgeCells.at(position);
+			for (int y = cells.top(); y <= cells.bottom(); ++y)
+			{
+				for (int x = cells.left(); x <= cells.right(); ++x)
+				{
+					replacePosition(grid[getCellKey(x, y)], last, position);
+				}
+			}
+		}
+		m_edgeFrom.removeLast();
+		m_edgeTo.removeLast();
+		m_edgeLevel.removeLast();
+		m_edgeCells.removeLast();
+
+		return true;
+	}
+
+	QPointF GraphStore::getNodePos(const SlotId &node) const
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? QPointF() : QPointF(m_nodeX.at(position), m_nodeY.at(position));
+	}
+
+	void GraphStore::setNodePos(const SlotId &node, const QPointF &pos)
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		if (position >= 0)
+		{
+			m_nodeX[position] = pos.x();
+			m_nodeY[position] = pos.y();
+			updateNodeCell(position);
+			updateNodeEdgeCells(position);
+		}
+	}
+
+	QString GraphStore::getNodeName(const SlotId &node) const
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? QString() : m_nodeName.at(position);
+	}
+
+	void GraphStore::setNodeName(const SlotId &node, const QString &name)
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		if (position >= 0)
+		{
+			m_nodeName[position] = name;
+		}
+	}
+
+	QUuid GraphStore::getNodeUuid(const SlotId &node) const
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? QUuid() : m_nodeUuid.at(position);
+	}
+
+	void GraphStore::setNodeUuid(const SlotId &node, const QUuid &uuid)
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		if (position >= 0)
+		{
+			m_nodeUuid[position] = uuid;
+		}
+	}
+
+	qreal GraphStore::getNodeRadius(const SlotId &node) const
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? 0. : m_nodeRadius.at(position);
+	}
+
+	void GraphStore::setNodeRadius(const SlotId &node, qreal radius)
+	{
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		if (position >= 0)
+		{
+			m_nodeRadius[position] = radius;
+			m_maxNodeRadius = qMax(m_maxNodeRadius, radius);
+			updateNodeEdgeCells(position);
+		}
+	}
+
+	QVector<SlotId> GraphStore::getNodePlugs(const SlotId &node) const
+	{
+		QVector<SlotId> result;
+		int position = m_nodeIds.indexOf(node);
+		Q_ASSERT(position >= 0);
+		if (position < 0)
+		{
+			return result;
+		}
+		const QVector<int> &plugs = m_nodePlugs.at(position);
+		result.reserve(plugs.size());
+		for (int plug: plugs)
+		{
+			result.append(m_plugIds.idAt(plug));
+		}
+		return result;
+	}
+
+	SlotId GraphStore::getPlugNode(const SlotId &plug) const
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? SlotId() : m_nodeIds.idAt(m_plugNode.at(position));
+	}
+
+	NameAtom GraphStore::getPlugName(const SlotId &plug) const
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? NameAtom() : m_plugName.at(position);
+	}
+
+	void GraphStore::setPlugName(const SlotId &plug, const NameAtom &name)
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		if (position >= 0)
+		{
+			m_plugName[position] = name;
+		}
+	}
+
+	PlugDirection GraphStore::getPlugDirection(const SlotId &plug) const
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? PlugDirection::BOTH : m_plugDirection.at(position);
+	}
+
+	void GraphStore::setPlugDirection(const SlotId &plug, PlugDirection direction)
+	{
+		int position = m_plugIds.indexOf(plug);
+		bool isValid = (position >= 0) && (m_plugEdges.at(position).isEmpty()) && (direction != PlugDirection::BOTH);
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return;
+		}
+#endif
+		m_plugDirection[position] = direction;
+	}
+
+	QVector2D GraphStore::getPlugNormal(const SlotId &plug) const
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? QVector2D() : QVector2D(m_plugNormalX.at(position), m_plugNormalY.at(position));
+	}
+
+	void GraphStore::setPlugNormal(const SlotId &plug, const QVector2D &normal)
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		if (position >= 0)
+		{
+			m_plugNormalX[position] = normal.x();
+			m_plugNormalY[position] = normal.y();
+		}
+	}
+
+	QVector<SlotId> GraphStore::getPlugEdges(const SlotId &plug) const
+	{
+		QVector<SlotId> result;
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		if (position < 0)
+		{
+			return result;
+		}
+		const QVector<int> &edges = m_plugEdges.at(position);
+		result.reserve(edges.size());
+		for (int edge: edges)
+		{
+			result.append(m_edgeIds.idAt(edge));
+		}
+		return result;
+	}
+
+	int GraphStore::getPlugEdgeCount(const SlotId &plug) const
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? 0 : m_plugEdges.at(position).size();
+	}
+
+	SlotId GraphStore::getEdgeFrom(const SlotId &edge) const
+	{
+		int position = m_edgeIds.indexOf(edge);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? SlotId() : m_plugIds.idAt(m_edgeFrom.at(position));
+	}
+
+	SlotId GraphStore::getEdgeTo(const SlotId &edge) const
+	{
+		int position = m_edgeIds.indexOf(edge);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? SlotId() : m_plugIds.idAt(m_edgeTo.at(position));
+	}
+
+	QPointF GraphStore::getPlugAnchor(const SlotId &plug) const
+	{
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		return position < 0 ? QPointF() : getPlugAnchorAt(position);
+	}
+
+	QVector2D GraphStore::getPlugTargetNormal(const SlotId &plug) const
+	{
+		// return early, if there are no plugs to target
+		int position = m_plugIds.indexOf(plug);
+		Q_ASSERT(position >= 0);
+		if ((position < 0) || (m_plugEdges.at(position).isEmpty()))
+		{
+			return QVector2D(0, 0);
+		}
+
+		// get the average direction to the anchors of all connected plugs
+		int node = m_plugNode.at(position);
+		QVector2D thisPos(QPointF(m_nodeX.at(node), m_nodeY.at(node)));
+		QVector2D averageDirection(0, 0);
+		for (int edge: m_plugEdges.at(position))
+		{
+			int otherPlug = m_edgeFrom.at(edge) == position ? m_edgeTo.at(edge) : m_edgeFrom.at(edge);
+			averageDirection += (QVector2D(getPlugAnchorAt(otherPlug)) - thisPos).normalized();
+		}
+		return averageDirection.normalized();
+	}
+
+	void GraphStore::setCellSize(qreal cellSize)
+	{
+		cellSize = qMax(1., cellSize);
+		if (qFuzzyCompare(cellSize, m_cellSize))
+		{
+			return;
+		}
+		m_cellSize = cellSize;
+
+		// sort all nodes into the new grid
+		m_nodeCells.clear();
+		int nodeCount = getNodeCount();
+		for (int node = 0; node < nodeCount; ++node)
+		{
+			m_nodeCell[node] = getCellKeyAt(m_nodeX.at(node), m_nodeY.at(node));
+			m_nodeCells[m_nodeCell.at(node)].append(node);
+		}
+
+		// sort all edges into the new grid hierarchy
+		m_edgeGrids.clear();
+		m_edgeLevel.fill(-1);
+		int edgeCount = getEdgeCount();
+		for (int edge = 0; edge < edgeCount; ++edge)
+		{
+			updateEdgeCells(edge);
+		}
+	}
+
+	QVector<SlotId> GraphStore::getNodesIn(const QRectF &rect) const
+	{
+		QVector<SlotId> result;
+		int nodeCount = getNodeCount();
+
+		// the center of an intersecting node lies at most the largest radius outside of the rectangle
+		QRectF searchRect = rect.normalized().marginsAdded(QMarginsF(m_maxNodeRadius, m_maxNodeRadius, m_maxNodeRadius,
+		                                                             m_maxNodeRadius));
+		qreal left = std::floor(searchRect.left() / m_cellSize);
+		qreal top = std::floor(searchRect.top() / m_cellSize);
+		qreal right = std::floor(searchRect.right() / m_cellSize);
+		qreal bottom = std::floor(searchRect.bottom() / m_cellSize);
+
+		// when zoomed out far enough, visiting every node is cheaper than visiting every cell
+		if ((right - left + 1.) * (bottom - top + 1.) > qreal(nodeCount))
+		{
+			for (int node = 0; node < nodeCount; ++node)
+			{
+				if (isNodeIn(node, rect))
+				{
+					result.append(m_nodeIds.idAt(node));
+				}
+			}
+			return result;
+		}
+
+		for (int y = int(top); y <= int(bottom); ++y)
+		{
+			for (int x = int(left); x <= int(right); ++x)
+			{
+				for (int node: m_nodeCells.value(getCellKey(x, y)))
+				{
+					if (isNodeIn(node, rect))
+					{
+						result.append(m_nodeIds.idAt(node));
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	QVector<SlotId> GraphStore::getEdgesIn(const QRectF &rect) const
+	{
+		QVector<SlotId> result;
+		QRectF searchRect = rect.normalized();
+		for (int level = 0; level < m_edgeGrids.size(); ++level)
+		{
+			const QHash<quint64, QVector<int>> &grid = m_edgeGrids.at(level);
+			if (grid.isEmpty())
+			{
+				continue;
+			}
+
+			// an edge covering several cells is only reported in the first cell that it shares with the query
+			QRect range = getEdgeCellsOf(searchRect, level);
+			auto collect = [&](int x, int y, const QVector<int> &edges) {
+				for (int edge: edges)
+				{
+					const QRect &cells = m_edgeCells.at(edge);
+					if ((x != qMax(cells.left(), range.left())) || (y != qMax(cells.top(), range.top())))
+					{
+						continue;
+					}
+					if (isEdgeIn(edge, searchRect))
+					{
+						result.append(m_edgeIds.idAt(edge));
+					}
+				}
+			};
+
+			// when zoomed out far enough, visiting the occupied cells is cheaper than visiting every cell in range
+			if (qint64(range.width()) * qint64(range.height()) > grid.size())
+			{
+				for (auto it = grid.constBegin(); it != grid.constEnd(); ++it)
+				{
+					QPoint cell = getCellCoordinates(it.key());
+					if (range.contains(cell))
+					{
+						collect(cell.x(), cell.y(), it.value());
+					}
+				}
+				continue;
+			}
+			for (int y = range.top(); y <= range.bottom(); ++y)
+			{
+				for (int x = range.left(); x <= range.right(); ++x)
+				{
+					auto it = grid.constFind(getCellKey(x, y));
+					if (it != grid.constEnd())
+					{
+						collect(x, y, it.value());
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	QRectF GraphStore::getBoundingRect() const
+	{
+		int nodeCount = getNodeCount();
+		if (nodeCount == 0)
+		{
+			return QRectF();
+		}
+		qreal left = m_nodeX.at(0) - m_nodeRadius.at(0);
+		qreal right = m_nodeX.at(0) + m_nodeRadius.at(0);
+		qreal top = m_nodeY.at(0) - m_nodeRadius.at(0);
+		qreal bottom = m_nodeY.at(0) + m_nodeRadius.at(0);
+		for (int node = 1; node < nodeCount; ++node)
+		{
+			qreal radius = m_nodeRadius.at(node);
+			left = qMin(left, m_nodeX.at(node) - radius);
+			right = qMax(right, m_nodeX.at(node) + radius);
+			top = qMin(top, m_nodeY.at(node) - radius);
+			bottom = qMax(bottom, m_nodeY.at(node) + radius);
+		}
+		return QRectF(QPointF(left, top), QPointF(right, bottom));
+	}
+
+	quint64 GraphStore::getCellKeyAt(qreal x, qreal y) const
+	{
+		return getCellKey(int(std::floor(x / m_cellSize)), int(std::floor(y / m_cellSize)));
+	}
+
+	void GraphStore::updateNodeCell(int node)
+	{
+		quint64 key = getCellKeyAt(m_nodeX.at(node), m_nodeY.at(node));
+		quint64 oldKey = m_nodeCell.at(node);
+		if (key == oldKey)
+		{
+			return;
+		}
+		QVector<int> &oldCell = m_nodeCells[oldKey];
+		removePosition(oldCell, node);
+		if (oldCell.isEmpty())
+		{
+			m_nodeCells.remove(oldKey);
+		}
+		m_nodeCell[node] = key;
+		m_nodeCells[key].append(node);
+	}
+
+	QRectF GraphStore::getEdgeRectAt(int edge) const
+	{
+		int from = m_plugNode.at(m_edgeFrom.at(edge));
+		int to = m_plugNode.at(m_edgeTo.at(edge));
+		qreal fromRadius = m_nodeRadius.at(from);
+		qreal toRadius = m_nodeRadius.at(to);
+		return QRectF(QPointF(qMin(m_nodeX.at(from) - fromRadius, m_nodeX.at(to) - toRadius),
+		                      qMin(m_nodeY.at(from) - fromRadius, m_nodeY.at(to) - toRadius)),
+		              QPointF(qMax(m_nodeX.at(from) + fromRadius, m_nodeX.at(to) + toRadius),
+		                      qMax(m_nodeY.at(from) + fromRadius, m_nodeY.at(to) + toRadius)));
+	}
+
+	int GraphStore::getEdgeLevelOf(const QRectF &rect) const
+	{
+		qreal extent = qMax(rect.width(), rect.height());
+		int level = 0;
+		for (qreal cellSize = m_cellSize; cellSize < extent; cellSize *= 2.)
+		{
+			++level;
+		}
+		return level;
+	}
+
+	QRect GraphStore::getEdgeCellsOf(const QRectF &rect, int level) const
+	{
+		qreal cellSize = std::ldexp(m_cellSize, level);
+		return QRect(QPoint(int(std::floor(rect.left() / cellSize)), int(std::floor(rect.top() / cellSize))),
+		             QPoint(int(std::floor(rect.right() / cellSize)), int(std::floor(rect.bottom() / cellSize))));
+	}
+
+	void GraphStore::updateEdgeCells(int edge)
+	{
+		QRectF rect = getEdgeRectAt(edge);
+		int level = getEdgeLevelOf(rect);
+		QRect cells = getEdgeCellsOf(rect, level);
+		if ((level == m_edgeLevel.at(edge)) && (cells == m_edgeCells.at(edge)))
+		{
+			return;
+		}
+		removeEdgeCells(edge);
+		m_edgeLevel[edge] = level;
+		m_edgeCells[edge] = cells;
+		if (level >= m_edgeGrids.size())
+		{
+			m_edgeGrids.resize(level + 1);
+		}
+		QHash<quint64, QVector<int>> &grid = m_edgeGrids[level];
+		for (int y = cells.top(); y <= cells.bottom(); ++y)
+		{
+			for (int x = cells.left(); x <= cells.right(); ++x)
+			{
+				grid[getCellKey(x, y)].append(edge);
+			}
+		}
+	}
+
+	void GraphStore::removeEdgeCells(int edge)
+	{
+		int level = m_edgeLevel.at(edge);
+		if (level < 0)
+		{
+			return;
+		}
+		QHash<quint64, QVector<int>> &grid = m_edgeGrids[level];
+		const QRect &cells = m_edgeCells.at(edge);
+		for (int y = cells.top(); y <= cells.bottom(); ++y)
+		{
+			for (int x = cells.left(); x <= cells.right(); ++x)
+			{
+				quint64 key = getCellKey(x, y);
+				QVector<int> &cell = grid[key];
+				removePosition(cell, edge);
+				if (cell.isEmpty())
+				{
+					grid.remove(key);
+				}
+			}
+		}
+		m_edgeLevel[edge] = -1;
+	}
+
+	void GraphStore::updateNodeEdgeCells(int node)
+	{
+		for (int plug: m_nodePlugs.at(node))
+		{
+			for (int edge: m_plugEdges.at(plug))
+			{
+				updateEdgeCells(edge);
+			}
+		}
+	}
+
+	bool GraphStore::isEdgeIn(int edge, const QRectF &rect) const
+	{
+		// clip the line against all four sides of the rectangle (Liang-Barsky)
+		QPointF from = getPlugAnchorAt(m_edgeFrom.at(edge));
+		QPointF to = getPlugAnchorAt(m_edgeTo.at(edge));
+		qreal deltaX = to.x() - from.x();
+		qreal deltaY = to.y() - from.y();
+		const qreal directions[4] = {-deltaX, deltaX, -deltaY, deltaY};
+		const qreal distances[4] = {from.x() - rect.left(), rect.right() - from.x(), from.y() - rect.top(),
+		                            rect.bottom() - from.y()};
+		qreal enter = 0.;
+		qreal leave = 1.;
+		for (int side = 0; side < 4; ++side)
+		{
+			if (qFuzzyIsNull(directions[side]))
+			{
+				// parallel to this side, the line is either inside of it or misses the rectangle
+				if (distances[side] < 0.)
+				{
+					return false;
+				}
+				continue;
+			}
+			qreal t = distances[side] / directions[side];
+			if (directions[side] < 0.)
+			{
+				enter = qMax(enter, t);
+			} else
+			{
+				leave = qMin(leave, t);
+			}
+			if (enter > leave)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool GraphStore::isNodeIn(int node, const QRectF &rect) const
+	{
+		qreal radius = m_nodeRadius.at(node);
+		return (m_nodeX.at(node) + radius >= rect.left()) && (m_nodeX.at(node) - radius <= rect.right())
+		       && (m_nodeY.at(node) + radius >= rect.top()) && (m_nodeY.at(node) - radius <= rect.bottom());
+	}
+
+	QPointF GraphStore::getPlugAnchorAt(int plug) const
+	{
+		int node = m_plugNode.at(plug);
+		qreal radius = m_nodeRadius.at(node);
+		return QPointF(m_nodeX.at(node) + (m_plugNormalX.at(plug) * radius),
+		               m_nodeY.at(node) + (m_plugNormalY.at(plug) * radius));
+	}
+
+	void GraphStore::replacePosition(QVector<int> &positions, int from, int to)
+	{
+		int index = positions.indexOf(from);
+		Q_ASSERT(index != -1);
+		if (index != -1)
+		{
+			positions[index] = to;
+		}
+	}
+
+	void GraphStore::removePosition(QVector<int> &positions, int value)
+	{
+		int index = positions.indexOf(value);
+		Q_ASSERT(index != -1);
+		if (index == -1)
+		{
+			return;
+		}
+		positions[index] = positions.last();
+		positions.removeLast();
+	}
+
+} // namespace zodiac
@@ -0,0 +1,750 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_GRAPHSTORE_H
+#define ZODIAC_GRAPHSTORE_H
+
+///
+/// \file graphstore.h
+///
+/// \brief Contains the definition of the zodiac::GraphStore class.
+///
+
+#include <QHash>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+#include <QVector2D>
+#include <QtGlobal>
+
+#include "nametable.h"
+#include "slotmap.h"
+#include "utils.h"
+
+namespace zodiac
+{
+
+///
+/// \brief Headless storage for the topology and geometry of a Zodiac graph.
+///
+/// The GraphStore holds all nodes, plugs and edges of a graph as plain structure-of-arrays, without creating a single
+/// QObject or QGraphicsItem.
+/// This allows loading, querying and laying out graphs that are far larger than the item layer could hold.
+/// The store also keeps the names of all nodes and plugs, so that the Scene can create the items of any node on demand.
+///
+/// Nodes, plugs and edges are identified by generation-checked SlotId%s that stay valid for as long as the element
+/// exists and never refer to another element after it was removed.
+/// Internally, the elements of each kind are densely packed, so they can also be iterated by their dense position in
+/// the range [0, count) -- see getNodeIdAt(), getPlugIdAt() and getEdgeIdAt().
+/// Dense positions change when elements are removed, SlotId%s don't.
+///
+/// Nodes are sorted into a uniform grid by the position of their center, so getNodesIn() only visits the nodes
+/// around the queried rectangle.
+/// Edges are sorted into a hierarchy of grids by the rectangle spanned by their two nodes, see getEdgesIn().
+/// Each level doubles the cell size of the one below, and every edge sits on the lowest level whose cells are at
+/// least as large as the edge, so it covers at most four cells no matter how long it is.
+///
+/// To keep the structure consistent, a node can only be removed after all of its plugs were removed and a plug only
+/// after all of its edges were removed.
+/// Passing a null or stale SlotId to any method throws an assertion error in debug mode and is ignored in release mode.
+///
+	class Q_DECL_EXPORT GraphStore
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		GraphStore();
+
+		///
+		/// \brief Removes all nodes, plugs and edges from the store.
+		///
+		void clear();
+
+		///
+		/// \brief Reserves memory for the given number of elements.
+		///
+		/// \param [in] nodeCount   Number of nodes to reserve memory for.
+		/// \param [in] plugCount   Number of plugs to reserve memory for.
+		/// \param [in] edgeCount   Number of edges to reserve memory for.
+		///
+		void reserve(int nodeCount, int plugCount, int edgeCount);
+
+		///
+		/// \brief Adds a new node to the store.
+		///
+		/// \param [in] pos     Position of the node in scene coordinates.
+		/// \param [in] radius  Radius of the node's perimeter.
+		///
+		/// \return             Id of the new node.
+		///
+		SlotId addNode(const QPointF &pos = QPointF(), qreal radius = 0.);
+
+		///
+		/// \brief Removes a node from the store.
+		///
+		/// The node must not have any plugs left.
+		///
+		/// \param [in] node    Id of the node to remove.
+		///
+		/// \return             <i>true</i> if the node was removed -- <i>false</i> otherwise.
+		///
+		bool removeNode(const SlotId &node);
+
+		///
+		/// \brief Adds a new plug to a node in the store.
+		///
+		/// \param [in] node        Id of the node to add the plug to.
+		/// \param [in] direction   Direction of the plug, must either be IN or OUT.
+		///
+		/// \return                 Id of the new plug, or a null SlotId if the node does not exist.
+		///
+		SlotId addPlug(const SlotId &node, PlugDirection direction);
+
+		///
+		/// \brief Removes a plug from the store.
+		///
+		/// The plug must not have any edges left.
+		///
+		/// \param [in] plug    Id of the plug to remove.
+		///
+		/// \return             <i>true</i> if the plug was removed -- <i>false</i> otherwise.
+		///
+		bool removePlug(const SlotId &plug);
+
+		///
+		/// \brief Adds a new edge from an outgoing to an incoming plug.
+		///
+		/// \param [in] fromPlug    Id of the start plug.
+		/// \param [in] toPlug      Id of the end plug.
+		///
+		/// \return                 Id of the new edge, or a null SlotId if the edge could not be created.
+		///
+		SlotId addEdge(const SlotId &fromPlug, const SlotId &toPlug);
+
+		///
+		/// \brief Removes an edge from the store.
+		///
+		/// \param [in] edge    Id of the edge to remove.
+		///
+		/// \return             <i>true</i> if the edge was removed -- <i>false</i> otherwise.
+		///
+		bool removeEdge(const SlotId &edge);
+
+		///
+		/// \brief Tests whether a node exists in the store.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             <i>true</i> if the node exists -- <i>false</i> otherwise.
+		///
+		inline bool containsNode(const SlotId &node) const { return m_nodeIds.contains(node); }
+
+		///
+		/// \brief Tests whether a plug exists in the store.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             <i>true</i> if the plug exists -- <i>false</i> otherwise.
+		///
+		inline bool containsPlug(const SlotId &plug) const { return m_plugIds.contains(plug); }
+
+		///
+		/// \brief Tests whether an edge exists in the store.
+		///
+		/// \param [in] edge    Id of the edge.
+		///
+		/// \return             <i>true</i> if the edge exists -- <i>false</i> otherwise.
+		///
+		inline bool containsEdge(const SlotId &edge) const { return m_edgeIds.contains(edge); }
+
+		///
+		/// \brief Number of nodes in the store.
+		///
+		/// \return Number of nodes.
+		///
+		inline int getNodeCount() const { return m_nodeX.size(); }
+
+		///
+		/// \brief Number of plugs in the store.
+		///
+		/// \return Number of plugs.
+		///
+		inline int getPlugCount() const { return m_plugNode.size(); }
+
+		///
+		/// \brief Number of edges in the store.
+		///
+		/// \return Number of edges.
+		///
+		inline int getEdgeCount() const { return m_edgeFrom.size(); }
+
+		///
+		/// \brief Id of the node at a dense position.
+		///
+		/// \param [in] position    Dense position in the range [0, getNodeCount()).
+		///
+		/// \return                 Id of the node.
+		///
+		inline SlotId getNodeIdAt(int position) const { return m_nodeIds.idAt(position); }
+
+		///
+		/// \brief Id of the plug at a dense position.
+		///
+		/// \param [in] position    Dense position in the range [0, getPlugCount()).
+		///
+		/// \return                 Id of the plug.
+		///
+		inline SlotId getPlugIdAt(int position) const { return m_plugIds.idAt(position); }
+
+		///
+		/// \brief Id of the edge at a dense position.
+		///
+		/// \param [in] position    Dense position in the range [0, getEdgeCount()).
+		///
+		/// \return                 Id of the edge.
+		///
+		inline SlotId getEdgeIdAt(int position) const { return m_edgeIds.idAt(position); }
+
+		///
+		/// \brief The dense position of a node.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             Dense position of the node, or -1 if the id is null or stale.
+		///
+		inline int getNodePosition(const SlotId &node) const { return m_nodeIds.indexOf(node); }
+
+		///
+		/// \brief Position of a node in scene coordinates.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             Position of the node.
+		///
+		QPointF getNodePos(const SlotId &node) const;
+
+		///
+		/// \brief Moves a node to a new position.
+		///
+		/// \param [in] node    Id of the node.
+		/// \param [in] pos     New position of the node in scene coordinates.
+		///
+		void setNodePos(const SlotId &node, const QPointF &pos);
+
+		///
+		/// \brief Display name of a node.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             Name of the node.
+		///
+		QString getNodeName(const SlotId &node) const;
+
+		///
+		/// \brief Sets the display name of a node.
+		///
+		/// \param [in] node    Id of the node.
+		/// \param [in] name    New name of the node.
+		///
+		void setNodeName(const SlotId &node, const QString &name);
+
+		///
+		/// \brief Unique identifier of a node.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             Unique identifier of the node, null if none was set.
+		///
+		QUuid getNodeUuid(const SlotId &node) const;
+
+		///
+		/// \brief Sets the unique identifier of a node.
+		///
+		/// \param [in] node    Id of the node.
+		/// \param [in] uuid    New unique identifier of the node.
+		///
+		void setNodeUuid(const SlotId &node, const QUuid &uuid);
+
+		///
+		/// \brief Radius of a node's perimeter.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             Radius of the node.
+		///
+		qreal getNodeRadius(const SlotId &node) const;
+
+		///
+		/// \brief Sets the radius of a node's perimeter.
+		///
+		/// \param [in] node    Id of the node.
+		/// \param [in] radius  New radius of the node.
+		///
+		void setNodeRadius(const SlotId &node, qreal radius);
+
+		///
+		/// \brief All plugs of a node.
+		///
+		/// \param [in] node    Id of the node.
+		///
+		/// \return             Ids of all plugs of the node.
+		///
+		QVector<SlotId> getNodePlugs(const SlotId &node) const;
+
+		///
+		/// \brief The node of a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Id of the plug's node.
+		///
+		SlotId getPlugNode(const SlotId &plug) const;
+
+		///
+		/// \brief Name of a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Name of the plug, interned in the NameTable of the Scene.
+		///
+		NameAtom getPlugName(const SlotId &plug) const;
+
+		///
+		/// \brief Renames a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		/// \param [in] name    New name of the plug, interned in the NameTable of the Scene.
+		///
+		void setPlugName(const SlotId &plug, const NameAtom &name);
+
+		///
+		/// \brief Direction of a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Direction of the plug.
+		///
+		PlugDirection getPlugDirection(const SlotId &plug) const;
+
+		///
+		/// \brief Changes the direction of a plug.
+		///
+		/// Only plugs without edges can change their direction.
+		///
+		/// \param [in] plug        Id of the plug.
+		/// \param [in] direction   New direction of the plug.
+		///
+		void setPlugDirection(const SlotId &plug, PlugDirection direction);
+
+		///
+		/// \brief Normal of a plug, pointing from the center of its node to the center of the plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Normalized direction of the plug.
+		///
+		QVector2D getPlugNormal(const SlotId &plug) const;
+
+		///
+		/// \brief Sets the normal of a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		/// \param [in] normal  New normalized direction of the plug.
+		///
+		void setPlugNormal(const SlotId &plug, const QVector2D &normal);
+
+		///
+		/// \brief All edges connected to a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Ids of all connected edges.
+		///
+		QVector<SlotId> getPlugEdges(const SlotId &plug) const;
+
+		///
+		/// \brief Number of edges connected to a plug.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Number of connected edges.
+		///
+		int getPlugEdgeCount(const SlotId &plug) const;
+
+		///
+		/// \brief The start plug of an edge.
+		///
+		/// \param [in] edge    Id of the edge.
+		///
+		/// \return             Id of the outgoing plug of the edge.
+		///
+		SlotId getEdgeFrom(const SlotId &edge) const;
+
+		///
+		/// \brief The end plug of an edge.
+		///
+		/// \param [in] edge    Id of the edge.
+		///
+		/// \return             Id of the incoming plug of the edge.
+		///
+		SlotId getEdgeTo(const SlotId &edge) const;
+
+		///
+		/// \brief The point on the perimeter of its node, where a plug is anchored.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Anchor point of the plug in scene coordinates.
+		///
+		QPointF getPlugAnchor(const SlotId &plug) const;
+
+		///
+		/// \brief The average direction from the node of a plug towards the plugs it is connected to.
+		///
+		/// This is the headless equivalent of Plug::getTargetNormal() and used to arrange plugs around their node.
+		///
+		/// \param [in] plug    Id of the plug.
+		///
+		/// \return             Normalized target direction, or a null vector if the plug is not connected.
+		///
+		QVector2D getPlugTargetNormal(const SlotId &plug) const;
+
+		///
+		/// \brief Sets the edge length of the cells of the grid that the nodes are sorted into.
+		///
+		/// \param [in] cellSize    New cell size in scene units, should be about the diameter of a node.
+		///
+		void setCellSize(qreal cellSize);
+
+		///
+		/// \brief The edge length of the cells of the grid that the nodes are sorted into.
+		///
+		/// \return Cell size in scene units.
+		///
+		inline qreal getCellSize() const { return m_cellSize; }
+
+		///
+		/// \brief Finds all nodes whose perimeter intersects a given rectangle.
+		///
+		/// Only the grid cells around the rectangle are visited, unless the rectangle covers more cells than there
+		/// are nodes.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Ids of all intersecting nodes.
+		///
+		QVector<SlotId> getNodesIn(const QRectF &rect) const;
+
+		///
+		/// \brief Finds all edges whose straight line between the anchors of their plugs crosses a given rectangle.
+		///
+		/// Unlike the nodes at either end, the edge itself may lie far outside of the rectangle.
+		/// Only the cells around the rectangle are visited on each level of the grid hierarchy, or the occupied cells
+		/// of a level if the rectangle covers more cells than that.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Ids of all crossing edges.
+		///
+		QVector<SlotId> getEdgesIn(const QRectF &rect) const;
+
+		///
+		/// \brief The rectangle enclosing the perimeter of all nodes.
+		///
+		/// \return Bounding rectangle of all nodes in scene coordinates.
+		///
+		QRectF getBoundingRect() const;
+
+	private: // methods
+
+		///
+		/// \brief The key of the grid cell containing a point.
+		///
+		/// \param [in] x   Horizontal coordinate in scene coordinates.
+		/// \param [in] y   Vertical coordinate in scene coordinates.
+		///
+		/// \return         Key of the cell in m_nodeCells.
+		///
+		quint64 getCellKeyAt(qreal x, qreal y) const;
+
+		///
+		/// \brief The key of a grid cell.
+		///
+		/// \param [in] x   Horizontal index of the cell.
+		/// \param [in] y   Vertical index of the cell.
+		///
+		/// \return         Key of the cell in m_nodeCells.
+		///
+		static inline quint64 getCellKey(int x, int y) { return (quint64(quint32(x)) << 32) | quint64(quint32(y)); }
+
+		///
+		/// \brief Splits the key of a grid cell into its two indices.
+		///
+		/// \param [in] key Key of the cell.
+		///
+		/// \return         Horizontal and vertical index of the cell.
+		///
+		static inline QPoint getCellCoordinates(quint64 key) { return QPoint(int(quint32(key >> 32)), int(quint32(key))); }
+
+		///
+		/// \brief Sorts the node at a dense position into the grid cell of its center.
+		///
+		/// \param [in] node    Dense position of the node.
+		///
+		void updateNodeCell(int node);
+
+		///
+		/// \brief The rectangle spanned by the bounding squares of both nodes of an edge at a dense position.
+		///
+		/// \param [in] edge    Dense position of the edge.
+		///
+		/// \return             Bounds of the edge in scene coordinates.
+		///
+		QRectF getEdgeRectAt(int edge) const;
+
+		///
+		/// \brief The level of the edge grid hierarchy whose cells are at least as large as a rectangle.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Lowest level that the rectangle fits into.
+		///
+		int getEdgeLevelOf(const QRectF &rect) const;
+
+		///
+		/// \brief The range of cells of an edge grid covered by a rectangle.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		/// \param [in] level   Level of the grid hierarchy.
+		///
+		/// \return             Indices of the first and last covered cell in both directions.
+		///
+		QRect getEdgeCellsOf(const QRectF &rect, int level) const;
+
+		///
+		/// \brief Sorts the edge at a dense position into the cells of the edge grid hierarchy that it covers.
+		///
+		/// The grids are only touched if the edge moved into other cells.
+		///
+		/// \param [in] edge    Dense position of the edge.
+		///
+		void updateEdgeCells(int edge);
+
+		///
+		/// \brief Takes the edge at a dense position out of all cells of the edge grid hierarchy.
+		///
+		/// \param [in] edge    Dense position of the edge.
+		///
+		void removeEdgeCells(int edge);
+
+		///
+		/// \brief Sorts all edges connected to the node at a dense position into their cells again.
+		///
+		/// \param [in] node    Dense position of the node that moved or changed its radius.
+		///
+		void updateNodeEdgeCells(int node);
+
+		///
+		/// \brief Tests whether the line between the plug anchors of the edge at a dense position crosses a rectangle.
+		///
+		/// \param [in] edge    Dense position of the edge.
+		/// \param [in] rect    Normalized rectangle in scene coordinates.
+		///
+		/// \return             <i>true</i> if the edge crosses the rectangle -- <i>false</i> otherwise.
+		///
+		bool isEdgeIn(int edge, const QRectF &rect) const;
+
+		///
+		/// \brief Tests whether the bounding square of the node at a dense position intersects a rectangle.
+		///
+		/// \param [in] node    Dense position of the node.
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             <i>true</i> if the node intersects the rectangle -- <i>false</i> otherwise.
+		///
+		bool isNodeIn(int node, const QRectF &rect) const;
+
+		///
+		/// \brief The anchor point of a plug at a dense position.
+		///
+		/// \param [in] plug    Dense position of the plug.
+		///
+		/// \return             Anchor point of the plug in scene coordinates.
+		///
+		QPointF getPlugAnchorAt(int plug) const;
+
+		///
+		/// \brief Replaces one value in a list of dense positions with another.
+		///
+		/// \param [in,out] positions   List to modify.
+		/// \param [in] from            Value to replace.
+		/// \param [in] to              Replacement value.
+		///
+		static void replacePosition(QVector<int> &positions, int from, int to);
+
+		///
+		/// \brief Removes a value from a list of dense positions without preserving the order of the list.
+		///
+		/// \param [in,out] positions   List to modify.
+		/// \param [in] value           Value to remove.
+		///
+		static void removePosition(QVector<int> &positions, int value);
+
+	private: // members
+
+		///
+		/// \brief Maps node ids to their dense position.
+		///
+		SlotIndex m_nodeIds;
+
+		///
+		/// \brief Maps plug ids to their dense position.
+		///
+		SlotIndex m_plugIds;
+
+		///
+		/// \brief Maps edge ids to their dense position.
+		///
+		SlotIndex m_edgeIds;
+
+		///
+		/// \brief Horizontal position of each node.
+		///
+		QVector<qreal> m_nodeX;
+
+		///
+		/// \brief Vertical position of each node.
+		///
+		QVector<qreal> m_nodeY;
+
+		///
+		/// \brief Perimeter radius of each node.
+		///
+		QVector<qreal> m_nodeRadius;
+
+		///
+		/// \brief Display name of each node.
+		///
+		QVector<QString> m_nodeName;
+
+		///
+		/// \brief Unique identifier of each node.
+		///
+		QVector<QUuid> m_nodeUuid;
+
+		///
+		/// \brief Dense positions of the plugs of each node.
+		///
+		QVector<QVector<int>> m_nodePlugs;
+
+		///
+		/// \brief Dense position of the node of each plug.
+		///
+		QVector<int> m_plugNode;
+
+		///
+		/// \brief Name of each plug.
+		///
+		QVector<NameAtom> m_plugName;
+
+		///
+		/// \brief Direction of each plug.
+		///
+		QVector<PlugDirection> m_plugDirection;
+
+		///
+		/// \brief Horizontal component of the normal of each plug.
+		///
+		QVector<qreal> m_plugNormalX;
+
+		///
+		/// \brief Vertical component of the normal of each plug.
+		///
+		QVector<qreal> m_plugNormalY;
+
+		///
+		/// \brief Dense positions of the edges connected to each plug.
+		///
+		QVector<QVector<int>> m_plugEdges;
+
+		///
+		/// \brief Dense position of the start plug of each edge.
+		///
+		QVector<int> m_edgeFrom;
+
+		///
+		/// \brief Dense position of the end plug of each edge.
+		///
+		QVector<int> m_edgeTo;
+
+		///
+		/// \brief Edge length of the grid cells.
+		///
+		qreal m_cellSize;
+
+		///
+		/// \brief Largest radius a node ever had, nodes are only sorted into the cell of their center.
+		///
+		qreal m_maxNodeRadius;
+
+		///
+		/// \brief Dense positions of the nodes whose center lies in a grid cell, by the key of the cell.
+		///
+		QHash<quint64, QVector<int>> m_nodeCells;
+
+		///
+		/// \brief Key of the grid cell of each node.
+		///
+		QVector<quint64> m_nodeCell;
+
+		///
+		/// \brief Dense positions of the edges covering a cell, by level of the grid hierarchy and key of the cell.
+		///
+		/// Cells on level l have an edge length of m_cellSize * 2^l.
+		///
+		QVector<QHash<quint64, QVector<int>>> m_edgeGrids;
+
+		///
+		/// \brief Level of the grid hierarchy of each edge, -1 if the edge is not sorted into the grids.
+		///
+		QVector<int> m_edgeLevel;
+
+		///
+		/// \brief Range of cells on its level covered by each edge.
+		///
+		QVector<QRect> m_edgeCells;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_GRAPHSTORE_H
@@ -0,0 +1,179 @@
+#include "itemcache.h"
+
+#include <QPaintDevice>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+namespace zodiac
+{
+
+	quint64 ItemCache::s_nextId = 0;
+	qint64 ItemCache::s_defaultBudget = 32 * 1024 * 1024;
+
+	ItemCache::ItemCache()
+			: m_entries(QHash<quint64, Entry>()), m_leastRecentlyUsed(QMap<quint64, quint64>()), m_clock(0), m_frame(0),
+			  m_budget(s_defaultBudget), m_statistics(Statistics{0, 0, 0, 0, 0, 0})
+	{
+	}
+
+	void ItemCache::draw(quint64 id, QPainter *painter, const QRectF &rect,
+	                     const std::function<void(QPainter *)> &paintContent)
+	{
+		qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+		qreal pixelRatio = painter->device()->devicePixelRatioF();
+		QSize pixelSize(qCeil(rect.width() * scale * pixelRatio), qCeil(rect.height() * scale * pixelRatio));
+		if (painter->worldTransform().isRotating() || pixelSize.isEmpty()
+		    || (qint64(pixelSize.width()) * pixelSize.height() * 4 > m_budget / 4))
+		{
+			paintContent(painter);
+			return;
+		}
+
+		auto it = m_entries.find(id);
+		if (it == m_entries.end())
+		{
+			++m_statistics.misses;
+			it = m_entries.insert(id, Entry{QPixmap(), QRectF(), 0., 0., 0, 0});
+		} else if (it->pixmap.isNull() || (it->rect != rect) || (it->scale != scale) || (it->pixelRatio != pixelRatio))
+		{
+			++m_statistics.rerasters;
+			if (!it->pixmap.isNull())
+			{
+				m_statistics.bytes -= getCost(it->pixmap);
+				--m_statistics.pixmaps;
+				it->pixmap = QPixmap();
+			}
+		} else
+		{
+			++m_statistics.hits;
+		}
+
+		// render the item into a new pixmap, with the same zoom as the painter
+		if (it->pixmap.isNull())
+		{
+			QPixmap pixmap(pixelSize);
+			pixmap.setDevicePixelRatio(pixelRatio);
+			pixmap.fill(Qt::transparent);
+			QPainter cachePainter(&pixmap);
+			cachePainter.setRenderHints(painter->renderHints());
+			cachePainter.scale(pixelSize.width() / (rect.width() * pixelRatio),
+			                   pixelSize.height() / (rect.height() * pixelRatio));
+			cachePainter.translate(-rect.topLeft());
+			paintContent(&cachePainter);
+			cachePainter.end();
+
+			it->pixmap = pixmap;
+			it->rect = rect;
+			it->scale = scale;
+			it->pixelRatio = pixelRatio;
+			m_statistics.bytes += getCost(pixmap);
+			++m_statistics.pixmaps;
+		}
+		touch(id, it.value());
+		painter->drawPixmap(rect, it->pixmap, QRectF(it->pixmap.rect()));
+
+		evict();
+	}
+
+	void ItemCache::invalidate(quint64 id)
+	{
+		auto it = m_entries.find(id);
+		if ((it != m_entries.end()) && !it->pixmap.isNull())
+		{
+			m_statistics.bytes -= getCost(it->pixmap);
+			--m_statistics.pixmaps;
+			it->pixmap = QPixmap();
+		}
+	}
+
+	void ItemCache::remove(quint64 id)
+	{
+		auto it = m_entries.find(id);
+		if (it == m_entries.end())
+		{
+			return;
+		}
+		if (!it->pixmap.isNull())
+		{
+			m_statistics.bytes -= getCost(it->pixmap);
+			--m_statistics.pixmaps;
+		}
+		if (it->stamp != 0)
+		{
+			m_leastRecentlyUsed.remove(it->stamp);
+		}
+		m_entries.erase(it);
+	}
+
+	void ItemCache::beginFrame()
+	{
+		++m_frame;
+	}
+
+	void ItemCache::clear()
+	{
+		m_entries.clear();
+		m_leastRecentlyUsed.clear();
+		m_statistics.bytes = 0;
+		m_statistics.pixmaps = 0;
+	}
+
+	void ItemCache::setBudget(qint64 bytes)
+	{
+		m_budget = qMax(qint64(0), bytes);
+		evict();
+	}
+
+	void ItemCache::resetStatistics()
+	{
+		m_statistics.hits = 0;
+		m_statistics.misses = 0;
+		m_statistics.rerasters = 0;
+		m_statistics.evictions = 0;
+	}
+
+	quint64 ItemCache::createId()
+	{
+		return ++s_nextId;
+	}
+
+	void ItemCache::touch(quint64 id, Entry &entry)
+	{
+		if (entry.stamp != 0)
+		{
+			m_leastRecentlyUsed.remove(entry.stamp);
+		}
+		entry.stamp = ++m_clock;
+		entry.frame = m_frame;
+		m_leastRecentlyUsed.insert(entry.stamp, id);
+	}
+
+	void ItemCache::evict()
+	{
+		// the stamps grow monotonically, so the pixmaps drawn in the current frame are always the last ones
+		while ((m_statistics.bytes > m_budget) && !m_leastRecentlyUsed.isEmpty())
+		{
+			auto oldest = m_leastRecentlyUsed.begin();
+			auto it = m_entries.find(oldest.value());
+			if (it->frame == m_frame)
+			{
+				break;
+			}
+			if (!it->pixmap.isNull())
+			{
+				m_statistics.bytes -= getCost(it->pixmap);
+				--m_statistics.pixmaps;
+				++m_statistics.evictions;
+			}
+			m_entries.erase(it);
+			m_leastRecentlyUsed.erase(oldest);
+		}
+	}
+
+	qint64 ItemCache::getCost(const QPixmap &pixmap)
+	{
+		return qint64(pixmap.width()) * pixmap.height() * 4;
+	}
+
+} // namespace zodiac
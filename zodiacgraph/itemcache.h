@@ -0,0 +1,308 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_ITEMCACHE_H
+#define ZODIAC_ITEMCACHE_H
+
+/// \file itemcache.h
+///
+/// \brief Contains the definition of the zodiac::ItemCache class.
+///
+
+#include <QHash>
+#include <QMap>
+#include <QPixmap>
+#include <QRectF>
+#include <QtGlobal>
+
+#include <functional>
+
+class QPainter;
+
+namespace zodiac
+{
+
+///
+/// \brief Device pixmap cache of a Scene with a memory budget and least-recently-used eviction.
+///
+/// Replaces QGraphicsItem::DeviceCoordinateCache for the Plug%s and labels of a Scene, whose pixmaps would otherwise
+/// end up in the global QPixmapCache without any per-scene accounting.
+/// Items identify themselves with an id from createId(), call invalidate() whenever their appearance changes and
+/// remove() when they are deleted.
+/// Their pixmap is also rendered anew when the zoom, the device pixel ratio or their bounding rectangle changes.
+///
+/// Whenever the cache exceeds its budget, the least recently drawn pixmaps are evicted.
+/// As every View starts a new frame with beginFrame(), the items not drawn in the current frame (those off-screen)
+/// always go first -- pixmaps drawn in the current frame are never evicted, the cache rather exceeds its budget until
+/// the next frame.
+///
+	class Q_DECL_EXPORT ItemCache
+	{
+
+	public: // structs
+
+		///
+		/// \brief Counters to size the budget of the cache by.
+		///
+		struct Statistics
+		{
+			///
+			/// \brief Memory used by all cached pixmaps.
+			///
+			qint64 bytes;
+
+			///
+			/// \brief Number of cached pixmaps.
+			///
+			int pixmaps;
+
+			///
+			/// \brief Number of draws from a valid pixmap.
+			///
+			quint64 hits;
+
+			///
+			/// \brief Number of draws of items that were not in the cache.
+			///
+			quint64 misses;
+
+			///
+			/// \brief Number of draws of items whose pixmap was invalidated or did not fit the zoom anymore.
+			///
+			quint64 rerasters;
+
+			///
+			/// \brief Number of pixmaps evicted to stay within the budget.
+			///
+			quint64 evictions;
+		};
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		ItemCache();
+
+		///
+		/// \brief Draws an item from its cached pixmap, rendering it first if necessary.
+		///
+		/// Items in rotated views and items that would take up more than a quarter of the budget are painted directly.
+		///
+		/// \param [in] id              Id of the item, see createId().
+		/// \param [in] painter         Painter passed to QGraphicsItem::paint().
+		/// \param [in] rect            Bounding rectangle of the item in local coordinates.
+		/// \param [in] paintContent    Paints the item with the given painter.
+		///
+		void draw(quint64 id, QPainter *painter, const QRectF &rect,
+		          const std::function<void(QPainter *)> &paintContent);
+
+		///
+		/// \brief Discards the pixmap of an item, whose appearance has changed.
+		///
+		/// \param [in] id  Id of the item.
+		///
+		void invalidate(quint64 id);
+
+		///
+		/// \brief Forgets an item that is being deleted, together with its pixmap.
+		///
+		/// \param [in] id  Id of the item.
+		///
+		void remove(quint64 id);
+
+		///
+		/// \brief Starts a new frame, everything drawn before is considered off-screen until drawn again.
+		///
+		void beginFrame();
+
+		///
+		/// \brief Discards all pixmaps.
+		///
+		void clear();
+
+		///
+		/// \brief The memory budget of this cache.
+		///
+		/// \return Budget in bytes.
+		///
+		inline qint64 getBudget() const { return m_budget; }
+
+		///
+		/// \brief Sets a new memory budget and evicts pixmaps until the cache is within it.
+		///
+		/// \param [in] bytes   New budget in bytes.
+		///
+		void setBudget(qint64 bytes);
+
+		///
+		/// \brief The current counters of this cache.
+		///
+		/// \return Cache statistics.
+		///
+		inline const Statistics &getStatistics() const { return m_statistics; }
+
+		///
+		/// \brief Resets the hit, miss, re-raster and eviction counters to zero.
+		///
+		void resetStatistics();
+
+	public: // static methods
+
+		///
+		/// \brief Creates a new unique id for an item drawn with an ItemCache.
+		///
+		/// Ids are never reused, items release their entry with remove() when they are deleted.
+		///
+		/// \return New id.
+		///
+		static quint64 createId();
+
+		///
+		/// \brief The budget of newly created ItemCache%s.
+		///
+		/// \return Default budget in bytes.
+		///
+		static inline qint64 getDefaultBudget() { return s_defaultBudget; }
+
+		///
+		/// \brief Sets the budget of newly created ItemCache%s.
+		///
+		/// \param [in] bytes   New default budget in bytes.
+		///
+		static inline void setDefaultBudget(qint64 bytes) { s_defaultBudget = qMax(qint64(0), bytes); }
+
+	private: // structs
+
+		///
+		/// \brief A cached pixmap.
+		///
+		struct Entry
+		{
+			///
+			/// \brief The pixmap, null if it was invalidated.
+			///
+			QPixmap pixmap;
+
+			///
+			/// \brief Bounding rectangle of the item when the pixmap was rendered.
+			///
+			QRectF rect;
+
+			///
+			/// \brief Zoom of the painter when the pixmap was rendered.
+			///
+			qreal scale;
+
+			///
+			/// \brief Device pixel ratio when the pixmap was rendered.
+			///
+			qreal pixelRatio;
+
+			///
+			/// \brief Position in m_leastRecentlyUsed.
+			///
+			quint64 stamp;
+
+			///
+			/// \brief Frame in which the pixmap was drawn the last time.
+			///
+			quint64 frame;
+		};
+
+	private: // methods
+
+		///
+		/// \brief Marks an entry as the most recently used one.
+		///
+		/// \param [in] id      Id of the item.
+		/// \param [in] entry   Entry of the item.
+		///
+		void touch(quint64 id, Entry &entry);
+
+		///
+		/// \brief Evicts the least recently used pixmaps not drawn in the current frame, until the cache is within its
+		/// budget.
+		///
+		void evict();
+
+		///
+		/// \brief Memory used by a pixmap.
+		///
+		/// \param [in] pixmap  Pixmap, may be null.
+		///
+		/// \return             Size in bytes.
+		///
+		static qint64 getCost(const QPixmap &pixmap);
+
+	private: // members
+
+		///
+		/// \brief Cached pixmaps by item id.
+		///
+		QHash<quint64, Entry> m_entries;
+
+		///
+		/// \brief Item ids ordered by their last use, least recently used first.
+		///
+		QMap<quint64, quint64> m_leastRecentlyUsed;
+
+		///
+		/// \brief Source of the stamps in m_leastRecentlyUsed.
+		///
+		quint64 m_clock;
+
+		///
+		/// \brief Current frame.
+		///
+		quint64 m_frame;
+
+		///
+		/// \brief Memory budget in bytes.
+		///
+		qint64 m_budget;
+
+		///
+		/// \brief Counters.
+		///
+		Statistics m_statistics;
+
+	private: // static members
+
+		///
+		/// \brief Source of unique item ids.
+		///
+		static quint64 s_nextId;
+
+		///
+		/// \brief Budget of newly created ItemCache%s.
+		///
+		static qint64 s_defaultBudget;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_ITEMCACHE_H
@@ -0,0 +1,29 @@
+#include "nametable.h"
+
+namespace zodiac
+{
+
+	NameTable::NameTable()
+			: m_names(QVector<QString>({QString()})), m_atoms(QHash<QString, NameAtom>())
+	{
+	}
+
+	NameAtom NameTable::intern(const QString &name)
+	{
+		auto it = m_atoms.constFind(name);
+		if (it != m_atoms.constEnd())
+		{
+			return it.value();
+		}
+		NameAtom atom(quint32(m_names.size()));
+		m_names.append(name);
+		m_atoms.insert(name, atom);
+		return atom;
+	}
+
+	NameAtom NameTable::find(const QString &name) const
+	{
+		return m_atoms.value(name, NameAtom());
+	}
+
+} // namespace zodiac
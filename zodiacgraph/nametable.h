@@ -0,0 +1,213 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_NAMETABLE_H
+#define ZODIAC_NAMETABLE_H
+
+/// \file nametable.h
+///
+/// \brief Contains the definition of the zodiac::NameAtom and zodiac::NameTable classes.
+///
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include "flathashmap.h"
+
+namespace zodiac
+{
+
+///
+/// \brief Compact handle of a name interned in a NameTable.
+///
+/// Two atoms of the same table are equal, if and only if their names are equal, so comparing and hashing them is a
+/// single integer operation.
+/// The default-constructed atom is null and stands for no name at all.
+///
+	class Q_DECL_EXPORT NameAtom
+	{
+
+	public: // methods
+
+		///
+		/// \brief Default constructor, creates a null atom.
+		///
+		NameAtom()
+				: m_index(0) {}
+
+		///
+		/// \brief Tests whether this atom is null.
+		///
+		/// \return <i>true</i> if this atom does not stand for a name -- <i>false</i> otherwise.
+		///
+		inline bool isNull() const { return m_index == 0; }
+
+		///
+		/// \brief Index of the name in its NameTable.
+		///
+		/// \return Index of the name, 0 for the null atom.
+		///
+		inline quint32 getIndex() const { return m_index; }
+
+		///
+		/// \brief Equality operator.
+		///
+		/// \param [in] other   Atom to compare with.
+		///
+		/// \return             <i>true</i> if both atoms stand for the same name -- <i>false</i> otherwise.
+		///
+		inline bool operator==(const NameAtom &other) const { return m_index == other.m_index; }
+
+		///
+		/// \brief Inequality operator.
+		///
+		/// \param [in] other   Atom to compare with.
+		///
+		/// \return             <i>true</i> if both atoms stand for different names -- <i>false</i> otherwise.
+		///
+		inline bool operator!=(const NameAtom &other) const { return m_index != other.m_index; }
+
+		///
+		/// \brief Hash function for QHash.
+		///
+		/// \param [in] atom    Atom to hash.
+		/// \param [in] seed    Seed of the QHash.
+		///
+		/// \return             Hash value.
+		///
+		friend inline uint qHash(const NameAtom &atom, uint seed = 0) { return ::qHash(atom.m_index, seed); }
+
+	private: // methods
+
+		///
+		/// \brief Constructor, only used by the NameTable.
+		///
+		/// \param [in] index   Index of the name in the table.
+		///
+		explicit NameAtom(quint32 index)
+				: m_index(index) {}
+
+	private: // members
+
+		///
+		/// \brief Index of the name in its NameTable.
+		///
+		quint32 m_index;
+
+		friend class NameTable;
+
+	};
+
+///
+/// \brief Hashes a NameAtom by mixing all bits of its index (the finalizer of splitmix64).
+///
+	template<>
+	struct FlatHash<NameAtom>
+	{
+		///
+		/// \brief Hash function.
+		///
+		/// \param [in] key Atom to hash.
+		///
+		/// \return         64-bit hash of the atom.
+		///
+		inline quint64 operator()(const NameAtom &key) const
+		{
+			quint64 hash = quint64(key.getIndex());
+			hash = (hash ^ (hash >> 30)) * Q_UINT64_C(0xbf58476d1ce4e5b9);
+			hash = (hash ^ (hash >> 27)) * Q_UINT64_C(0x94d049bb133111eb);
+			return hash ^ (hash >> 31);
+		}
+	};
+
+///
+/// \brief Interns the Plug names of a Scene.
+///
+/// Every distinct name is stored once and handed out as a NameAtom.
+/// Atoms stay valid for the lifetime of the table, names that are no longer used are not released.
+///
+	class Q_DECL_EXPORT NameTable
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		NameTable();
+
+		///
+		/// \brief Returns the atom of a name, adding the name to the table if it is new.
+		///
+		/// \param [in] name    Name to intern.
+		///
+		/// \return             Atom of the name.
+		///
+		NameAtom intern(const QString &name);
+
+		///
+		/// \brief Looks up the atom of a name without adding it to the table.
+		///
+		/// \param [in] name    Name to look for.
+		///
+		/// \return             Atom of the name, or the null atom if the name was never interned.
+		///
+		NameAtom find(const QString &name) const;
+
+		///
+		/// \brief The name of an atom.
+		///
+		/// \param [in] atom    Atom of this table.
+		///
+		/// \return             Name of the atom, an empty string for the null atom.
+		///
+		inline QString getName(const NameAtom &atom) const { return m_names.at(int(atom.m_index)); }
+
+		///
+		/// \brief The number of interned names.
+		///
+		/// \return Number of names.
+		///
+		inline int size() const { return m_names.size() - 1; }
+
+	private: // members
+
+		///
+		/// \brief All interned names, indexed by their atom (the first one belongs to the null atom).
+		///
+		QVector<QString> m_names;
+
+		///
+		/// \brief Atoms of all interned names.
+		///
+		QHash<QString, NameAtom> m_atoms;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_NAMETABLE_H
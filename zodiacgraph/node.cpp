@@ -11,9 +11,11 @@
 #include <QtMath>                       // for M_PI
 #include <QVector2D>
 
+#include <algorithm>                    // for std::lower_bound
 #include <cfloat>                       // for DBL_MAX
 
 #include "edgegroupinterface.h"
+#include "graphstore.h"
 #include "nodelabel.h"
 #include "utils.h"
 #include "plug.h"
@@ -21,14 +23,13 @@
 #include "view.h"
 #include "perimeter.h"
 #include "plugarranger.h"
+#include "plugring.h"
 #include "straightedge.h"
 
 static void fireAnimation(QPropertyAnimation &animation, qreal targetValue, qreal startValue, qreal duration, const QEasingCurve &curve);
 
 static zodiac::Plug *findClosestPlug(const QPointF &pos, const QSet<zodiac::Plug *> &plugs, zodiac::Plug *closest);
 
-static qreal angularDistance(qreal alpha, qreal beta);
-
 namespace zodiac
 {
 
@@ -49,19 +50,23 @@ namespace zodiac
 
 	Node::Node(Scene *scene, const QString &displayName, const QUuid &uuid)
 			: QGraphicsObject(nullptr), m_scene(scene), m_displayName(displayName), m_uniqueId(uuid.isNull() ? QUuid::createUuid() : uuid),
-			  m_outgoingExpansionFactor(0.), m_incomingExpansionFactor(0.), m_perimeter(nullptr), m_allPlugs(QMap<QString, Plug *>()),
+			  m_outgoingExpansionFactor(0.), m_incomingExpansionFactor(0.), m_perimeter(nullptr), m_plugRing(nullptr),
+			  m_allPlugs(FlatHashMap<NameAtom, Plug *>()), m_plugList(QVector<Plug *>()),
 			  m_outgoingPlugs(QSet<Plug *>()), m_incomingPlugs(QSet<Plug *>()), m_straightEdges(QSet<StraightEdge *>()), m_label(nullptr),
-			  m_expansionState(NodeExpansion::NONE), m_lastExpansionState(NodeExpansion::NONE)
+			  m_expansionState(NodeExpansion::NONE), m_lastExpansionState(NodeExpansion::NONE),
+			  m_graphId(SlotId()), m_isArrangementStale(true)
 	{
 		// set QGraphicsObject flags
 		setFlag(ItemIsMovable);
 		setFlag(ItemIsSelectable);
 		setFlag(ItemIsFocusable);
-		setCacheMode(DeviceCoordinateCache);
+		setFlag(ItemSendsGeometryChanges);
+		setCacheMode(NoCache); // the shared SpriteAtlas of the scene replaces the per-item cache
 		setAcceptHoverEvents(true);
 
 		// create secondary items
 		m_perimeter = new Perimeter(this);
+		m_plugRing = new PlugRing(this);
 		m_label = new NodeLabel(this);
 
 		// initiate members influenced by styling
@@ -86,7 +91,12 @@ namespace zodiac
 		connect(&m_incomingCollapseAnimation, SIGNAL(finished()), this, SLOT(hasCompletelyCollapsed()));
 	}
 
-	Plug *Node::createPlug(const QString &name, PlugDirection direction)
+	Node::~Node()
+	{
+		m_scene->forgetNode(this);
+	}
+
+	Plug *Node::createPlug(const QString &name, PlugDirection direction, const SlotId &graphId)
 	{
 		// plugs must either be INcoming or OUTgoing
 #ifdef QT_DEBUG
@@ -101,7 +111,8 @@ namespace zodiac
 		// create and return the plug
 		QString uniqueName = getUniquePlugName(name);
 		Plug *newPlug = new Plug(this, uniqueName, direction);
-		m_allPlugs.insert(uniqueName, newPlug);
+		addPlugToIndex(newPlug);
+		m_scene->registerPlug(newPlug, graphId);
 
 		if (direction == PlugDirection::IN)
 		{
@@ -121,9 +132,9 @@ namespace zodiac
 	{
 		// make sure that the Plug is actually of this Node
 #ifdef QT_DEBUG
-		Q_ASSERT((m_allPlugs.value(plug->getName(), nullptr) == plug));
+		Q_ASSERT((m_allPlugs.value(plug->getNameAtom(), nullptr) == plug));
 #else
-		if ((m_allPlugs.value(plug->getName(), nullptr) != plug))
+		if ((m_allPlugs.value(plug->getNameAtom(), nullptr) != plug))
 		{
 			return false;
 		}
@@ -154,10 +165,15 @@ namespace zodiac
 		{
 			Perimeter::clearClosestPlugToMouse();
 		}
+		m_plugRing->forgetPlug(plug);
 
 		// remove the plug from the scene and memory
-		m_allPlugs.remove(plug->getName());
-		scene()->removeItem(plug);
+		removePlugFromIndex(plug);
+		m_scene->unregisterPlug(plug);
+		if (scene())
+		{
+			scene()->removeItem(plug); // a detached node takes its plugs with it
+		}
 		plug->deleteLater();
 
 		// adjust the node display
@@ -208,36 +224,48 @@ namespace zodiac
 			return;
 		}
 		m_displayName = displayName;
+		if (!m_graphId.isNull())
+		{
+			m_scene->getGraph().setNodeName(m_graphId, m_displayName);
+		}
 		m_label->setText(m_displayName);
-		for (Plug *plug: m_allPlugs)
+		m_scene->markIndexDirty(this);
+		for (Plug *plug: m_plugList)
 		{
 			plug->updateEdgeLabels();
 		}
 		for (StraightEdge *edge: m_straightEdges)
 		{
-			edge->updateLabel();
+			edge->invalidateLabel();
 		}
 		emit nodeRenamed(m_displayName);
 	}
 
+	Plug *Node::getPlug(const QString &name) const
+	{
+		// names that were never interned cannot belong to any plug
+		NameAtom atom = m_scene->getNameTable().find(name);
+		return atom.isNull() ? nullptr : m_allPlugs.value(atom, nullptr);
+	}
+
 	QString Node::renamePlug(Plug *plug, const QString &newName)
 	{
 		// make sure that the Plug is actually of this Node
 #ifdef QT_DEBUG
-		Q_ASSERT((m_allPlugs.value(plug->getName(), nullptr) == plug));
+		Q_ASSERT((m_allPlugs.value(plug->getNameAtom(), nullptr) == plug));
 #else
-		if ((m_allPlugs.value(plug->getName(), nullptr) != plug))
+		if ((m_allPlugs.value(plug->getNameAtom(), nullptr) != plug))
 		{
 			return "";
 		}
 #endif
 
 		// rename the plug and re-insert it with the new name
-		m_allPlugs.remove(plug->getName());
+		removePlugFromIndex(plug);
 
 		QString uniqueName = getUniquePlugName(newName, plug);
 		plug->setName(uniqueName);
-		m_allPlugs.insert(uniqueName, plug);
+		addPlugToIndex(plug);
 
 		return uniqueName;
 	}
@@ -246,16 +274,16 @@ namespace zodiac
 	{
 		// make sure that the Plug is actually of this Node
 #ifdef QT_DEBUG
-		Q_ASSERT((m_allPlugs.value(plug->getName(), nullptr) == plug));
+		Q_ASSERT((m_allPlugs.value(plug->getNameAtom(), nullptr) == plug));
 #else
-		if ((m_allPlugs.value(plug->getName(), nullptr) != plug))
+		if ((m_allPlugs.value(plug->getNameAtom(), nullptr) != plug))
 		{
 			return false;
 		}
 #endif
 
-		// only plugs without connections can change direction
-		if (plug->getEdgeCount() > 0)
+		// only plugs without connections can change direction, including those to nodes without items
+		if (plug->getConnectionCount() > 0)
 		{
 			return false;
 		}
@@ -268,6 +296,7 @@ namespace zodiac
 			m_incomingPlugs.remove(plug);
 			plug->setDirection(PlugDirection::OUT);
 			m_outgoingPlugs.insert(plug);
+			m_scene->getGraph().setPlugDirection(plug->getGraphId(), PlugDirection::OUT);
 
 		} else
 		{
@@ -276,6 +305,7 @@ namespace zodiac
 			m_outgoingPlugs.remove(plug);
 			plug->setDirection(PlugDirection::IN);
 			m_incomingPlugs.insert(plug);
+			m_scene->getGraph().setPlugDirection(plug->getGraphId(), PlugDirection::IN);
 		}
 
 		// initiate a complete update of the geometry
@@ -286,6 +316,13 @@ namespace zodiac
 
 	void Node::updateStyle()
 	{
+		// while the scene is building, arrange and restyle only once when the batch is closed
+		if (m_scene->isInBatch())
+		{
+			m_scene->deferNodeUpdate(this);
+			return;
+		}
+
 		prepareGeometryChange();
 
 		// apply the static style to this instance
@@ -304,11 +341,14 @@ namespace zodiac
 		m_perimeter->updateStyle();
 
 		// update style of plugs
-		for (Plug *plug: m_allPlugs.values())
+		for (Plug *plug: m_plugList)
 		{
 			plug->updateStyle();
 		}
 
+		// draw the plugs in a single item, if there are many of them
+		m_plugRing->updateStyle();
+
 //    arrangePlugs();
 	}
 
@@ -317,22 +357,20 @@ namespace zodiac
 		return m_boundingRect;
 	}
 
-	void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /* widget */)
+	void Node::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 	{
-		painter->setClipRect(option->exposedRect);
-
-		// draw the node a different color, if it is selected
-		if (isSelected())
-		{
-			painter->setBrush(s_selectedColor);
-		} else
+		// collapsed nodes are already part of the tiles
+		if (isTileable() && View::isTiled(widget))
 		{
-			painter->setBrush(s_idleColor);
+			return;
 		}
 
-		// draw core
-		painter->setPen(s_linePen);
-		painter->drawEllipse(quadrat(s_coreRadius));
+		painter->setClipRect(option->exposedRect);
+
+		// draw the node a different color, if it is selected, tiny nodes are drawn as flat dots
+		const QColor &color = isSelected() ? s_selectedColor : s_idleColor;
+		QPen pen = View::isDetailed(s_coreRadius, painter) ? s_linePen : QPen(Qt::NoPen);
+		m_scene->getSpriteAtlas().drawDisc(painter, QPointF(), s_coreRadius, color, pen);
 	}
 
 	QPainterPath Node::shape() const
@@ -394,16 +432,13 @@ namespace zodiac
 		// if this method is called, then the mouse is being dragged
 		s_mouseWasDragged = true;
 
-		// update the edges of all selected nodes, including yourself
-		for (QGraphicsItem *selectedItem: scene()->selectedItems())
+		// move all selected nodes, including yourself, and update their edges
+		if (!m_scene->isDraggingNodes())
 		{
-			Node *selectedNode = qobject_cast<Node *>(selectedItem->toGraphicsObject());
-			if (selectedNode)
-			{
-				selectedNode->updateConnectedEdges();
-			}
+			m_scene->beginNodeDrag(this);
 		}
 		QGraphicsObject::mouseMoveEvent(event);
+		m_scene->updateNodeDrag();
 	}
 
 	void Node::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
@@ -413,6 +448,10 @@ namespace zodiac
 		{
 			toggleExpansion();
 		}
+		if (m_scene->isDraggingNodes())
+		{
+			m_scene->endNodeDrag();
+		}
 		QGraphicsObject::mouseReleaseEvent(event);
 	}
 
@@ -432,10 +471,10 @@ namespace zodiac
 		if (event->key() == View::getActivationKey())
 		{
 			event->accept();
-			for (QGraphicsItem *selectedItem: scene()->selectedItems())
+			const QVector<Node *> selectedNodes = m_scene->getSelectedNodes(); // activation might change the selection
+			for (Node *selectedNode: selectedNodes)
 			{
-				Node *selectedNode = qobject_cast<Node *>(selectedItem->toGraphicsObject());
-				if ((selectedNode) && (selectedNode != this))
+				if (selectedNode != this)
 				{
 					emit selectedNode->nodeActivated();
 				}
@@ -445,10 +484,47 @@ namespace zodiac
 		QGraphicsObject::keyPressEvent(event);
 	}
 
+	QVariant Node::itemChange(GraphicsItemChange change, const QVariant &value)
+	{
+		// mirror the new position in the graph store
+		if ((change == ItemPositionHasChanged) && (!m_graphId.isNull()))
+		{
+			m_scene->getGraph().setNodePos(m_graphId, value.toPointF());
+		}
+
+		// moving the node changes the target directions of its own plugs and those connected to them,
+		// the scene invalidates the connected nodes only once before the next arrangement
+		// aggregates of the ClusterLayer are not part of the graph and have no connected plugs
+		if ((change == ItemPositionHasChanged) && (!m_graphId.isNull()))
+		{
+			m_isArrangementStale = true;
+			m_scene->markNodeMoved(this);
+		}
+
+		// keep the spatial index of the scene up to date
+		if ((change == ItemPositionHasChanged) || (change == ItemSceneHasChanged) || (change == ItemVisibleHasChanged))
+		{
+			m_scene->markIndexDirty(this);
+		}
+
+		// mirror the new selection state in the scene
+		if ((change == ItemSelectedHasChanged) && (!m_graphId.isNull()))
+		{
+			m_scene->updateNodeSelection(this, value.toBool());
+		}
+
+		// selected nodes are painted live instead of from the tiles
+		if (change == ItemSelectedHasChanged)
+		{
+			m_scene->markItemChanged(this);
+		}
+		return QGraphicsObject::itemChange(change, value);
+	}
+
 	QString Node::getUniquePlugName(const QString &name, const Plug *plug)
 	{
 		// if the name is already unique, just return it
-		if (!m_allPlugs.contains(name))
+		if (!getPlug(name))
 		{
 			return name;
 		}
@@ -460,7 +536,7 @@ namespace zodiac
 		do
 		{
 			uniqueName = name + s_plugSuffix + QString::number(index++);
-			testPlug = m_allPlugs.value(uniqueName, nullptr);
+			testPlug = getPlug(uniqueName);
 			if (testPlug == plug)
 			{ // if the user wants to rename x_2 to x while x already exists, that's a no-op
 				return uniqueName;
@@ -469,6 +545,26 @@ namespace zodiac
 		return uniqueName;
 	}
 
+	void Node::addPlugToIndex(Plug *plug)
+	{
+		m_allPlugs.insert(plug->getNameAtom(), plug);
+
+		// keep the list sorted by name, so the order of getPlugs() and the arrangement do not depend on history
+		const QString name = plug->getName();
+		auto position = std::lower_bound(m_plugList.begin(), m_plugList.end(), name,
+										 [](const Plug *other, const QString &otherName)
+										 {
+											 return other->getName() < otherName;
+										 });
+		m_plugList.insert(position, plug);
+	}
+
+	void Node::removePlugFromIndex(Plug *plug)
+	{
+		m_allPlugs.remove(plug->getNameAtom());
+		m_plugList.removeOne(plug);
+	}
+
 	void Node::hasCompletelyCollapsed()
 	{
 		// this slot is called when the incoming OR outgoing plugs have collapsed but we want only the second call
@@ -482,7 +578,12 @@ namespace zodiac
 
 	void Node::aboutToExpandAfresh()
 	{
-		arrangePlugs();
+		// the arrangement might still be fresh from Scene::arrangeAllPlugs()
+		m_scene->flushMovedNodes();
+		if (m_isArrangementStale)
+		{
+			arrangePlugs();
+		}
 	}
 
 	void Node::setExpansion(NodeExpansion newState)
@@ -492,6 +593,9 @@ namespace zodiac
 			return;
 		}
 
+		// the plugs of this node move with the expansion and with them the targets of the connected plugs
+		invalidateConnectedArrangements();
+
 		if (newState == NodeExpansion::NONE)
 		{
 			m_outgoingExpandAnimation.stop();
@@ -538,12 +642,34 @@ namespace zodiac
 
 		m_lastExpansionState = m_expansionState;
 		m_expansionState = newState;
+
+		// collapsed nodes are drawn from the tiles of a View, expanded ones are not
+		m_scene->markItemChanged(this);
+		update();
+	}
+
+	bool Node::isTileable() const
+	{
+		return (m_expansionState == NodeExpansion::NONE) && !isSelected();
+	}
+
+	bool Node::isRemovable() const
+	{
+		// test the plugs rather than the straight edges, aggregate edges of collapsed clusters do not count
+		for (Plug *plug: m_plugList)
+		{
+			if (!plug->isRemovable())
+			{
+				return false;
+			}
+		}
+		return true;
 	}
 
 	void Node::updateConnectedEdges()
 	{
 		// plugs
-		for (Plug *plug: m_allPlugs)
+		for (Plug *plug: m_plugList)
 		{
 			plug->updateEdges();
 		}
@@ -568,6 +694,7 @@ namespace zodiac
 		{
 			plug->updateExpansion(m_incomingExpansionFactor);
 		}
+		m_plugRing->updatePlugs();
 	}
 
 	void Node::updateOutgoingSpread(qreal expansion)
@@ -583,25 +710,83 @@ namespace zodiac
 		{
 			plug->updateExpansion(m_outgoingExpansionFactor);
 		}
+		m_plugRing->updatePlugs();
+	}
+
+	void Node::invalidateConnectedArrangements()
+	{
+		for (Plug *plug: m_plugList)
+		{
+			for (Plug *connectedPlug: plug->getConnectedPlugs())
+			{
+				connectedPlug->getNode()->invalidateArrangement();
+			}
+		}
 	}
 
 	void Node::arrangePlugs()
 	{
+		Arrangement arrangement = prepareArrangement();
+		solveArrangement(arrangement);
+		applyArrangement(arrangement);
+	}
+
+	Node::Arrangement Node::prepareArrangement() const
+	{
+		Arrangement arrangement;
+
 		// return early if there are no plugs to arrange
-		int plugCount = m_allPlugs.size();
+		int plugCount = m_plugList.size();
 		if (plugCount == 0)
 		{
-			return;
+			return arrangement;
 		}
 
 		// at first, there are as many zones above as are below the label
 		int evenZoneCount = plugCount + (plugCount % 2);
 		int halfZoneCount = evenZoneCount / 2;
-		qreal gapAngle = getGapAngle();
+		arrangement.plugCount = plugCount;
+		arrangement.halfZoneCount = halfZoneCount;
+		arrangement.gapAngle = getGapAngle();
 
 		// the deadzone is calculated at the height of the label at the inner radius of an incoming plug
 		// it is the angular part of the perimeter that could be taken up by the node's label
-		qreal halfDeadAngle = getDeadZoneAngle() * 0.5;
+		arrangement.halfDeadAngle = getDeadZoneAngle() * 0.5;
+
+		// get the target direction and priority of each connected plug once, as structure of arrays for the cost kernel
+		arrangement.connectedPlugs.reserve(plugCount);
+		arrangement.plugDirections.reserve(plugCount);
+		arrangement.plugPriorities.reserve(plugCount);
+		for (int plugIndex = 0; plugIndex < plugCount; ++plugIndex)
+		{
+			Plug *plug = m_plugList.at(plugIndex);
+			if (plug->getEdgeCount() == 0)
+			{
+				continue;
+			}
+
+			// calling atan2 with (-y, x) turns the direction from Qt's screen coordinates (with an inverted y-axis) to
+			// the one used by me, where positive x is right, positive y is up and the zero-angle is on positive x.
+			QVector2D plugTarget = plug->getTargetNormal();
+			arrangement.connectedPlugs.append(plugIndex);
+			arrangement.plugDirections.append(qAtan2(-plugTarget.y(), plugTarget.x()));
+			arrangement.plugPriorities.append(plug->getArrangementPriority());
+		}
+
+		return arrangement;
+	}
+
+	void Node::solveArrangement(Arrangement &arrangement)
+	{
+		int plugCount = arrangement.plugCount;
+		if (plugCount == 0)
+		{
+			return;
+		}
+		int halfZoneCount = arrangement.halfZoneCount;
+		int evenZoneCount = halfZoneCount * 2;
+		qreal gapAngle = arrangement.gapAngle;
+		qreal halfDeadAngle = arrangement.halfDeadAngle;
 
 		// calculate the zone directions
 		QVector<qreal> zoneDirections(evenZoneCount);
@@ -625,28 +810,15 @@ namespace zodiac
 			}
 		}
 
-		// get the plugs' target directions
-		QList<Plug *> plugs = m_allPlugs.values();
-		QList<QPair<Plug *, qreal>> plugDirections;
-		for (Plug *plug: plugs)
-		{
-			if (plug->getEdgeCount() == 0)
-			{
-				continue;
-			}
-
-			// calling atan2 with (-y, x) turns the direction from Qt's screen coordinates (with an inverted y-axis) to
-			// the one used by me, where positive x is right, positive y is up and the zero-angle is on positive x.
-			QVector2D plugTarget = plug->getTargetNormal();
-			plugDirections.append(QPair<Plug *, qreal>(plug, qAtan2(-plugTarget.y(), plugTarget.x())));
-		}
-
-		// calculate a trivial path for all unconnected Plugs
-		int connectedPlugCount = plugDirections.count();
-		QVector<int> optimalPath;
+		// calculate a trivial path for all unconnected Plugs, and its inverse mapping zones to plugs (-1 if empty)
+		const QVector<int> &connectedPlugs = arrangement.connectedPlugs;
+		int connectedPlugCount = connectedPlugs.count();
+		QVector<int> optimalPath(plugCount);
+		QVector<int> zonePlugs(evenZoneCount, -1);
 		for (int i = 0; i < plugCount; ++i)
 		{
-			optimalPath.append(i);
+			optimalPath[i] = i;
+			zonePlugs[i] = i;
 		}
 
 		// if there are connected plugs, calculcate their semi-optimal placement
@@ -654,31 +826,27 @@ namespace zodiac
 		{
 
 			// build the cost table
-			QVector<qreal> costTable(connectedPlugCount * evenZoneCount);
-			for (int row = 0; row < connectedPlugCount; ++row)
-			{
-				Plug *plug = plugDirections.at(row).first;
-				qreal plugDirection = plugDirections.at(row).second;
-				for (int column = 0; column < evenZoneCount; ++column)
-				{
-					qreal cost = angularDistance(plugDirection, zoneDirections[column]) * plug->getArrangementPriority();
-					costTable[(row * evenZoneCount) + column] = cost * cost;
-				}
-			}
+			QVector<qreal> costTable;
+			zodiac::fillCostTable(costTable, arrangement.plugDirections, arrangement.plugPriorities, zoneDirections);
+
+			// the exact solver finds cheaper arrangements than the greedy heuristic at every size and is not much slower,
+			// see benchmarks/plugarrangerbenchmark.cpp
+			QVector<int> zoneIndices = zodiac::arrangePlugsOptimally(costTable, connectedPlugCount, evenZoneCount);
 
-			// modify the trivial path to the semi-optimal one
-			int i = 0;
-			for (int zoneIndex: zodiac::arrangePlugs(costTable, connectedPlugCount, evenZoneCount))
+			// modify the trivial path to the optimal one
+			for (int i = 0; i < connectedPlugCount; ++i)
 			{
-				int plugIndex = plugs.indexOf(plugDirections.at(i).first);
+				int zoneIndex = zoneIndices.at(i);
+				int plugIndex = connectedPlugs.at(i);
 				int tZoneIndex = optimalPath[plugIndex];
-				int occupiedIndex = optimalPath.indexOf(zoneIndex);
+				int occupiedIndex = zonePlugs[zoneIndex];
 				optimalPath[plugIndex] = zoneIndex;
+				zonePlugs[zoneIndex] = plugIndex;
+				zonePlugs[tZoneIndex] = occupiedIndex;
 				if (occupiedIndex != -1)
 				{
 					optimalPath[occupiedIndex] = tZoneIndex;
 				}
-				++i;
 			}
 		}
 
@@ -687,15 +855,7 @@ namespace zodiac
 		{
 
 			// find the empty zone index
-			int emptyZoneIndex = -1;
-			for (int i = 0; i < evenZoneCount; ++i)
-			{
-				if (!optimalPath.contains(i))
-				{
-					emptyZoneIndex = i;
-					break;
-				}
-			}
+			int emptyZoneIndex = zonePlugs.indexOf(-1);
 
 			// find out if the empty zone is in the top or bottom half
 			qreal offset;
@@ -728,13 +888,32 @@ namespace zodiac
 			}
 		}
 
+		// store the direction of each plug
+		arrangement.plugAngles.resize(plugCount);
+		for (int plugIndex = 0; plugIndex < plugCount; ++plugIndex)
+		{
+			arrangement.plugAngles[plugIndex] = zoneDirections.at(optimalPath.at(plugIndex));
+		}
+	}
+
+	void Node::applyArrangement(const Arrangement &arrangement)
+	{
+		// the arrangement does not fit, if plugs were added or removed since it was prepared
+		int plugCount = m_plugList.size();
+		if (arrangement.plugAngles.size() != plugCount)
+		{
+			return;
+		}
+		m_isArrangementStale = false;
+
 		// apply the plug placement
 		qreal plugSweepAngle = getPlugAngle();
 		for (int plugIndex = 0; plugIndex < plugCount; ++plugIndex)
 		{
-			qreal angle = zoneDirections.at(optimalPath.at(plugIndex));
-			plugs.at(plugIndex)->defineShape(QVector2D(qCos(angle), -qSin(angle)), plugSweepAngle);
+			qreal angle = arrangement.plugAngles.at(plugIndex);
+			m_plugList.at(plugIndex)->defineShape(QVector2D(qCos(angle), -qSin(angle)), plugSweepAngle);
 		}
+		m_plugRing->updateDirections();
 	}
 
 	qreal Node::getPlugAngle() const
@@ -754,12 +933,22 @@ namespace zodiac
 
 	void Node::adjustRadius()
 	{
+		m_scene->markIndexDirty(this);
+
+		// the gap and deadzone angles of the arrangement depend on the radius
+		m_isArrangementStale = true;
+		qreal oldRadius = m_perimeter->getRadius();
+
 		//
 		// return early, if there are no plugs on this node
-		int plugCount = m_allPlugs.count();
+		int plugCount = m_plugList.count();
 		if (plugCount == 0)
 		{
 			m_perimeter->setRadius(0.); // resets the perimeter's radius to its minimal radius
+			if (!m_graphId.isNull())
+			{
+				m_scene->getGraph().setNodeRadius(m_graphId, m_perimeter->getRadius());
+			}
 			return;
 		}
 
@@ -772,6 +961,16 @@ namespace zodiac
 				  + (deadArcLength * 2);
 		qreal radius = requiredArcLength / (2 * M_PI);
 		m_perimeter->setRadius(radius); // perimeter does not shrink pass its minimal radius
+		if (!m_graphId.isNull())
+		{
+			m_scene->getGraph().setNodeRadius(m_graphId, m_perimeter->getRadius());
+		}
+
+		// connected plugs target the perimeter of this node
+		if (!qFuzzyCompare(oldRadius, m_perimeter->getRadius()))
+		{
+			invalidateConnectedArrangements();
+		}
 
 		//
 		// update the shape and position of all plugs
@@ -785,6 +984,7 @@ namespace zodiac
 			plug->defineShape(plug->getNormal(), getPlugAngle());
 			plug->updateExpansion(m_outgoingExpansionFactor);
 		}
+		m_plugRing->updateDirections();
 	}
 
 	void Node::updateOutlinePen()
@@ -853,7 +1053,7 @@ static zodiac::Plug *findClosestPlug(const QPointF &pos, const QSet<zodiac::Plug
 	{
 
 		// skip incoming plugs that already have an edge connected
-		if ((plug->getDirection() == zodiac::PlugDirection::IN) && (plug->getEdgeCount() > 0))
+		if ((plug->getDirection() == zodiac::PlugDirection::IN) && (plug->getConnectionCount() > 0))
 		{
 			continue;
 		}
@@ -867,25 +1067,3 @@ static zodiac::Plug *findClosestPlug(const QPointF &pos, const QSet<zodiac::Plug
 	}
 	return closest;
 }
-
-///
-/// \brief Calculates the angular distance between two angles, always returning a positive result.
-///
-/// \param [in] alpha   First angle.
-/// \param [in] beta    Second angle.
-///
-/// \return             Angular distance in postive radian [0 -> pi].
-///
-static qreal angularDistance(qreal alpha, qreal beta)
-{
-	static const qreal TWO_PI = M_PI * 2;
-
-	qreal result = qAbs(alpha - beta);
-	if (result > M_PI)
-	{
-		return TWO_PI - result;
-	} else
-	{
-		return result;
-	}
-}
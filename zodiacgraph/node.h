@@ -34,9 +34,13 @@
 #include <QPropertyAnimation>
 #include <QSet>
 #include <QUuid>
+#include <QVector>
 #include <QtGlobal>
 #include <QMetaType>
 
+#include "flathashmap.h"
+#include "nametable.h"
+#include "slotmap.h"
 #include "utils.h"
 
 namespace zodiac
@@ -48,6 +52,8 @@ namespace zodiac
 
 	class Plug;
 
+	class PlugRing;
+
 	class StraightEdge;
 
 	class Scene;
@@ -92,6 +98,67 @@ namespace zodiac
 		///
 		Q_PROPERTY(qreal incomingSpread MEMBER m_incomingExpansionFactor WRITE updateIncomingSpread)
 
+	public: // structs
+
+		///
+		/// \brief Snapshot of everything needed to arrange the Plug%s of a Node, and the result of the arrangement.
+		///
+		/// Is filled by prepareArrangement() on the GUI thread, solved by solveArrangement() on any thread and applied
+		/// by applyArrangement() on the GUI thread again.
+		///
+		struct Arrangement
+		{
+			///
+			/// \brief Constructor.
+			///
+			Arrangement()
+					: plugCount(0), halfZoneCount(0), halfDeadAngle(0.), gapAngle(0.),
+					  connectedPlugs(QVector<int>()), plugDirections(QVector<qreal>()),
+					  plugPriorities(QVector<qreal>()), plugAngles(QVector<qreal>())
+			{
+			}
+
+			///
+			/// \brief Number of all Plug%s of the Node.
+			///
+			int plugCount;
+
+			///
+			/// \brief Number of zones above (and below) the NodeLabel.
+			///
+			int halfZoneCount;
+
+			///
+			/// \brief Half of the deadzone angle in radians.
+			///
+			qreal halfDeadAngle;
+
+			///
+			/// \brief Gap angle between Plug%s in radians.
+			///
+			qreal gapAngle;
+
+			///
+			/// \brief Index of each connected Plug in the list of all Plug%s.
+			///
+			QVector<int> connectedPlugs;
+
+			///
+			/// \brief Target direction of each connected Plug in radians.
+			///
+			QVector<qreal> plugDirections;
+
+			///
+			/// \brief Arrangement priority of each connected Plug.
+			///
+			QVector<qreal> plugPriorities;
+
+			///
+			/// \brief Resulting direction of each Plug in radians, empty until solved.
+			///
+			QVector<qreal> plugAngles;
+		};
+
 	public: // methods
 
 		///
@@ -105,6 +172,13 @@ namespace zodiac
 		///
 		explicit Node(Scene *scene, const QString &displayName, const QUuid &uuid = QUuid());
 
+		///
+		/// \brief Destructor.
+		///
+		/// Removes this Node from the registers of its Scene.
+		///
+		~Node();
+
 		///
 		/// \brief The unique identifier of this Node.
 		///
@@ -116,6 +190,22 @@ namespace zodiac
 		///
 		const QUuid &getUniqueId() const { return m_uniqueId; }
 
+		///
+		/// \brief Id of this Node in the GraphStore of its Scene.
+		///
+		/// \return Id of this Node in the GraphStore of its Scene, or a null SlotId if it is not registered.
+		///
+		inline const SlotId &getGraphId() const { return m_graphId; }
+
+		///
+		/// \brief Sets the id of this Node in the GraphStore of its Scene.
+		///
+		/// Must only be called by the Scene.
+		///
+		/// \param [in] id  New id of this Node.
+		///
+		inline void setGraphId(const SlotId &id) { m_graphId = id; }
+
 		///
 		/// \brief Creates and adds a new Plug to this Node.
 		///
@@ -128,10 +218,13 @@ namespace zodiac
 		///
 		/// \param [in] name        The proposed name of the plug.
 		/// \param [in] direction   Direction of the plug.
+		/// \param [in] graphId     (optional) Id of an existing plug of this Node in the GraphStore that the new Plug
+		///                         is created for.
+		///                         If null, a new plug is added to the GraphStore.
 		///
 		/// \return                 The created Plug.
 		///
-		Plug *createPlug(const QString &name, PlugDirection direction);
+		Plug *createPlug(const QString &name, PlugDirection direction, const SlotId &graphId = SlotId());
 
 		///
 		/// \brief Removes an existing Plug from this Node.
@@ -261,7 +354,72 @@ namespace zodiac
 		///
 		/// \return All Plug%s of this Node.
 		///
-		QList<Plug *> getPlugs() const { return m_allPlugs.values(); }
+		QList<Plug *> getPlugs() const { return m_plugList.toList(); }
+
+		///
+		/// \brief All Plug%s of this Node in the order of their names, without copying them into a QList.
+		///
+		/// \return All Plug%s of this Node.
+		///
+		inline const QVector<Plug *> &getPlugList() const { return m_plugList; }
+
+		///
+		/// \brief The PlugRing drawing the Plug%s of this Node, if it has many of them.
+		///
+		/// \return PlugRing of this Node.
+		///
+		inline PlugRing *getPlugRing() const { return m_plugRing; }
+
+		///
+		/// \brief Updates all edges connecting to any Plug of this Node.
+		///
+		void updateConnectedEdges();
+
+		///
+		/// \brief Marks the arrangement of the Plug%s as stale, so it is recalculated before the Node expands again.
+		///
+		inline void invalidateArrangement() { m_isArrangementStale = true; }
+
+		///
+		/// \brief Marks the arrangement of every Node connected to this one as stale.
+		///
+		/// Their Plug%s target the Plug%s of this Node, so they have to be arranged again after this Node has moved,
+		/// started to expand or collapse or changed its radius.
+		///
+		void invalidateConnectedArrangements();
+
+		///
+		/// \brief Marks the arrangement of the Plug%s as up to date.
+		///
+		/// Used by Scene::arrangeAllPlugs() for Node%s that were arranged together from the same snapshot.
+		/// Their new Plug directions invalidate each other, but solving them again would never settle.
+		///
+		inline void validateArrangement() { m_isArrangementStale = false; }
+
+		///
+		/// \brief Checks if the Plug%s have to be arranged again, because the Node or one of its neighbours has changed.
+		///
+		/// \return    <i>true</i>, if the arrangement of the Plug%s is stale.
+		///
+		inline bool isArrangementStale() const { return m_isArrangementStale; }
+
+		///
+		/// \brief Takes a snapshot of the Plug%s of this Node, to be arranged by solveArrangement().
+		///
+		/// Must be called on the GUI thread.
+		///
+		/// \return    Unsolved arrangement of the Plug%s of this Node.
+		///
+		Arrangement prepareArrangement() const;
+
+		///
+		/// \brief Moves the Plug%s of this Node to the directions of a solved arrangement.
+		///
+		/// Is ignored, if Plug%s were added to or removed from the Node since the arrangement was prepared.
+		///
+		/// \param [in] arrangement    Arrangement prepared by this Node and solved by solveArrangement().
+		///
+		void applyArrangement(const Arrangement &arrangement);
 
 		///
 		/// \brief Queries a single Plug from this Node.
@@ -270,7 +428,7 @@ namespace zodiac
 		///
 		/// \return             The requested Plug or nullptr, if there is no Plug by the name.
 		///
-		Plug *getPlug(const QString &name) const { return m_allPlugs.value(name, nullptr); }
+		Plug *getPlug(const QString &name) const;
 
 		///QS
 		/// \brief  The current expansion factor [0 -> 1] of the incoming Plug%s of this Node.
@@ -286,12 +444,28 @@ namespace zodiac
 		///
 		inline qreal getOutgoingExpansionFactor() const { return m_outgoingExpansionFactor; }
 
+		///
+		/// \brief All StraightEdge%s and StraightDoubleEdge%s connected to this Node.
+		///
+		/// \return StraightEdge%s of this Node.
+		///
+		inline const QSet<StraightEdge *> &getStraightEdges() const { return m_straightEdges; }
+
 		///
 		/// \brief Tests, whether this Node could currently be removed from the Scene.
 		///
 		/// \return <i>true</i> if the node has no PlugEdge%s connected -- <i>false</i> otherwise.
 		///
-		inline bool isRemovable() const { return m_straightEdges.size() == 0; }
+		bool isRemovable() const;
+
+		///
+		/// \brief Tests, whether this Node is currently part of the static content drawn by the TileCache of a View.
+		///
+		/// Tiled Node%s skip their paint() call in View%s with an enabled TileCache.
+		///
+		/// \return <i>true</i> if the Node is collapsed and not selected -- <i>false</i> if it is painted live.
+		///
+		bool isTileable() const;
 
 		///
 		/// \brief The current Expansions state of this Node.
@@ -408,6 +582,15 @@ namespace zodiac
 
 	public: // static methods
 
+		///
+		/// \brief Finds the direction of each Plug in an arrangement prepared by prepareArrangement().
+		///
+		/// Only works on the snapshot and can be called on any thread.
+		///
+		/// \param [in,out] arrangement    Arrangement to solve, its plugAngles are filled.
+		///
+		static void solveArrangement(Arrangement &arrangement);
+
 		///
 		/// \brief The radius of Node cores in pixels.
 		///
@@ -668,6 +851,18 @@ namespace zodiac
 		///
 		void keyPressEvent(QKeyEvent *event);
 
+		///
+		/// \brief Called when the state of this item changes.
+		///
+		/// Keeps the position of this Node in the Scene's GraphStore and the Scene's selection up-to-date.
+		///
+		/// \param [in] change  What has changed.
+		/// \param [in] value   New value of the change.
+		///
+		/// \return             Adjusted value.
+		///
+		QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
 	private: // methods
 
 		///
@@ -686,6 +881,20 @@ namespace zodiac
 		///
 		QString getUniquePlugName(const QString &name, const Plug *plug = nullptr);
 
+		///
+		/// \brief Adds a Plug to the index of all Plug%s by name and to the sorted list of all Plug%s.
+		///
+		/// \param [in] plug    Plug to add under its current name.
+		///
+		void addPlugToIndex(Plug *plug);
+
+		///
+		/// \brief Removes a Plug from the index of all Plug%s by name and from the sorted list of all Plug%s.
+		///
+		/// \param [in] plug    Plug to remove under its current name.
+		///
+		void removePlugFromIndex(Plug *plug);
+
 	private slots:
 
 		///
@@ -714,11 +923,6 @@ namespace zodiac
 		///
 		inline void resetExpansion() { setExpansion(m_lastExpansionState); }
 
-		///
-		/// \brief Updates all edges connecting to any Plug of this Node.
-		///
-		void updateConnectedEdges();
-
 		///
 		/// \brief Called by the incoming expansion and collapse-animations to update the spread factor of incoming Plug%s.
 		///
@@ -737,6 +941,8 @@ namespace zodiac
 		/// \brief Arranges the Plug%s of this Node around the Perimeter.
 		///
 		/// The order is based on the Plug%s target direction and preferred angle.
+		/// Prepares, solves and applies the Arrangement right away.
+		/// See Scene::arrangeAllPlugs() to arrange the Plug%s of all Node%s at once.
 		///
 		void arrangePlugs();
 
@@ -826,11 +1032,21 @@ namespace zodiac
 		Perimeter *m_perimeter;
 
 		///
-		/// \brief All Plug%s of this Node, indexed by name.
+		/// \brief PlugRing drawing the Plug%s of this Node, if it has many of them.
+		///
+		PlugRing *m_plugRing;
+
+		///
+		/// \brief All Plug%s of this Node, indexed by the atom of their name.
 		///
 		/// A Plug can be uniquely identified by its name.
 		///
-		QMap<QString, Plug *> m_allPlugs;
+		FlatHashMap<NameAtom, Plug *> m_allPlugs;
+
+		///
+		/// \brief All Plug%s of this Node, in the order of their names.
+		///
+		QVector<Plug *> m_plugList;
 
 		///
 		/// \brief All outgoing Plug%s of this Node.
@@ -869,6 +1085,16 @@ namespace zodiac
 		///
 		NodeExpansion m_lastExpansionState;
 
+		///
+		/// \brief Id of this Node in the GraphStore of its Scene.
+		///
+		SlotId m_graphId;
+
+		///
+		/// \brief Is true, if the Plug%s have to be arranged again before the Node expands.
+		///
+		bool m_isArrangementStale;
+
 	private: // static members
 
 		///
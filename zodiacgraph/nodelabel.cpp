@@ -1,11 +1,14 @@
 #include "nodelabel.h"
 
-#include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
 #include <QStyleOptionGraphicsItem>
 #include <QPainter>
 
+#include "itemcache.h"
 #include "node.h"
+#include "scene.h"
+#include "textlayoutcache.h"
+#include "view.h"
 
 namespace zodiac
 {
@@ -21,26 +24,27 @@ namespace zodiac
 	QPen NodeLabel::s_linePen = QPen(QBrush(s_lineColor), s_outlineWidth);
 
 	NodeLabel::NodeLabel(Node *parent)
-			: QGraphicsObject(parent)
+			: QGraphicsObject(parent), m_scene(parent->getScene()), m_cacheId(ItemCache::createId())
 	{
 		// core only expands if you hover above it, not above the label
 		setAcceptHoverEvents(false);
 
-		// cache the label
-		setCacheMode(DeviceCoordinateCache);
+		// the label is cached in the budgeted ItemCache of the scene instead of Qt's unbounded item cache
+		setCacheMode(NoCache);
 
 		// get the text from the node
 		setText(parent->getDisplayName());
 	}
 
+	NodeLabel::~NodeLabel()
+	{
+		m_scene->getItemCache().remove(m_cacheId);
+	}
+
 	void NodeLabel::setText(const QString &text)
 	{
 		// update the text
 		m_text = QStaticText(text);
-		m_text.setTextFormat(Qt::PlainText);
-		QTextOption textOption = QTextOption(Qt::AlignHCenter | Qt::AlignBaseline);
-		textOption.setUseDesignMetrics(false);
-		m_text.setTextOption(textOption);
 		updateStyle();
 	}
 
@@ -48,9 +52,13 @@ namespace zodiac
 	{
 		prepareGeometryChange();
 
+		// fetch the shaped text from the scene, most names are laid out only once
+		TextLayoutCache::Layout layout = m_scene->getTextLayoutCache().getLayout(
+				m_text.text(), s_font, 0., Qt::AlignHCenter | Qt::AlignBaseline);
+		m_text = layout.text;
+
 		// update the text position
-		m_text.prepare(QTransform(), s_font);
-		QSizeF textSize = m_text.size();
+		QSizeF textSize = layout.size;
 		m_textPos = QPointF(textSize.width() / -2., textSize.height() / -2.);
 
 		// update the label
@@ -62,6 +70,7 @@ namespace zodiac
 		qreal halfLine = s_outlineWidth * 0.5;
 		m_boundingRect = m_outlineRect.marginsAdded(QMarginsF(halfLine, halfLine, halfLine, halfLine));
 
+		m_scene->getItemCache().invalidate(m_cacheId);
 		update();
 	}
 
@@ -72,17 +81,26 @@ namespace zodiac
 
 	void NodeLabel::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /* widget */)
 	{
-		painter->setClipRect(option->exposedRect);
+		// skip labels that are too small to be read
+		if (!View::isReadable(s_font.pointSizeF(), painter))
+		{
+			return;
+		}
 
-		// draw the background
-		painter->setPen(s_linePen);
-		painter->setBrush(s_backgroundColor);
-		painter->drawRoundedRect(m_outlineRect, s_roundEdgeRadius, s_roundEdgeRadius, Qt::AbsoluteSize);
+		painter->setClipRect(option->exposedRect);
 
-		// draw the text
-		painter->setFont(s_font);
-		painter->setPen(s_textColor);
-		painter->drawStaticText(m_textPos, m_text);
+		m_scene->getItemCache().draw(m_cacheId, painter, m_boundingRect, [this](QPainter *cachePainter)
+		{
+			// draw the background
+			cachePainter->setPen(s_linePen);
+			cachePainter->setBrush(s_backgroundColor);
+			cachePainter->drawRoundedRect(m_outlineRect, s_roundEdgeRadius, s_roundEdgeRadius, Qt::AbsoluteSize);
+
+			// draw the text
+			cachePainter->setFont(s_font);
+			cachePainter->setPen(s_textColor);
+			cachePainter->drawStaticText(m_textPos, m_text);
+		});
 	}
 
 	QPainterPath NodeLabel::shape() const
@@ -108,10 +126,7 @@ namespace zodiac
 				parentItem()->setSelected(!parentItem()->isSelected()); // multi-selection
 			} else
 			{
-				for (QGraphicsItem *item: scene()->selectedItems())
-				{    // single selection
-					item->setSelected(false);
-				}
+				static_cast<Node *>(parentItem())->getScene()->deselectAllNodes(); // single selection
 				parentItem()->setSelected(true);
 			}
 			event->accept();
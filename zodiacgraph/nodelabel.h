@@ -42,6 +42,7 @@ namespace zodiac
 {
 
 	class Node;
+	class Scene;
 
 ///
 /// \brief Label of a Node.
@@ -61,6 +62,13 @@ namespace zodiac
 		///
 		explicit NodeLabel(Node *parent);
 
+		///
+		/// \brief Destructor.
+		///
+		/// Releases the cached pixmap of this label.
+		///
+		~NodeLabel();
+
 		///
 		/// \brief Defines a new label text to display.
 		///
@@ -291,6 +299,16 @@ namespace zodiac
 		///
 		QPointF m_textPos;
 
+		///
+		/// \brief Scene containing the Node of this label.
+		///
+		Scene *m_scene;
+
+		///
+		/// \brief Key of this label in the ItemCache of its Scene.
+		///
+		quint64 m_cacheId;
+
 	private: // static members
 
 		///
@@ -7,6 +7,7 @@
 #include "plug.h"
 #include "utils.h"
 #include "node.h"
+#include "scene.h"
 #include "view.h"
 
 namespace zodiac
@@ -23,7 +24,9 @@ namespace zodiac
 	{
 		// the perimeter needs to stack behind the parent
 		setFlag(ItemStacksBehindParent);
-		setCacheMode(DeviceCoordinateCache);
+
+		// the shared SpriteAtlas of the scene replaces the per-item cache
+		setCacheMode(NoCache);
 
 		// doesn't do anything with them, but needs to be enabled so they get send up to the node
 		setAcceptHoverEvents(true);
@@ -42,9 +45,7 @@ namespace zodiac
 		painter->setClipRect(option->exposedRect);
 
 		// draw perimeter
-		painter->setBrush(s_color);
-		painter->setPen(Qt::NoPen);
-		painter->drawEllipse(quadrat(m_radius));
+		m_node->getScene()->getSpriteAtlas().drawDisc(painter, QPointF(), m_radius, s_color, QPen(Qt::NoPen));
 	}
 
 	QPainterPath Perimeter::shape() const
@@ -1,17 +1,22 @@
 #include "plug.h"
 
 #include <QGraphicsSceneMouseEvent>
-#include <QtMath>                       // for M_PI, qRadiansToDegrees
+#include <QtMath>                       // for qAtan2
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
+#include <QTransform>
 
 #include "drawedge.h"
+#include "graphstore.h"
+#include "itemcache.h"
 #include "node.h"
 #include "scene.h"
 #include "utils.h"
 #include "perimeter.h"
 #include "plugedge.h"
 #include "pluglabel.h"
+#include "plugring.h"
+#include "view.h"
 
 static QGraphicsItem *getRootItemOf(QGraphicsItem *item);
 
@@ -29,12 +34,16 @@ namespace zodiac
 	Plug *Plug::s_edgeDrawingPlug = nullptr;
 
 	Plug::Plug(Node *parent, const QString &name, PlugDirection direction)
-			: QGraphicsObject(parent), m_name(name), m_direction(direction), m_node(parent), m_arclength(0.1), m_normal(QVector2D(1., 0.)),
-			  m_shape(QPainterPath()), m_isHighlighted(false), m_edges(QSet<PlugEdge *>()), m_label(nullptr), m_connectedPlugs(QSet<Plug *>())
+			: QGraphicsObject(parent), m_name(parent->getScene()->getNameTable().intern(name)), m_direction(direction),
+			  m_node(parent), m_scene(parent->getScene()), m_arclength(0.1), m_normal(QVector2D(1., 0.)),
+			  m_shape(QPainterPath()), m_expansion(0.), m_expansionPos(QPointF()), m_isRinged(false), m_isHighlighted(false), m_edges(QSet<PlugEdge *>()), m_label(nullptr), m_connectedPlugs(QSet<Plug *>()),
+			  m_graphId(SlotId()), m_cacheId(ItemCache::createId())
 	{
 		// the perimeter needs to stack behind the node core
 		setFlag(ItemStacksBehindParent);
-		setCacheMode(DeviceCoordinateCache);
+
+		// the plug is cached in the budgeted ItemCache of the scene instead of Qt's unbounded item cache
+		setCacheMode(NoCache);
 
 		// the plug doesn't do anything with them, but needs to be enabled so they get send up to the node
 		setAcceptHoverEvents(true);
@@ -49,6 +58,11 @@ namespace zodiac
 		setHighlight(false);
 	}
 
+	Plug::~Plug()
+	{
+		m_scene->getItemCache().remove(m_cacheId);
+	}
+
 	void Plug::addEdge(PlugEdge *edge)
 	{
 		// make sure the edge actually connects to this plug
@@ -77,6 +91,7 @@ namespace zodiac
 		{
 			m_connectedPlugs.insert(startPlug);
 		}
+		m_node->invalidateArrangement();
 	}
 
 	void Plug::removeEdge(PlugEdge *edge)
@@ -104,6 +119,7 @@ namespace zodiac
 			Q_ASSERT(m_connectedPlugs.contains(endPlug));
 			m_connectedPlugs.remove(endPlug);
 		}
+		m_node->invalidateArrangement();
 	}
 
 	void Plug::defineShape(QVector2D normal, qreal arclength)
@@ -114,8 +130,20 @@ namespace zodiac
 		{
 			return;
 		}
+		// the connected plugs target this plug along its normal
+		if (!qFuzzyCompare(normal.x(), m_normal.x()) || !qFuzzyCompare(normal.y(), m_normal.y()))
+		{
+			for (Plug *connectedPlug: m_connectedPlugs)
+			{
+				connectedPlug->getNode()->invalidateArrangement();
+			}
+		}
 		m_normal = normal;
 		m_arclength = qAbs(arclength);
+		if (!m_graphId.isNull())
+		{
+			m_node->getScene()->getGraph().setPlugNormal(m_graphId, m_normal);
+		}
 		updateShape();
 	}
 
@@ -134,23 +162,67 @@ namespace zodiac
 
 		// update position
 		qreal targetDistance = m_node->getPerimeterRadius() - (m_direction == PlugDirection::IN ? s_width : 0.);
-		QPointF pos = (m_normal * expansion * targetDistance).toPointF();
-		setPos(pos);
+		m_expansion = expansion;
+		m_expansionPos = (m_normal * expansion * targetDistance).toPointF();
 
-		// update label tranparency
-		m_label->setOpacity(expansion);
+		// a ringed plug is drawn by the ring at its expansion position, only a highlighted one shows its label
+		if (!m_isRinged || m_isHighlighted)
+		{
+			moveToExpansion();
+		}
 
 		// update any connected edges
 		updateEdges();
 	}
 
+	QPointF Plug::getExpansionScenePos() const
+	{
+		return m_node->scenePos() + m_expansionPos;
+	}
+
 	void Plug::setHighlight(bool highlight)
 	{
 		m_isHighlighted = highlight;
 		m_label->setHighlight(highlight);
+
+		// the label of a ringed plug is only shown while it is highlighted
+		if (m_isRinged)
+		{
+			m_label->setVisible(highlight);
+			if (highlight)
+			{
+				moveToExpansion();
+			}
+		}
+		m_scene->getItemCache().invalidate(m_cacheId);
+		m_node->getPlugRing()->update(); // a ringed plug is painted by the ring
 		update();
 	}
 
+	QColor Plug::getColor() const
+	{
+		if (m_isHighlighted)
+		{
+			return s_highlightColor;
+		}
+		return m_direction == PlugDirection::IN ? s_inColor : s_outColor;
+	}
+
+	void Plug::setRinged(bool ringed)
+	{
+		m_isRinged = ringed;
+		setFlag(ItemHasNoContents, ringed);
+		setAcceptHoverEvents(!ringed);
+		setAcceptedMouseButtons(ringed ? Qt::NoButton : Qt::AllButtons);
+
+		// hide the labels behind the ring, a plug that draws itself again has to catch up with the expansion
+		m_label->setVisible(!ringed || m_isHighlighted);
+		if (!ringed)
+		{
+			moveToExpansion();
+		}
+	}
+
 	QVector2D Plug::getTargetNormal() const
 	{
 		// reset and return early, if there are no plugs to target
@@ -164,13 +236,23 @@ namespace zodiac
 		QVector2D thisPos(m_node->scenePos());
 		for (Plug *plug: m_connectedPlugs)
 		{
-			QVector2D otherPos(plug->scenePos());
+			QVector2D otherPos(plug->getExpansionScenePos());
 			otherPos += plug->m_normal * plug->getNode()->getPerimeterRadius();
 			averageDirection += (otherPos - thisPos).normalized();
 		}
 		return averageDirection.normalized();
 	}
 
+	int Plug::getConnectionCount() const
+	{
+		// edges to nodes without items only exist in the graph store
+		if (m_graphId.isNull())
+		{
+			return getEdgeCount();
+		}
+		return m_scene->getGraph().getPlugEdgeCount(m_graphId);
+	}
+
 	void Plug::aquireDrawEdge()
 	{
 #ifdef QT_DEBUG
@@ -203,7 +285,7 @@ namespace zodiac
 		// find the topmost node under the mouse cursor
 		Node *targetNode = nullptr;
 		QGraphicsItem *plugNode = parentItem(); // the parent item of this plug is always its node
-		for (QGraphicsItem *currentItem: scene()->items(scenePos))
+		for (QGraphicsItem *currentItem: m_node->getScene()->getItemsAt(scenePos))
 		{
 			QGraphicsItem *rootItem = getRootItemOf(currentItem);
 			if ((!rootItem) || (rootItem == plugNode))
@@ -345,29 +427,21 @@ namespace zodiac
 
 	void Plug::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /* widget */)
 	{
-		painter->setClipRect(option->exposedRect);
-
-		// define the pen to draw this plug
-		QBrush brush(Qt::SolidPattern);
-
-		if (m_isHighlighted)
+		// the plugs of nodes that are drawn as dots are not drawn at all
+		if (!View::isDetailed(Node::getCoreRadius(), painter))
 		{
-			brush.setColor(s_highlightColor);
-		} else
-		{
-			if (m_direction == PlugDirection::IN)
-			{
-				brush.setColor(s_inColor);
-			} else
-			{
-				brush.setColor(s_outColor);
-			}
+			return;
 		}
 
-		// draw the plug
-		painter->setPen(Qt::NoPen);
-		painter->setBrush(brush);
-		painter->drawPath(m_shape);
+		painter->setClipRect(option->exposedRect);
+
+		m_scene->getItemCache().draw(m_cacheId, painter, boundingRect(), [this](QPainter *cachePainter)
+		{
+			// draw the plug
+			cachePainter->setPen(Qt::NoPen);
+			cachePainter->setBrush(QBrush(getColor(), Qt::SolidPattern));
+			cachePainter->drawPath(m_shape);
+		});
 	}
 
 	QPainterPath Plug::shape() const
@@ -413,54 +487,58 @@ namespace zodiac
 		return QGraphicsItem::mouseReleaseEvent(event);
 	}
 
+	QString Plug::getName() const
+	{
+		return m_node->getScene()->getNameTable().getName(m_name);
+	}
+
 	void Plug::setName(const QString &name)
 	{
-		if (name == m_name)
+		NameAtom atom = m_node->getScene()->getNameTable().intern(name);
+		if (atom == m_name)
 		{
 			return;
 		}
-		m_name = name;
+		m_name = atom;
+		if (!m_graphId.isNull())
+		{
+			m_scene->getGraph().setPlugName(m_graphId, m_name);
+		}
 		updateEdgeLabels();
 		updateStyle();
-		emit plugRenamed(m_name);
+		emit plugRenamed(name);
 	}
 
 	void Plug::updateShape()
 	{
 		prepareGeometryChange();
+		m_scene->getItemCache().invalidate(m_cacheId);
 
 		// update the path traced by the plug
-		// the path is created in-place, meaning it does not need to be rotated
+		// all plugs of a node with the same direction share the same outline, rotated in-place by their normal,
+		// so the item itself does not need to be rotated
 		// as it turns out, rotating stuff (especially with labels attached that also rotate)
 		// is a MAYOR performance killer
 		qreal perimeterRadius = m_node->getPerimeterRadius() - (m_direction == PlugDirection::IN ? s_width : 0.);
-		qreal arclength = qRadiansToDegrees(m_arclength);
-		qreal arcpos = qRadiansToDegrees(atan2(-m_normal.y(), m_normal.x()));
-
-		QPointF rectOffset = QPointF(-m_normal.x() * perimeterRadius, -m_normal.y() * perimeterRadius);
-		QRectF outsideRect = quadrat(perimeterRadius + (s_width / 2.));
-		outsideRect.translate(rectOffset);
-		QRectF insideRect = quadrat(perimeterRadius - (s_width / 2.));
-		insideRect.translate(rectOffset);
-
-		QPainterPath path;
-		path.arcMoveTo(outsideRect, arcpos + (arclength / 2.));
-		path.arcTo(outsideRect, arcpos + (arclength / 2.), -arclength);
-		path.arcTo(insideRect, arcpos - (arclength / 2.), 0.);
-		path.arcTo(insideRect, arcpos - (arclength / 2.), arclength);
-		path.closeSubpath();
-		path = path.simplified();
-		m_shape.swap(path);
+		QTransform transform;
+		transform.rotateRadians(qAtan2(m_normal.y(), m_normal.x()));
+		m_shape = transform.map(m_node->getScene()->getPlugArcCache().getArc(perimeterRadius, m_arclength, s_width));
 
 		m_label->updateShape();
 	}
 
+	void Plug::moveToExpansion()
+	{
+		setPos(m_expansionPos);
+		m_label->setOpacity(m_expansion);
+	}
+
 	bool Plug::mayReceiveInput()
 	{
 		const NodeExpansion nodeState = m_node->getExpansionState();
 		if (m_direction == PlugDirection::IN)
 		{
-			return ((m_edges.count() == 0) && ((nodeState == NodeExpansion::IN) || (nodeState == NodeExpansion::BOTH)));
+			return ((getConnectionCount() == 0) && ((nodeState == NodeExpansion::IN) || (nodeState == NodeExpansion::BOTH)));
 		} else
 		{
 			return ((nodeState == NodeExpansion::OUT) || (nodeState == NodeExpansion::BOTH));
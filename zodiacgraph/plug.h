@@ -35,6 +35,8 @@
 #include <QSet>
 #include <QVector2D>
 #include <QtGlobal>
+#include "nametable.h"
+#include "slotmap.h"
 #include "utils.h"
 
 namespace zodiac
@@ -68,6 +70,11 @@ namespace zodiac
 		///
 		friend class Node;
 
+		///
+		/// \brief The PlugRing of a Node with many Plug%s hands the drawing of its Plug%s back and forth.
+		///
+		friend class PlugRing;
+
 	public: // methods
 
 		///
@@ -79,6 +86,13 @@ namespace zodiac
 		///
 		explicit Plug(Node *parent, const QString &name, PlugDirection direction);
 
+		///
+		/// \brief Destructor.
+		///
+		/// Releases the cached pixmap of this Plug.
+		///
+		~Plug();
+
 		///
 		/// \brief Adds a new PlugEdge to this Plug.
 		///
@@ -125,10 +139,30 @@ namespace zodiac
 		///
 		/// \brief Repositions the Plug based on the expansion / collapse animations of its Node.
 		///
+		/// A ringed Plug only updates its expansion position, the item itself is not moved (see PlugRing).
+		///
 		/// \param [in] expansion   New expansion factor [0 -> 1].
 		///
 		void updateExpansion(qreal expansion);
 
+		///
+		/// \brief The current position of this Plug relative to its Node, following the expansion of the Node.
+		///
+		/// Use this instead of pos(), which is not kept up to date for a ringed Plug.
+		///
+		/// \return Position in the coordinates of the Node.
+		///
+		inline QPointF getExpansionPos() const { return m_expansionPos; }
+
+		///
+		/// \brief The current position of this Plug in scene coordinates, following the expansion of the Node.
+		///
+		/// Use this instead of scenePos(), which is not kept up to date for a ringed Plug.
+		///
+		/// \return Position in scene coordinates.
+		///
+		QPointF getExpansionScenePos() const;
+
 		///
 		/// \brief Sets the highlight-state of the Plug.
 		///
@@ -136,6 +170,13 @@ namespace zodiac
 		///
 		void setHighlight(bool highlight);
 
+		///
+		/// \brief The color to fill this Plug with, depending on its direction and highlight-state.
+		///
+		/// \return Fill color of this Plug.
+		///
+		QColor getColor() const;
+
 		///
 		/// \brief The 2D normal vector of this Plug with regards to its Node.
 		///
@@ -143,12 +184,26 @@ namespace zodiac
 		///
 		inline QVector2D getNormal() const { return m_normal; }
 
+		///
+		/// \brief The angular size of this Plug on the Perimeter of its Node.
+		///
+		/// \return Arclength in radians.
+		///
+		inline qreal getArclength() const { return m_arclength; }
+
 		///
 		/// \brief The unique name of this Plug.
 		///
 		/// \return Name of this Plug.
 		///
-		inline QString getName() const { return m_name; }
+		QString getName() const;
+
+		///
+		/// \brief The unique name of this Plug as atom of the NameTable of its Scene.
+		///
+		/// \return Name atom of this Plug.
+		///
+		inline NameAtom getNameAtom() const { return m_name; }
 
 		///
 		/// \brief The Node containing and managing this Plug.
@@ -157,6 +212,22 @@ namespace zodiac
 		///
 		inline Node *getNode() const { return m_node; }
 
+		///
+		/// \brief Id of this Plug in the GraphStore of its Scene.
+		///
+		/// \return Id of this Plug in the GraphStore of its Scene, or a null SlotId if it is not registered.
+		///
+		inline const SlotId &getGraphId() const { return m_graphId; }
+
+		///
+		/// \brief Sets the id of this Plug in the GraphStore of its Scene.
+		///
+		/// Must only be called by the Scene.
+		///
+		/// \param [in] id  New id of this Plug.
+		///
+		inline void setGraphId(const SlotId &id) { m_graphId = id; }
+
 		///
 		/// \brief The direction of this Plug, either incoming or outgoing.
 		///
@@ -182,12 +253,21 @@ namespace zodiac
 		///
 		inline int getEdgeCount() const { return m_edges.size(); }
 
+		///
+		/// \brief The number of connections of this Plug in the GraphStore.
+		///
+		/// Unlike getEdgeCount(), this includes the connections to Node%s that currently have no items.
+		///
+		/// \return This Plug's connection count.
+		///
+		int getConnectionCount() const;
+
 		///
 		/// \brief Only Plug%s with no connections can be removed.
 		///
 		/// \return <i>true</i> if the Plug can be removed, <i>false</i> otherwise.
 		///
-		inline bool isRemovable() const { return getEdgeCount() == 0; }
+		inline bool isRemovable() const { return getConnectionCount() == 0; }
 
 		///
 		/// \brief Tests if a Plug is connected to another Plug via a direct PlugEdge.
@@ -436,6 +516,15 @@ namespace zodiac
 
 	private: // methods for friends
 
+		///
+		/// \brief Hands the drawing and hit-testing of this Plug to the PlugRing of its Node or takes it back.
+		///
+		/// Must only be called by zodiac::PlugRing::updateStyle().
+		///
+		/// \param [in] ringed  <i>true</i> if the Plug is drawn by the PlugRing -- <i>false</i> if it draws itself.
+		///
+		void setRinged(bool ringed);
+
 		///
 		/// \brief  Sets a new direction for this Plug.
 		///
@@ -445,7 +534,7 @@ namespace zodiac
 		///
 		inline void setDirection(PlugDirection direction)
 		{
-			Q_ASSERT(getEdgeCount() == 0);
+			Q_ASSERT(getConnectionCount() == 0);
 			m_direction = direction;
 		}
 
@@ -465,19 +554,25 @@ namespace zodiac
 		///
 		void updateShape();
 
+		///
+		/// \brief Moves the Plug item to its expansion position and fades its PlugLabel accordingly.
+		///
+		void moveToExpansion();
+
 		///
 		/// \brief Determines, if the Plug can currently react to mouse events or not.
 		///
-		/// \return <i>false</i> if the Plug is incoming and has a connection or the Node is not in the right state.
+		/// \return <i>false</i> if the Plug is incoming and has a connection (even one to a Node without items) or the
+		///         Node is not in the right state.
 		///
 		bool mayReceiveInput();
 
 	private: // members
 
 		///
-		/// \brief Name of this Plug.
+		/// \brief Name of this Plug, interned in the NameTable of its Scene.
 		///
-		QString m_name;
+		NameAtom m_name;
 
 		///
 		/// \brief Direction of this Plug.
@@ -489,6 +584,11 @@ namespace zodiac
 		///
 		Node *m_node;
 
+		///
+		/// \brief Scene containing the Node of this Plug, outlives the Plug.
+		///
+		Scene *m_scene;
+
 		///
 		/// \brief Angular size of the Plug in radians.
 		///
@@ -504,6 +604,21 @@ namespace zodiac
 		///
 		QPainterPath m_shape;
 
+		///
+		/// \brief Current expansion factor of this Plug [0 -> 1].
+		///
+		qreal m_expansion;
+
+		///
+		/// \brief Current position of this Plug relative to its Node.
+		///
+		QPointF m_expansionPos;
+
+		///
+		/// \brief <i>true</i> if the Plug is drawn by the PlugRing of its Node -- <i>false</i> if it draws itself.
+		///
+		bool m_isRinged;
+
 		///
 		/// \brief <i>true</i> if the Plug is currently highlighted -- <i>false</i> otherwise.
 		///
@@ -524,6 +639,16 @@ namespace zodiac
 		///
 		QSet<Plug *> m_connectedPlugs;
 
+		///
+		/// \brief Id of this Plug in the GraphStore of its Scene.
+		///
+		SlotId m_graphId;
+
+		///
+		/// \brief Key of this Plug in the ItemCache of its Scene.
+		///
+		quint64 m_cacheId;
+
 	private: // static members
 
 		///
@@ -0,0 +1,55 @@
+#include "plugarccache.h"
+
+#include <QtMath>
+
+#include "utils.h"
+
+namespace zodiac
+{
+
+	int PlugArcCache::s_maxArcCount = 1024;
+
+	PlugArcCache::PlugArcCache()
+			: m_arcs(QHash<Key, QPainterPath>())
+	{
+	}
+
+	QPainterPath PlugArcCache::getArc(qreal radius, qreal arclength, qreal width)
+	{
+		Key key{radius, arclength, width};
+		auto it = m_arcs.constFind(key);
+		if (it != m_arcs.constEnd())
+		{
+			return it.value();
+		}
+
+		if (m_arcs.size() >= s_maxArcCount)
+		{
+			m_arcs.clear();
+		}
+
+		// trace the arc around a center on the negative x-axis, so it is centered on the origin
+		qreal sweep = qRadiansToDegrees(arclength);
+		QRectF outsideRect = quadrat(radius + (width / 2.));
+		outsideRect.translate(-radius, 0.);
+		QRectF insideRect = quadrat(radius - (width / 2.));
+		insideRect.translate(-radius, 0.);
+
+		QPainterPath path;
+		path.arcMoveTo(outsideRect, sweep / 2.);
+		path.arcTo(outsideRect, sweep / 2., -sweep);
+		path.arcTo(insideRect, -sweep / 2., 0.);
+		path.arcTo(insideRect, -sweep / 2., sweep);
+		path.closeSubpath();
+		path = path.simplified();
+
+		m_arcs.insert(key, path);
+		return path;
+	}
+
+	void PlugArcCache::clear()
+	{
+		m_arcs.clear();
+	}
+
+} // namespace zodiac
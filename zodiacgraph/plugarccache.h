@@ -0,0 +1,167 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_PLUGARCCACHE_H
+#define ZODIAC_PLUGARCCACHE_H
+
+/// \file plugarccache.h
+///
+/// \brief Contains the definition of the zodiac::PlugArcCache class.
+///
+
+#include <QHash>
+#include <QPainterPath>
+#include <QtGlobal>
+
+namespace zodiac
+{
+
+///
+/// \brief Outlines of Plug%s shared by all Plug%s of a Scene.
+///
+/// All Plug%s of the same direction on a Node have the same radius and sweep, and only differ in their rotation.
+/// Therefore each distinct combination of radius, sweep and width is traced and simplified only once, pointing along
+/// the positive x-axis, and handed out as an implicitly shared QPainterPath that the Plug rotates into place.
+///
+/// Once the cache holds getMaxArcCount() arcs, it starts over.
+///
+	class Q_DECL_EXPORT PlugArcCache
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		PlugArcCache();
+
+		///
+		/// \brief Returns the outline of a Plug pointing along the positive x-axis, tracing it first if it is not cached yet.
+		///
+		/// The origin of the path is the center of the Plug on its arc, the center of the arc lies at (-radius, 0).
+		///
+		/// \param [in] radius      Radius of the center of the arc in pixels.
+		/// \param [in] arclength   Angular size of the arc in radians.
+		/// \param [in] width       Width of the arc in pixels.
+		///
+		/// \return                 Closed outline of the arc.
+		///
+		QPainterPath getArc(qreal radius, qreal arclength, qreal width);
+
+		///
+		/// \brief Discards all arcs.
+		///
+		void clear();
+
+		///
+		/// \brief The number of arcs currently in the cache.
+		///
+		/// \return Number of arcs.
+		///
+		inline int size() const { return m_arcs.size(); }
+
+	public: // static methods
+
+		///
+		/// \brief Maximum number of arcs in a cache before it starts over.
+		///
+		/// \return Maximum arc count.
+		///
+		static inline int getMaxArcCount() { return s_maxArcCount; }
+
+		///
+		/// \brief Sets the maximum number of arcs in a cache before it starts over.
+		///
+		/// \param [in] count   New maximum arc count, at least one.
+		///
+		static inline void setMaxArcCount(int count) { s_maxArcCount = qMax(1, count); }
+
+	private: // structs
+
+		///
+		/// \brief Everything that makes an arc unique.
+		///
+		struct Key
+		{
+			///
+			/// \brief Radius of the center of the arc.
+			///
+			qreal radius;
+
+			///
+			/// \brief Angular size of the arc.
+			///
+			qreal arclength;
+
+			///
+			/// \brief Width of the arc.
+			///
+			qreal width;
+
+			///
+			/// \brief Equality operator.
+			///
+			/// \param [in] other   Key to compare with.
+			///
+			/// \return             <i>true</i> if both keys describe the same arc -- <i>false</i> otherwise.
+			///
+			inline bool operator==(const Key &other) const
+			{
+				return (radius == other.radius) && (arclength == other.arclength) && (width == other.width);
+			}
+
+			///
+			/// \brief Hash function for QHash.
+			///
+			/// \param [in] key     Key to hash.
+			/// \param [in] seed    Seed of the QHash.
+			///
+			/// \return             Hash value.
+			///
+			friend inline uint qHash(const Key &key, uint seed = 0)
+			{
+				return ::qHash(key.radius, seed) ^ (::qHash(key.arclength) << 1) ^ (::qHash(key.width) << 2);
+			}
+		};
+
+	private: // members
+
+		///
+		/// \brief All arcs in the cache.
+		///
+		QHash<Key, QPainterPath> m_arcs;
+
+	private: // static members
+
+		///
+		/// \brief Maximum number of arcs in a cache.
+		///
+		static int s_maxArcCount;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_PLUGARCCACHE_H
@@ -1,13 +1,31 @@
 #include "plugarranger.h"
 
+#include <QtMath>       // for M_PI
+
 #include <cfloat>       // DBL_MAX
 
-int getProblemRows(QVector<int> &problemRows, const QVector<int> &guess, const int rowCount)
+// qreal is a double on all platforms with SSE2, unless Qt was configured with a different coordinate type
+#if !defined(QT_COORD_TYPE) && defined(__AVX__)
+#include <immintrin.h>
+#define ZODIAC_COST_AVX
+#elif !defined(QT_COORD_TYPE) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#include <emmintrin.h>
+#define ZODIAC_COST_SSE2
+#endif
+
+int getProblemRows(QVector<int> &problemRows, const QVector<int> &guess, const int rowCount, QVector<int> &columnUsage)
 {
+	// count the rows in each column once, instead of counting the column of every row separately
+	columnUsage.fill(0);
+	for (int row = 0; row < rowCount; ++row)
+	{
+		++columnUsage[guess[row]];
+	}
+
 	int count = 0;
 	for (int guessIndex = 0; guessIndex < rowCount; ++guessIndex)
 	{
-		if (guess.count(guess[guessIndex]) > 1)
+		if (columnUsage[guess[guessIndex]] > 1)
 		{
 			problemRows[count++] = guessIndex;
 		}
@@ -18,6 +36,62 @@ int getProblemRows(QVector<int> &problemRows, const QVector<int> &guess, const i
 namespace zodiac
 {
 
+	void fillCostTable(QVector<qreal> &costTable, const QVector<qreal> &plugDirections,
+	                   const QVector<qreal> &plugPriorities, const QVector<qreal> &zoneDirections)
+	{
+		static const qreal TWO_PI = M_PI * 2;
+
+		const int rowCount = plugDirections.size();
+		const int columnCount = zoneDirections.size();
+		costTable.resize(rowCount * columnCount);
+		qreal *cells = costTable.data();
+		const qreal *zones = zoneDirections.constData();
+
+		for (int row = 0; row < rowCount; ++row)
+		{
+			const qreal direction = plugDirections[row];
+			const qreal priority = plugPriorities[row];
+			qreal *rowCells = cells + (row * columnCount);
+			int column = 0;
+
+			// the angular distance is min(|a - b|, 2pi - |a - b|), the absolute value is taken by clearing the sign bit
+#if defined(ZODIAC_COST_AVX)
+			const __m256d signMask = _mm256_set1_pd(-0.);
+			const __m256d twoPi = _mm256_set1_pd(TWO_PI);
+			const __m256d directions = _mm256_set1_pd(direction);
+			const __m256d priorities = _mm256_set1_pd(priority);
+			for (; column + 4 <= columnCount; column += 4)
+			{
+				__m256d distance = _mm256_andnot_pd(signMask, _mm256_sub_pd(directions, _mm256_loadu_pd(zones + column)));
+				distance = _mm256_min_pd(distance, _mm256_sub_pd(twoPi, distance));
+				__m256d cost = _mm256_mul_pd(distance, priorities);
+				_mm256_storeu_pd(rowCells + column, _mm256_mul_pd(cost, cost));
+			}
+#elif defined(ZODIAC_COST_SSE2)
+			const __m128d signMask = _mm_set1_pd(-0.);
+			const __m128d twoPi = _mm_set1_pd(TWO_PI);
+			const __m128d directions = _mm_set1_pd(direction);
+			const __m128d priorities = _mm_set1_pd(priority);
+			for (; column + 2 <= columnCount; column += 2)
+			{
+				__m128d distance = _mm_andnot_pd(signMask, _mm_sub_pd(directions, _mm_loadu_pd(zones + column)));
+				distance = _mm_min_pd(distance, _mm_sub_pd(twoPi, distance));
+				__m128d cost = _mm_mul_pd(distance, priorities);
+				_mm_storeu_pd(rowCells + column, _mm_mul_pd(cost, cost));
+			}
+#endif
+
+			// remaining columns (or all of them, without SIMD)
+			for (; column < columnCount; ++column)
+			{
+				qreal distance = qAbs(direction - zones[column]);
+				distance = qMin(distance, TWO_PI - distance);
+				qreal cost = distance * priority;
+				rowCells[column] = cost * cost;
+			}
+		}
+	}
+
 	QVector<int> arrangePlugs(const QVector<qreal> &costTable, const int rowCount, const int columnCount)
 	{
 		//
@@ -40,7 +114,8 @@ namespace zodiac
 		//
 		// find rows that have the smallest cost in the same column
 		QVector<int> problemRows = QVector<int>(rowCount);
-		int problemRowCount = getProblemRows(problemRows, guess, rowCount);
+		QVector<int> columnUsage = QVector<int>(columnCount);
+		int problemRowCount = getProblemRows(problemRows, guess, rowCount, columnUsage);
 
 		//
 		// find the empty columns
@@ -48,7 +123,7 @@ namespace zodiac
 		int emptyColumnCount = 0;
 		for (int col = 0; col < columnCount; ++col)
 		{
-			if (!guess.contains(col))
+			if (columnUsage[col] == 0)
 			{
 				emptyColumns[emptyColumnCount++] = col;
 			}
@@ -101,7 +176,7 @@ namespace zodiac
 			}
 
 			// update the problemRows
-			problemRowCount = getProblemRows(problemRows, guess, rowCount);
+			problemRowCount = getProblemRows(problemRows, guess, rowCount, columnUsage);
 		}
 
 		//
@@ -126,5 +201,101 @@ namespace zodiac
 		return guess;
 	}
 
+	QVector<int> arrangePlugsOptimally(const QVector<qreal> &costTable, const int rowCount, const int columnCount)
+	{
+		Q_ASSERT(rowCount <= columnCount);
+
+		//
+		// the potentials and the matching use index 0 as a virtual column, the real rows and columns start at 1
+		QVector<qreal> rowPotential(rowCount + 1, 0.);
+		QVector<qreal> columnPotential(columnCount + 1, 0.);
+		QVector<int> columnRow(columnCount + 1, 0);      // row assigned to each column, 0 if the column is free
+		QVector<int> previousColumn(columnCount + 1, 0); // column preceding each column on the augmenting path
+		QVector<qreal> minSlack(columnCount + 1);
+		QVector<char> isVisited(columnCount + 1);
+		const qreal *costs = costTable.constData();
+
+		//
+		// add one row after the other and find the shortest augmenting path from it to a free column
+		for (int row = 1; row <= rowCount; ++row)
+		{
+			columnRow[0] = row;
+			int currentColumn = 0;
+			minSlack.fill(DBL_MAX);
+			isVisited.fill(false);
+			do
+			{
+				isVisited[currentColumn] = true;
+				int currentRow = columnRow[currentColumn];
+				const qreal *rowCosts = costs + (columnCount * (currentRow - 1));
+				qreal currentPotential = rowPotential[currentRow];
+				qreal delta = DBL_MAX;
+				int nextColumn = 0;
+				for (int col = 1; col <= columnCount; ++col)
+				{
+					if (isVisited[col])
+					{
+						continue;
+					}
+					qreal slack = rowCosts[col - 1] - currentPotential - columnPotential[col];
+					if (slack < minSlack[col])
+					{
+						minSlack[col] = slack;
+						previousColumn[col] = currentColumn;
+					}
+					if (minSlack[col] < delta)
+					{
+						delta = minSlack[col];
+						nextColumn = col;
+					}
+				}
+
+				// update the potentials, so the tree of visited columns stays tight
+				for (int col = 0; col <= columnCount; ++col)
+				{
+					if (isVisited[col])
+					{
+						rowPotential[columnRow[col]] += delta;
+						columnPotential[col] -= delta;
+					} else
+					{
+						minSlack[col] -= delta;
+					}
+				}
+				currentColumn = nextColumn;
+			} while (columnRow[currentColumn] != 0);
+
+			// flip the assignments along the augmenting path
+			do
+			{
+				int previous = previousColumn[currentColumn];
+				columnRow[currentColumn] = columnRow[previous];
+				currentColumn = previous;
+			} while (currentColumn != 0);
+		}
+
+		//
+		// read the column of every row from the matching
+		QVector<int> result(rowCount);
+		for (int col = 1; col <= columnCount; ++col)
+		{
+			if (columnRow[col] != 0)
+			{
+				result[columnRow[col] - 1] = col - 1;
+			}
+		}
+		return result;
+	}
+
+	qreal getPathCost(const QVector<qreal> &costTable, const int columnCount, const QVector<int> &path)
+	{
+		qreal cost = 0.;
+		for (int row = 0; row < path.size(); ++row)
+		{
+			cost += costTable[(columnCount * row) + path[row]];
+		}
+		return cost;
+	}
+
 
 } // namespace zodiac
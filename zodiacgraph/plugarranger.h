@@ -28,7 +28,8 @@
 
 /// \file plugarranger.h
 ///
-/// \brief Contains the definition of the zodiac::arrangePlugs function.
+/// \brief Contains the definition of the zodiac::arrangePlugs and zodiac::arrangePlugsOptimally functions and the
+/// zodiac::fillCostTable kernel building their input.
 ///
 #include <QtGlobal>
 #include <QVector>
@@ -37,7 +38,25 @@ namespace zodiac
 {
 
 ///
-/// \brief Calculates the cheapest path through the cost-table.
+/// \brief Builds the cost-table for the arrangement of the connected Plug%s of a Node.
+///
+/// The cost of placing a Plug in a zone is the square of the angular distance between the target direction of the Plug
+/// and the direction of the zone, weighted by the arrangement priority of the Plug.
+/// The inputs are passed as structure of arrays, so that each row of the table is computed in SIMD registers: with
+/// AVX, if the library is compiled with AVX enabled, with SSE2 on every other x86-64 build and with plain scalar code
+/// everywhere else.
+/// All three paths produce bit-identical results.
+///
+/// \param [out] costTable      Cost table, resized to (number of Plug%s) x (number of zones), row by row.
+/// \param [in] plugDirections  Target direction of each Plug in radians [-pi -> pi].
+/// \param [in] plugPriorities  Arrangement priority of each Plug.
+/// \param [in] zoneDirections  Direction of each zone in radians [-pi -> pi].
+///
+	Q_DECL_EXPORT void fillCostTable(QVector<qreal> &costTable, const QVector<qreal> &plugDirections,
+	                                 const QVector<qreal> &plugPriorities, const QVector<qreal> &zoneDirections);
+
+///
+/// \brief Calculates a cheap path through the cost-table with a greedy heuristic.
 ///
 /// For example:
 /// With the given table:
@@ -58,6 +77,9 @@ namespace zodiac
 /// |----|----|----|
 /// ~~~
 ///
+/// The path is not guaranteed to be the cheapest one and the heuristic is not faster than arrangePlugsOptimally() for
+/// large tables, see benchmarks/plugarrangerbenchmark.cpp.
+///
 /// \param [in] costTable   Reference to the cost table.
 /// \param [in] rowCount    Numer of rows in the cost table.
 /// \param [in] columnCount Numer of columns in the cost table.
@@ -66,6 +88,35 @@ namespace zodiac
 ///
 	Q_DECL_EXPORT QVector<int> arrangePlugs(const QVector<qreal> &costTable, const int rowCount, const int columnCount);
 
+///
+/// \brief Calculates the cheapest path through the cost-table.
+///
+/// Solves the same rectangular assignment problem as arrangePlugs(), but exactly, using the shortest augmenting path
+/// method of Jonker and Volgenant (a variant of the Hungarian algorithm) in O(rowCount^2 * columnCount).
+/// The cost table needs at least as many columns as it has rows.
+///
+/// \param [in] costTable   Reference to the cost table, row by row.
+/// \param [in] rowCount    Numer of rows in the cost table.
+/// \param [in] columnCount Numer of columns in the cost table.
+///
+/// \return Vector of column indices, ordered by row.
+///
+	Q_DECL_EXPORT QVector<int> arrangePlugsOptimally(const QVector<qreal> &costTable, const int rowCount,
+	                                                 const int columnCount);
+
+///
+/// \brief Sums up the cost of a path through the cost-table.
+///
+/// Can be used to compare the results of arrangePlugs() and arrangePlugsOptimally().
+///
+/// \param [in] costTable   Reference to the cost table.
+/// \param [in] columnCount Numer of columns in the cost table.
+/// \param [in] path        Vector of column indices, ordered by row.
+///
+/// \return Total cost of the path.
+///
+	Q_DECL_EXPORT qreal getPathCost(const QVector<qreal> &costTable, const int columnCount, const QVector<int> &path);
+
 } // namespace zodiac
 
 #endif // ZODIAC_PLUGARRANGER_H
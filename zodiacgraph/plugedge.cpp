@@ -13,7 +13,8 @@ namespace zodiac
 {
 
 	PlugEdge::PlugEdge(Scene *scene, Plug *startPlug, Plug *endPlug, EdgeGroup *edgeGroup)
-			: BezierEdge(scene), m_startPlug(startPlug), m_endPlug(endPlug), m_group(edgeGroup), m_isBent(false)
+			: BezierEdge(scene), m_startPlug(startPlug), m_endPlug(endPlug), m_group(edgeGroup), m_isBent(false),
+			  m_graphId(SlotId())
 	{
 		// register with the plugs
 		m_startPlug->addEdge(this);
@@ -45,9 +46,15 @@ namespace zodiac
 			}
 		}
 
+		// the shape is rebuilt once per frame by the scene
+		m_scene->markEdgeDirty(this);
+	}
+
+	void PlugEdge::refreshGeometry()
+	{
 		// return early, if the shape of the edge has not changed
-		QPointF startPoint = m_startPlug->scenePos();
-		QPointF endPoint = m_endPlug->scenePos();
+		QPointF startPoint = m_startPlug->getExpansionScenePos();
+		QPointF endPoint = m_endPlug->getExpansionScenePos();
 		if ((startPoint == m_startPoint) && (endPoint == m_endPoint))
 		{
 			return;
@@ -63,16 +70,21 @@ namespace zodiac
 		updateShape();
 	}
 
+	void PlugEdge::updateLabelText()
+	{
+		invalidateLabel();
+		m_group->updateLabelText();
+	}
+
 	QString PlugEdge::getLabelText()
 	{
 		return LabelTextFactory(this).produceLabel();
 	}
 
-	void PlugEdge::setLabelText(const QString &text)
+	void PlugEdge::updateLabel()
 	{
-		BezierEdge::setLabelText(text);
-
-		m_group->updateLabelText();
+		setLabelText(getLabelText());
+		placeArrowAt(.5);
 	}
 
 	void PlugEdge::mousePressEvent(QGraphicsSceneMouseEvent *event)
@@ -32,6 +32,7 @@
 ///
 
 #include "bezieredge.h"
+#include "slotmap.h"
 #include <QtGlobal>
 
 namespace zodiac
@@ -69,8 +70,18 @@ namespace zodiac
 		///
 		/// \brief Is called by a plug to notify the edge of a change in its state.
 		///
+		/// Updates the bent count of the EdgeGroup right away, but only marks the shape of the edge as dirty.
+		/// The shape is rebuilt at most once per frame in refreshGeometry().
+		///
 		void plugHasChanged();
 
+		///
+		/// \brief Rebuilds the shape of this PlugEdge from the current positions of its Plug%s.
+		///
+		/// Returns early, if neither Plug has moved since the last call.
+		///
+		void refreshGeometry() override;
+
 		///
 		/// \brief The start Plug of this PlugEdge is an \ref zodiac::PlugDirection::OUT "outgoing" Plug of a Node.
 		///
@@ -98,9 +109,35 @@ namespace zodiac
 		inline EdgeGroup *getGroup() const { return m_group; }
 
 		///
-		/// \brief Updates the EdgeLabel to reflect changes in the attached Plug%s and / or Node%s.
+		/// \brief Tests whether this PlugEdge is currently counted as "bent" by its EdgeGroup.
+		///
+		/// \return <i>true</i> if at least one of the Plug%s of this PlugEdge is expanded -- <i>false</i> otherwise.
+		///
+		inline bool isBent() const { return m_isBent; }
+
+		///
+		/// \brief Id of this PlugEdge in the GraphStore of its Scene.
+		///
+		/// \return Id of this PlugEdge in the GraphStore of its Scene, or a null SlotId if it is not registered.
+		///
+		inline const SlotId &getGraphId() const { return m_graphId; }
+
+		///
+		/// \brief Sets the id of this PlugEdge in the GraphStore of its Scene.
+		///
+		/// Must only be called by the Scene.
+		///
+		/// \param [in] id  New id of this PlugEdge.
+		///
+		inline void setGraphId(const SlotId &id) { m_graphId = id; }
+
+		///
+		/// \brief Marks the EdgeLabel%s of this edge and its EdgeGroup as outdated after changes in the attached Plug%s
+		/// and / or Node%s.
 		///
-		inline void updateLabelText() { setLabelText(getLabelText()); }
+		/// The texts are generated once the labels are about to be shown.
+		///
+		void updateLabelText();
 
 		///
 		/// \brief Generates the EdgeLabel's text by using information from the start and end Node of this PlugEdge.
@@ -110,13 +147,9 @@ namespace zodiac
 		QString getLabelText();
 
 		///
-		/// \brief Sets the text of this edge's EdgeLabel.
-		///
-		/// Extends the base functionality by also taking care of renaming the EdgeGroup%s.
-		///
-		/// \param [in] text    Text to set this label to. Remove an existing EdgeLabel by passing "" (the empty string).
+		/// \brief Generates and updates the text for this edge's EdgeLabel.
 		///
-		virtual void setLabelText(const QString &text);
+		void updateLabel() override;
 
 	protected: // methods
 
@@ -158,6 +191,11 @@ namespace zodiac
 		///
 		bool m_isBent;
 
+		///
+		/// \brief Id of this PlugEdge in the GraphStore of its Scene.
+		///
+		SlotId m_graphId;
+
 	};
 
 } // namespace zodiac
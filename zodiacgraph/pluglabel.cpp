@@ -4,7 +4,12 @@
 #include <QPainter>
 #include <QStyleOptionGraphicsItem>
 
+#include "itemcache.h"
+#include "node.h"
 #include "plug.h"
+#include "scene.h"
+#include "textlayoutcache.h"
+#include "view.h"
 
 namespace zodiac
 {
@@ -14,32 +19,36 @@ namespace zodiac
 	QColor PlugLabel::s_color = QColor("#828688");
 
 	PlugLabel::PlugLabel(Plug *parent)
-			: QGraphicsItem(parent), m_plug(parent), m_isHighlighted(false)
+			: QGraphicsItem(parent), m_plug(parent), m_scene(parent->getNode()->getScene()), m_isHighlighted(false), m_cacheId(ItemCache::createId())
 	{
 		// the label does not react to mouse events
 		setAcceptHoverEvents(false);
 
-		// cache the label
-		setCacheMode(DeviceCoordinateCache);
+		// the label is cached in the budgeted ItemCache of the scene instead of Qt's unbounded item cache
+		setCacheMode(NoCache);
 
 		// initialize
 		setOpacity(0.); // to avoid flicker, the label starts out fully transparent
 		updateShape();
 	}
 
+	PlugLabel::~PlugLabel()
+	{
+		m_scene->getItemCache().remove(m_cacheId);
+	}
+
 	void PlugLabel::updateShape()
 	{
 		prepareGeometryChange();
+		m_scene->getItemCache().invalidate(m_cacheId);
 
-		// update the text
-		m_text = QStaticText(m_plug->getName());
-		m_text.setTextFormat(Qt::PlainText);
-		m_text.prepare(QTransform(), s_font); // prepare once to get the dimensions of the text
+		// get the dimensions of the text, plug names repeat a lot so they are shaped only once per scene
+		TextLayoutCache &layoutCache = m_scene->getTextLayoutCache();
+		QSizeF textSize = layoutCache.getLayout(m_plug->getName(), s_font).size;
 
 		// update the label transformation
 		QVector2D normal = m_plug->getNormal();
 		qreal angle = atan2(-normal.y(), normal.x());
-		QSizeF textSize = m_text.size();
 		qreal xOffset;
 		if (normal.x() > 0)
 		{   // label is on the right
@@ -53,12 +62,19 @@ namespace zodiac
 		m_transform.rotateRadians(-angle);
 		m_transform.translate(xOffset, textSize.height() / -2.);
 
-		m_text.prepare(m_transform, s_font);    // prepare a second time with the correct transform matrix
+		m_text = layoutCache.getLayout(m_plug->getName(), s_font, -angle).text; // shaped for the rotation of the label
 
 		// update the bounding rect
 		m_boundingRect = m_transform.mapRect(QRectF(0, 0, textSize.width(), textSize.height()));
 	}
 
+	void PlugLabel::setHighlight(bool highlight)
+	{
+		m_isHighlighted = highlight;
+		m_scene->getItemCache().invalidate(m_cacheId);
+		update();
+	}
+
 	void PlugLabel::updateStyle()
 	{
 		updateShape();
@@ -72,11 +88,21 @@ namespace zodiac
 
 	void PlugLabel::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /*widget*/)
 	{
+		// skip labels that are too small to be read
+		if (!View::isReadable(s_font.pointSizeF(), painter))
+		{
+			return;
+		}
+
 		painter->setClipRect(option->exposedRect);
-		painter->setTransform(m_transform * painter->transform());
-		painter->setFont(s_font);
-		painter->setPen(QPen(m_isHighlighted ? Plug::getHighlightColor() : s_color));
-		painter->drawStaticText(0, 0, m_text);
+
+		m_scene->getItemCache().draw(m_cacheId, painter, m_boundingRect, [this](QPainter *cachePainter)
+		{
+			cachePainter->setTransform(m_transform * cachePainter->transform());
+			cachePainter->setFont(s_font);
+			cachePainter->setPen(QPen(m_isHighlighted ? Plug::getHighlightColor() : s_color));
+			cachePainter->drawStaticText(0, 0, m_text);
+		});
 	}
 
 	QPainterPath PlugLabel::shape() const
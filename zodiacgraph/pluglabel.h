@@ -41,6 +41,7 @@ namespace zodiac
 {
 
 	class Plug;
+	class Scene;
 
 ///
 /// \brief The label of a Plug.
@@ -60,6 +61,13 @@ namespace zodiac
 		///
 		explicit PlugLabel(Plug *parent);
 
+		///
+		/// \brief Destructor.
+		///
+		/// Releases the cached pixmap of this label.
+		///
+		~PlugLabel();
+
 		///
 		/// \brief Updates the Plug's label text and transformation using information from its Plug.
 		///
@@ -70,11 +78,7 @@ namespace zodiac
 		///
 		/// \param [in] highlight   <i>true</i> if the label is highlighted, <i>false</i> if it is not.
 		///
-		inline void setHighlight(bool highlight)
-		{
-			m_isHighlighted = highlight;
-			update();
-		}
+		void setHighlight(bool highlight);
 
 		///
 		/// \brief Applies style changes in the class' static members to this instance.
@@ -190,6 +194,11 @@ namespace zodiac
 		///
 		Plug *m_plug;
 
+		///
+		/// \brief Scene containing the Plug of this label, outlives the label.
+		///
+		Scene *m_scene;
+
 		///
 		/// \brief Text of this label.
 		///
@@ -210,6 +219,11 @@ namespace zodiac
 		///
 		bool m_isHighlighted;
 
+		///
+		/// \brief Key of this label in the ItemCache of its Scene.
+		///
+		quint64 m_cacheId;
+
 	private: // static members
 
 		///
@@ -0,0 +1,302 @@
+#include "plugring.h"
+
+#include <QGraphicsSceneHoverEvent>
+#include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QVector2D>
+#include <QtMath>
+
+#include <algorithm>                    // for std::lower_bound, std::sort
+
+#include "node.h"
+#include "plug.h"
+#include "utils.h"
+#include "view.h"
+
+namespace zodiac
+{
+
+	int PlugRing::s_minPlugCount = 24;
+
+	PlugRing::PlugRing(Node *parent)
+			: QGraphicsObject(parent), m_node(parent), m_isActive(false), m_boundingRect(QRectF()),
+			  m_shape(QPainterPath()), m_hoveredPlug(nullptr), m_pressedPlug(nullptr),
+			  m_sortedPlugs(QVector<Plug *>()), m_plugAngles(QVector<qreal>()), m_isDirectionTableDirty(true)
+	{
+		// the ring needs to stack behind the node core, but in front of the perimeter
+		setFlag(ItemStacksBehindParent);
+
+		// the plugs are only painted once per frame, caching them would only cost memory
+		setCacheMode(NoCache);
+
+		// needed to find the plug under the mouse cursor
+		setAcceptHoverEvents(true);
+
+		// only becomes visible as the node expands with enough plugs
+		setVisible(false);
+	}
+
+	void PlugRing::updatePlugs()
+	{
+		if (!m_isActive)
+		{
+			return;
+		}
+
+		// the ring is only visible while any of its plugs are
+		bool hasVisiblePlug = false;
+		for (Plug *plug: m_node->getPlugList())
+		{
+			if (plug->isVisible())
+			{
+				hasVisiblePlug = true;
+				break;
+			}
+		}
+		setVisible(hasVisiblePlug);
+		update();
+	}
+
+	void PlugRing::updateDirections()
+	{
+		m_isDirectionTableDirty = true;
+		updatePlugs();
+	}
+
+	void PlugRing::forgetPlug(Plug *plug)
+	{
+		// the plug must not remain in the table of directions
+		m_isDirectionTableDirty = true;
+		if (m_hoveredPlug == plug)
+		{
+			m_hoveredPlug = nullptr;
+		}
+		if (m_pressedPlug == plug)
+		{
+			m_pressedPlug = nullptr;
+		}
+	}
+
+	Plug *PlugRing::getPlugAt(const QPointF &pos) const
+	{
+		updateDirectionTable();
+		int plugCount = m_sortedPlugs.size();
+		if (plugCount == 0)
+		{
+			return nullptr;
+		}
+
+		// only the two plugs whose directions enclose the angle of the position can contain it
+		qreal angle = qAtan2(-pos.y(), pos.x());
+		int nextIndex = int(std::lower_bound(m_plugAngles.constBegin(), m_plugAngles.constEnd(), angle)
+		                    - m_plugAngles.constBegin()) % plugCount;
+		int previousIndex = (nextIndex + plugCount - 1) % plugCount;
+		if (isPlugAt(m_sortedPlugs.at(nextIndex), pos))
+		{
+			return m_sortedPlugs.at(nextIndex);
+		}
+		if (isPlugAt(m_sortedPlugs.at(previousIndex), pos))
+		{
+			return m_sortedPlugs.at(previousIndex);
+		}
+		return nullptr;
+	}
+
+	void PlugRing::updateStyle()
+	{
+		// plugs may have been added or removed since the last re-styling
+		m_isDirectionTableDirty = true;
+
+		// hand the drawing of the plugs back and forth
+		bool isActive = m_node->getPlugList().size() >= s_minPlugCount;
+		if (!isActive)
+		{
+			setHoveredPlug(nullptr);
+		}
+		m_isActive = isActive;
+		for (Plug *plug: m_node->getPlugList())
+		{
+			plug->setRinged(isActive);
+		}
+
+		// outgoing plugs reach out half a plug width beyond the perimeter, incoming plugs one and a half plug widths in
+		prepareGeometryChange();
+		qreal perimeterRadius = m_node->getPerimeterRadius();
+		qreal outerRadius = perimeterRadius + (Plug::getWidth() / 2.);
+		qreal innerRadius = qMax(0., perimeterRadius - (Plug::getWidth() * 1.5));
+		m_boundingRect = quadrat(outerRadius);
+		QPainterPath path;
+		path.addEllipse(quadrat(outerRadius));
+		path.addEllipse(quadrat(innerRadius));
+		m_shape.swap(path);
+
+		if (m_isActive)
+		{
+			updatePlugs();
+		} else
+		{
+			setVisible(false);
+		}
+	}
+
+	QRectF PlugRing::boundingRect() const
+	{
+		return m_boundingRect;
+	}
+
+	void PlugRing::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget * /* widget */)
+	{
+		// the plugs of nodes that are drawn as dots are not drawn at all
+		if (!View::isDetailed(Node::getCoreRadius(), painter))
+		{
+			return;
+		}
+
+		painter->setClipRect(option->exposedRect);
+		painter->setPen(Qt::NoPen);
+
+		// draw the outline of each visible plug at its current position, the plug items themselves are not moved
+		for (Plug *plug: m_node->getPlugList())
+		{
+			if (!plug->isVisible())
+			{
+				continue;
+			}
+			QPointF plugPos = plug->getExpansionPos();
+			painter->setBrush(plug->getColor());
+			painter->translate(plugPos);
+			painter->drawPath(plug->shape());
+			painter->translate(-plugPos);
+		}
+	}
+
+	QPainterPath PlugRing::shape() const
+	{
+		return m_shape;
+	}
+
+	void PlugRing::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+	{
+		// only highlight plugs that are not connected and incoming
+		Plug *plug = getPlugAt(event->pos());
+		if (plug && !plug->mayReceiveInput())
+		{
+			plug = nullptr;
+		}
+		setHoveredPlug(plug);
+		QGraphicsObject::hoverMoveEvent(event);
+	}
+
+	void PlugRing::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
+	{
+		setHoveredPlug(nullptr);
+		QGraphicsObject::hoverLeaveEvent(event);
+	}
+
+	void PlugRing::mousePressEvent(QGraphicsSceneMouseEvent *event)
+	{
+		// only react to the draw edge button and only if this is not a connected incoming plug
+		Plug *plug = getPlugAt(event->pos());
+		if (plug && (event->buttons() & Plug::getDrawEdgeButton()) && plug->mayReceiveInput())
+		{
+			m_pressedPlug = plug;
+			plug->aquireDrawEdge();
+			event->accept();
+			return;
+		}
+
+		// let the perimeter below handle clicks between the plugs
+		event->ignore();
+	}
+
+	void PlugRing::mouseMoveEvent(QGraphicsSceneMouseEvent *event)
+	{
+		if (m_pressedPlug)
+		{
+			m_pressedPlug->advanceDrawEdge(event->scenePos());
+		}
+		QGraphicsObject::mouseMoveEvent(event);
+	}
+
+	void PlugRing::mouseReleaseEvent(QGraphicsSceneMouseEvent *event)
+	{
+		if (m_pressedPlug)
+		{
+			m_pressedPlug->releaseDrawEdge();
+			m_pressedPlug = nullptr;
+		}
+		QGraphicsObject::mouseReleaseEvent(event);
+	}
+
+	void PlugRing::updateDirectionTable() const
+	{
+		if (!m_isDirectionTableDirty)
+		{
+			return;
+		}
+		m_isDirectionTableDirty = false;
+
+		// use the same angles as the arrangement of the node, which places a plug at (cos(angle), -sin(angle))
+		const QVector<Plug *> &plugs = m_node->getPlugList();
+		QVector<QPair<qreal, Plug *>> directions;
+		directions.reserve(plugs.size());
+		for (Plug *plug: plugs)
+		{
+			QVector2D normal = plug->getNormal();
+			directions.append(qMakePair(qAtan2(-normal.y(), normal.x()), plug));
+		}
+		std::sort(directions.begin(), directions.end(),
+		          [](const QPair<qreal, Plug *> &left, const QPair<qreal, Plug *> &right)
+		          {
+			          return left.first < right.first;
+		          });
+
+		m_sortedPlugs.resize(directions.size());
+		m_plugAngles.resize(directions.size());
+		for (int index = 0; index < directions.size(); ++index)
+		{
+			m_plugAngles[index] = directions.at(index).first;
+			m_sortedPlugs[index] = directions.at(index).second;
+		}
+	}
+
+	bool PlugRing::isPlugAt(const Plug *plug, const QPointF &pos) const
+	{
+		if (!plug->isVisible())
+		{
+			return false;
+		}
+
+		// the center of the arc moves outwards with the plug, as the node expands
+		QVector2D normal = plug->getNormal();
+		qreal radius = m_node->getPerimeterRadius() - (plug->getDirection() == PlugDirection::IN ? Plug::getWidth() : 0.);
+		QVector2D offset = QVector2D(pos - plug->getExpansionPos()) + (normal * radius);
+
+		// test the distance from the center of the arc first, the angle to the plug normal second
+		qreal distance = offset.length();
+		if (qAbs(distance - radius) > Plug::getWidth() / 2.)
+		{
+			return false;
+		}
+		return QVector2D::dotProduct(offset, normal) >= distance * qCos(plug->getArclength() / 2.);
+	}
+
+	void PlugRing::setHoveredPlug(Plug *plug)
+	{
+		if (plug == m_hoveredPlug)
+		{
+			return;
+		}
+		if (m_hoveredPlug)
+		{
+			m_hoveredPlug->setHighlight(false);
+		}
+		m_hoveredPlug = plug;
+		if (m_hoveredPlug)
+		{
+			m_hoveredPlug->setHighlight(true);
+		}
+	}
+
+} // namespace zodiac
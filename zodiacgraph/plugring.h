@@ -0,0 +1,275 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_PLUGRING_H
+#define ZODIAC_PLUGRING_H
+
+///
+/// \file plugring.h
+///
+/// \brief Contains the definition of the zodiac::PlugRing class.
+///
+
+#include <QGraphicsObject>
+#include <QPainterPath>
+#include <QtGlobal>
+#include <QVector>
+
+namespace zodiac
+{
+
+	class Node;
+
+	class Plug;
+
+///
+/// \brief Draws all Plug%s of a Node with many Plug%s in a single item.
+///
+/// Once a Node has getMinPlugCount() Plug%s or more, its Plug%s no longer paint themselves nor receive mouse events.
+/// Instead, the PlugRing paints the outlines of all Plug%s in one pass and finds the Plug under the mouse cursor by
+/// its angle in a table of Plug%s sorted by direction, before forwarding hover and mouse events to it.
+/// The Plug%s stay in the scene as parents of their PlugLabel%s, but are not moved while the Node expands or collapses.
+/// Their current positions are derived from the expansion of the Node instead (see Plug::getExpansionPos()), and only
+/// the label of the highlighted Plug is shown.
+///
+	class Q_DECL_EXPORT PlugRing : public QGraphicsObject
+	{
+	Q_OBJECT
+
+	public: // methods
+
+		///
+		/// \brief Constructor
+		///
+		/// \param [in] parent  Node whose Plug%s are drawn by this PlugRing.
+		///
+		explicit PlugRing(Node *parent);
+
+		///
+		/// \brief Checks if the Plug%s of the Node are currently drawn by this PlugRing.
+		///
+		/// \return <i>true</i> if the Plug%s are drawn by this PlugRing -- <i>false</i> if they draw themselves.
+		///
+		inline bool isActive() const { return m_isActive; }
+
+		///
+		/// \brief Schedules a redraw after the Plug%s of the Node have moved or were shown or hidden.
+		///
+		/// Is called once by the Node after it has updated all of its Plug%s, not by each Plug.
+		///
+		void updatePlugs();
+
+		///
+		/// \brief Rebuilds the table of Plug directions on the next lookup and schedules a redraw.
+		///
+		/// Is called by the Node after its Plug%s were arranged or changed their shape.
+		///
+		void updateDirections();
+
+		///
+		/// \brief Makes sure that the PlugRing does not reference a Plug that is about to be removed.
+		///
+		/// \param [in] plug    Plug to forget.
+		///
+		void forgetPlug(Plug *plug);
+
+		///
+		/// \brief Finds the visible Plug, whose outline contains a given position.
+		///
+		/// \param [in] pos Position in local coordinates.
+		///
+		/// \return         Plug at the given position or <i>nullptr</i>, if there is none.
+		///
+		Plug *getPlugAt(const QPointF &pos) const;
+
+		///
+		/// \brief Applies style changes in the class' static members to this instance.
+		///
+		/// Is part of the scene-wide cascade of %updateStyle()-calls after a re-styling of the ZodiacGraph.
+		/// Also decides whether the PlugRing draws the Plug%s of its Node.
+		///
+		void updateStyle();
+
+	public: // static methods
+
+		///
+		/// \brief The minimum number of Plug%s on a Node, to be drawn by a PlugRing.
+		///
+		/// \return Minimum number of Plug%s.
+		///
+		static inline int getMinPlugCount() { return s_minPlugCount; }
+
+		///
+		/// \brief Sets the minimum number of Plug%s on a Node, to be drawn by a PlugRing.
+		///
+		/// Call Scene::updateStyle() afterwards.
+		///
+		/// \param [in] count   New minimum number of Plug%s, at least one.
+		///
+		static inline void setMinPlugCount(int count) { s_minPlugCount = qMax(1, count); }
+
+	protected: // methods
+
+		///
+		/// \brief Rectangular outer bounds of the item, used for redraw testing.
+		///
+		/// \return Boundary rectangle of the item.
+		///
+		QRectF boundingRect() const;
+
+		///
+		/// \brief Paints this item.
+		///
+		/// \param [in] painter Painter used to paint the item.
+		/// \param [in] option  Provides style options for the item.
+		/// \param [in] widget  Optional widget that this item is painted on.
+		///
+		void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+		///
+		/// \brief Exact boundary of the item used for collision detection among other things.
+		///
+		/// \return Shape in local coordinates.
+		///
+		QPainterPath shape() const;
+
+		///
+		/// \brief Called when the mouse moves while hovering the shape of the item.
+		///
+		/// \param [in] event   Qt event object
+		///
+		void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+
+		///
+		/// \brief Called when the mouse leaves the item after hovering over it.
+		///
+		/// \param [in] event   Qt event object
+		///
+		void hoverLeaveEvent(QGraphicsSceneHoverEvent *event);
+
+		///
+		/// \brief Is called, when the mouse is pressed while the cursor is on this item.
+		///
+		/// \param [in] event   Qt event object.
+		///
+		void mousePressEvent(QGraphicsSceneMouseEvent *event);
+
+		///
+		/// \brief Called, when the mouse is moved after clicking on the item.
+		///
+		/// \param [in] event   Qt event object.
+		///
+		void mouseMoveEvent(QGraphicsSceneMouseEvent *event);
+
+		///
+		/// \brief Called if the mouse is released after a click on this item.
+		///
+		/// \param [in] event   Qt event object.
+		///
+		void mouseReleaseEvent(QGraphicsSceneMouseEvent *event);
+
+	private: // methods
+
+		///
+		/// \brief Sorts all Plug%s of the Node by the angle of their normal, if the table is out of date.
+		///
+		void updateDirectionTable() const;
+
+		///
+		/// \brief Tests whether a position lies within the outline of a Plug.
+		///
+		/// \param [in] plug    Plug to test.
+		/// \param [in] pos     Position in local coordinates.
+		///
+		/// \return             <i>true</i> if the Plug is visible and contains the position -- <i>false</i> otherwise.
+		///
+		bool isPlugAt(const Plug *plug, const QPointF &pos) const;
+
+		///
+		/// \brief Moves the highlight to another Plug under the mouse cursor.
+		///
+		/// \param [in] plug    Plug under the mouse cursor, can be <i>nullptr</i>.
+		///
+		void setHoveredPlug(Plug *plug);
+
+	private: // members
+
+		///
+		/// \brief Node owning this PlugRing.
+		///
+		Node *m_node;
+
+		///
+		/// \brief Is true, if the Plug%s of the Node are drawn by this PlugRing.
+		///
+		bool m_isActive;
+
+		///
+		/// \brief Boundary rectangle of all Plug%s when fully expanded.
+		///
+		QRectF m_boundingRect;
+
+		///
+		/// \brief Band around the Perimeter, in which the Plug%s of the Node are placed.
+		///
+		QPainterPath m_shape;
+
+		///
+		/// \brief Plug highlighted, because it is under the mouse cursor.
+		///
+		Plug *m_hoveredPlug;
+
+		///
+		/// \brief Plug drawing a new PlugEdge after it was pressed.
+		///
+		Plug *m_pressedPlug;
+
+		///
+		/// \brief All Plug%s of the Node, sorted by the angle of their normal.
+		///
+		mutable QVector<Plug *> m_sortedPlugs;
+
+		///
+		/// \brief Angle of the normal of each Plug in m_sortedPlugs in radians [-pi -> pi], in ascending order.
+		///
+		mutable QVector<qreal> m_plugAngles;
+
+		///
+		/// \brief Is true, if the Plug%s were arranged, added or removed since the table of directions was built.
+		///
+		mutable bool m_isDirectionTableDirty;
+
+	private: // static members
+
+		///
+		/// \brief Minimum number of Plug%s on a Node, to be drawn by a PlugRing.
+		///
+		static int s_minPlugCount;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_PLUGRING_H
@@ -1,31 +1,144 @@
 #include "scene.h"
 
+#include <QPainterPath>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <algorithm>
 #include <time.h>
 
+#include "baseedge.h"
+#include "clusterlayer.h"
 #include "drawedge.h"
 #include "edgegroup.h"
 #include "edgegrouppair.h"
 #include "node.h"
+#include "perimeter.h"
 #include "plug.h"
 #include "plugedge.h"
+#include "straightedge.h"
+#include "straightedgelayer.h"
+#include "viewportlayer.h"
+
+template<typename Hit>
+static void collectItems(QGraphicsItem *item, Hit hit, QList<QGraphicsItem *> &result);
+
+template<typename T>
+static void setView(QVector<T *> &views, const zodiac::SlotId &id, T *item);
 
 namespace zodiac
 {
 
+///
+/// \brief Solves every n-th Node::Arrangement of a list on a worker thread.
+///
+	class ArrangementJob : public QRunnable
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] arrangements       Arrangements to solve, outlive the job.
+		/// \param [in] arrangementCount   Number of Arrangement%s.
+		/// \param [in] first          Index of the first Arrangement to solve.
+		/// \param [in] stride         Distance between two Arrangement%s solved by this job.
+		/// \param [in] done           Semaphore released once, when the job has finished.
+		///
+		ArrangementJob(Node::Arrangement *arrangements, int arrangementCount, int first, int stride, QSemaphore *done)
+				: QRunnable(), m_arrangements(arrangements), m_arrangementCount(arrangementCount), m_first(first),
+				  m_stride(stride), m_done(done)
+		{
+		}
+
+		///
+		/// \brief Solves the Arrangement%s of this job.
+		///
+		/// Each job writes only to its own Arrangement%s, so no locking is required.
+		///
+		void run() override
+		{
+			for (int index = m_first; index < m_arrangementCount; index += m_stride)
+			{
+				Node::solveArrangement(m_arrangements[index]);
+			}
+			m_done->release();
+		}
+
+	private: // members
+
+		///
+		/// \brief Arrangements to solve.
+		///
+		Node::Arrangement *m_arrangements;
+
+		///
+		/// \brief Number of Arrangement%s.
+		///
+		int m_arrangementCount;
+
+		///
+		/// \brief Index of the first Arrangement to solve.
+		///
+		int m_first;
+
+		///
+		/// \brief Distance between two Arrangement%s solved by this job.
+		///
+		int m_stride;
+
+		///
+		/// \brief Semaphore to release, when the job has finished.
+		///
+		QSemaphore *m_done;
+	};
+
 	Scene::Scene(QObject *parent)
-			: QGraphicsScene(parent), m_drawEdge(nullptr), m_nodes(QSet<Node *>()), m_edges(QHash<QPair<Plug *, Plug *>, PlugEdge *>()),
-			  m_edgeGroups(QHash<uint, EdgeGroup *>()), m_edgeGroupPairs(QSet<EdgeGroupPair *>())
+			: QGraphicsScene(parent), m_drawEdge(nullptr), m_clusterLayer(nullptr), m_viewportLayer(nullptr),
+			  m_straightEdgeLayer(nullptr), m_detachCounts(FlatHashMap<QGraphicsItem *, int>()),
+			  m_edges(FlatHashMap<QPair<Plug *, Plug *>, PlugEdge *>()),
+			  m_edgeGroups(FlatHashMap<QPair<Node *, Node *>, EdgeGroup *>()), m_edgeGroupPairs(QSet<EdgeGroupPair *>()),
+			  m_batchDepth(0), m_indexMethodBeforeBatch(BspTreeIndex), m_deferredNodes(QSet<Node *>()),
+			  m_dirtyEdges(QSet<BaseEdge *>()), m_dragAnchor(nullptr), m_dragStartPos(QPointF()),
+			  m_rigidEdges(QSet<BaseEdge *>()), m_boundaryEdges(QSet<BaseEdge *>()), m_spatialIndex(SpatialIndex()),
+			  m_spriteAtlas(SpriteAtlas()), m_itemCache(ItemCache()), m_textLayoutCache(TextLayoutCache()),
+			  m_plugArcCache(PlugArcCache()),
+			  m_nameTable(NameTable()), m_isSpatialIndexEnabled(false), m_dirtyIndexItems(QSet<QGraphicsItem *>()),
+			  m_movedNodes(QSet<Node *>()), m_selectedNodes(QVector<Node *>()),
+			  m_selectionPositions(FlatHashMap<Node *, int>()), m_selectionHoleCount(0),
+			  m_graph(GraphStore()), m_nodeViews(QVector<Node *>()), m_plugViews(QVector<Plug *>()), m_edgeViews(QVector<PlugEdge *>())
 	{
 		// add the draw edge to the scene
 		m_drawEdge = new DrawEdge(this);
 		m_drawEdge->setVisible(false);
+
+		m_clusterLayer = new ClusterLayer(this);
+		m_viewportLayer = new ViewportLayer(this);
+		m_straightEdgeLayer = new StraightEdgeLayer(this);
+		updateSpatialIndexCellSize();
 	}
 
 	Scene::~Scene()
 	{
+		// detached items are not part of the scene and would not be deleted with it
+		m_clusterLayer->expand();
+		m_viewportLayer->setEnabled(false);
+		m_straightEdgeLayer->setBatching(false);
+		m_detachCounts.clear();
+		m_isSpatialIndexEnabled = false;
+		m_spatialIndex.clear();
+		m_dirtyIndexItems.clear();
+		m_movedNodes.clear();
+
 		// most members are implicitly removed through Qt's parent-child mechanism
 		m_drawEdge = nullptr;
-		m_nodes.clear();
+		m_dirtyEdges.clear();
+		m_dragAnchor = nullptr;
+		m_rigidEdges.clear();
+		m_boundaryEdges.clear();
+		m_selectedNodes.clear();
+		m_selectionPositions.clear();
 		m_edges.clear();
 
 		// EdgeGroups belong to EdgeGroupPairs, which we need to delete manually
@@ -35,22 +148,49 @@ namespace zodiac
 			delete edgeGroupPair;
 		}
 		m_edgeGroupPairs.clear();
+
+		// the layer is not part of the scene anymore, so it is not deleted with it
+		delete m_straightEdgeLayer;
+		m_straightEdgeLayer = nullptr;
+
+		// make sure the items don't try to update the graph store anymore
+		for (Node *node: getNodes())
+		{
+			node->setGraphId(SlotId());
+		}
+
+		// delete the items while the caches they release their pixmaps to still exist
+		clear();
+		m_nodeViews.clear();
+		m_plugViews.clear();
+		m_edgeViews.clear();
+		m_graph.clear();
 	}
 
 	Node *Scene::createNode(const QString &name, const QUuid &uuid)
 	{
+		m_clusterLayer->invalidate();
 		Node *newNode = new Node(this, name, uuid);
-		m_nodes.insert(newNode);
+
+		// register the node with the graph store
+		newNode->setGraphId(m_graph.addNode(newNode->pos(), newNode->getPerimeterRadius()));
+		m_graph.setNodeName(newNode->getGraphId(), newNode->getDisplayName());
+		m_graph.setNodeUuid(newNode->getGraphId(), newNode->getUniqueId());
+		setView(m_nodeViews, newNode->getGraphId(), newNode);
+
 		addItem(newNode);
+		m_viewportLayer->registerNode(newNode);
+		m_viewportLayer->scheduleUpdate();
 		return newNode;
 	}
 
 	bool Scene::removeNode(Node *node)
 	{
+		bool isValid = getNode(node->getGraphId()) == node;
 #ifdef QT_DEBUG
-		Q_ASSERT(m_nodes.contains(node));
+		Q_ASSERT(isValid);
 #else
-		if (!m_nodes.contains(node))
+		if (!isValid)
 		{
 			return false;
 		}
@@ -63,8 +203,17 @@ namespace zodiac
 		}
 
 		// delete all references to the node and finally the node itself
-		m_nodes.remove(node);
-		removeItem(node);
+		m_clusterLayer->invalidate();
+		m_clusterLayer->setNodeCluster(node, QString());
+		forgetNode(node);
+		for (Plug *plug: node->getPlugs())
+		{
+			unregisterPlug(plug);
+		}
+		m_graph.removeNode(node->getGraphId());
+		setView<Node>(m_nodeViews, node->getGraphId(), nullptr);
+		node->setGraphId(SlotId());
+		takeItem(node);
 		node->deleteLater();
 
 		return true;
@@ -92,19 +241,30 @@ namespace zodiac
 			return nullptr;
 		}
 
-		// make sure that the incoming edge has no connections yet
-		if (toPlug->getEdgeCount() != 0)
+		// make sure that the incoming edge has no connections yet, not even to a node without items
+		if (toPlug->getConnectionCount() != 0)
 		{
 			return nullptr;
 		}
 
+		m_clusterLayer->invalidate();
+		PlugEdge *newEdge = createEdgeItem(fromPlug, toPlug, m_graph.addEdge(fromPlug->getGraphId(), toPlug->getGraphId()));
+
+		// emit signals
+		emit fromNode->outputConnected(fromPlug, toPlug);
+		emit toNode->inputConnected(toPlug, fromPlug);
+
+		return newEdge;
+	}
+
+	PlugEdge *Scene::createEdgeItem(Plug *fromPlug, Plug *toPlug, const SlotId &graphId)
+	{
 		// find the edge group for this edge, if it exists
-		uint edgeGroupHash = EdgeGroup::getHashOf(fromNode, toNode);
-		EdgeGroup *edgeGroup;
-		if (m_edgeGroups.contains(edgeGroupHash))
-		{
-			edgeGroup = m_edgeGroups[edgeGroupHash];
-		} else
+		Node *fromNode = fromPlug->getNode();
+		Node *toNode = toPlug->getNode();
+		QPair<Node *, Node *> edgeGroupKey = EdgeGroup::getKeyOf(fromNode, toNode);
+		EdgeGroup *edgeGroup = m_edgeGroups.value(edgeGroupKey, nullptr);
+		if (!edgeGroup)
 		{
 
 			// ... or create a new edge group pair for it
@@ -112,19 +272,17 @@ namespace zodiac
 			m_edgeGroupPairs.insert(newGroupPair);
 
 			edgeGroup = newGroupPair->getFirstGroup();
-			m_edgeGroups.insert(edgeGroupHash, edgeGroup);
+			m_edgeGroups.insert(edgeGroupKey, edgeGroup);
 
 			EdgeGroup *oppositeEdgeGroup = newGroupPair->getSecondGroup();
-			m_edgeGroups.insert(oppositeEdgeGroup->getHash(), oppositeEdgeGroup);
+			m_edgeGroups.insert(oppositeEdgeGroup->getKey(), oppositeEdgeGroup);
 		}
 
 		// create the new edge
 		PlugEdge *newEdge = new PlugEdge(this, fromPlug, toPlug, edgeGroup);
 		m_edges.insert(QPair<Plug *, Plug *>(fromPlug, toPlug), newEdge);
-
-		// emit signals
-		emit fromNode->outputConnected(fromPlug, toPlug);
-		emit toNode->inputConnected(toPlug, fromPlug);
+		newEdge->setGraphId(graphId);
+		setView(m_edgeViews, graphId, newEdge);
 
 		return newEdge;
 	}
@@ -143,12 +301,9 @@ namespace zodiac
 		}
 #endif
 
-		// unregister from the connected plugs
-		fromPlug->removeEdge(edge);
-		toPlug->removeEdge(edge);
-
-		// remove the edge from the Scene's register
-		m_edges.remove(edgeKey);
+		// unregister from the plugs, the scene and the graph store
+		m_clusterLayer->invalidate();
+		unregisterEdge(edge, true);
 
 		// remove the edge from its group
 		EdgeGroup *edgeGroup = edge->getGroup();
@@ -158,19 +313,12 @@ namespace zodiac
 		EdgeGroupPair *edgeGroupPair = edgeGroup->getEdgeGroupPair();
 		if (edgeGroupPair->isEmpty())
 		{
-			uint firstHash = edgeGroupPair->getFirstGroup()->getHash();
-			uint secondHash = edgeGroupPair->getSecondGroup()->getHash();
-			Q_ASSERT(m_edgeGroups.contains(firstHash));
-			Q_ASSERT(m_edgeGroups.contains(secondHash));
-			m_edgeGroups.remove(firstHash);
-			m_edgeGroups.remove(secondHash);
-			m_edgeGroupPairs.remove(edgeGroupPair);
-			delete edgeGroupPair; // also deletes the EdgeGroups
+			deleteEdgeGroupPair(edgeGroupPair);
 			edgeGroupPair = nullptr;
 		}
 
 		// lastly, remove the QGraphicsItem from the scene, thereby taking possession of the last pointer to the edge
-		removeItem(edge);
+		takeItem(edge);
 
 		// delete the edge from memory (automatically deletes all Qt-children as well)
 		edge->deleteLater();
@@ -180,23 +328,448 @@ namespace zodiac
 		emit toPlug->getNode()->inputDisconnected(toPlug, fromPlug);
 	}
 
+	void Scene::removeEdges(const QList<PlugEdge *> &edges)
+	{
+		// take every edge exactly once, even if it is given twice
+		QSet<PlugEdge *> visitedEdges;
+		QList<PlugEdge *> uniqueEdges;
+		uniqueEdges.reserve(edges.size());
+		for (PlugEdge *edge: edges)
+		{
+			if (!visitedEdges.contains(edge))
+			{
+				visitedEdges.insert(edge);
+				uniqueEdges.append(edge);
+			}
+		}
+
+		beginBatch();
+		QList<QPair<Plug *, Plug *> > connections = takeEdges(uniqueEdges, true);
+		endBatch();
+
+		if (!connections.isEmpty())
+		{
+			emit elementsRemoved(connections, QList<QUuid>());
+		}
+	}
+
+	void Scene::removeNodes(const QList<Node *> &nodes)
+	{
+		beginBatch();
+
+		// collect every node and every connected edge exactly once, even if a node is given twice
+		QSet<Node *> visitedNodes;
+		QList<Node *> uniqueNodes;
+		uniqueNodes.reserve(nodes.size());
+		QSet<PlugEdge *> edges;
+		QList<SlotId> graphEdges;
+		for (Node *node: nodes)
+		{
+			if (visitedNodes.contains(node))
+			{
+				continue;
+			}
+			visitedNodes.insert(node);
+			bool isValid = getNode(node->getGraphId()) == node;
+#ifdef QT_DEBUG
+			Q_ASSERT(isValid);
+#else
+			if (!isValid)
+			{
+				continue;
+			}
+#endif
+			uniqueNodes.append(node);
+			for (const SlotId &plugId: m_graph.getNodePlugs(node->getGraphId()))
+			{
+				for (const SlotId &edgeId: m_graph.getPlugEdges(plugId))
+				{
+					PlugEdge *edge = getEdge(edgeId);
+					if (edge)
+					{
+						edges.insert(edge);
+					} else
+					{
+						graphEdges.append(edgeId);
+					}
+				}
+			}
+		}
+		QList<QPair<Plug *, Plug *> > connections = takeEdges(edges.values(), true);
+
+		// connections to nodes without items have no PlugEdge and are only removed from the graph store
+		for (const SlotId &edgeId: graphEdges)
+		{
+			m_graph.removeEdge(edgeId);
+		}
+
+		// without edges, all nodes are removable
+		QList<QUuid> removedNodes;
+		removedNodes.reserve(uniqueNodes.size());
+		for (Node *node: uniqueNodes)
+		{
+			QUuid nodeId = node->getUniqueId();
+			if (removeNode(node))
+			{
+				removedNodes.append(nodeId);
+			}
+		}
+
+		endBatch();
+
+		if (!connections.isEmpty() || !removedNodes.isEmpty())
+		{
+			emit elementsRemoved(connections, removedNodes);
+		}
+	}
+
 	PlugEdge *Scene::getEdge(Plug *fromPlug, Plug *toPlug)
 	{
 		QPair<Plug *, Plug *> edgeKey(fromPlug, toPlug);
 		return m_edges.value(edgeKey, nullptr);
 	}
 
+	QList<Node *> Scene::getNodes() const
+	{
+		QList<Node *> result;
+		int nodeCount = m_graph.getNodeCount();
+		result.reserve(nodeCount);
+		for (int position = 0; position < nodeCount; ++position)
+		{
+			Node *node = m_nodeViews.value(int(m_graph.getNodeIdAt(position).index), nullptr);
+			if (node)
+			{
+				result.append(node);
+			}
+		}
+		return result;
+	}
+
+	SlotId Scene::addGraphNode(const QString &name, const QPointF &pos, const QUuid &uuid)
+	{
+		// until the node is realized, its radius is that of a node without plugs
+		m_clusterLayer->invalidate();
+		SlotId id = m_graph.addNode(pos, qMax(Perimeter::getMinRadius(), Node::getCoreRadius()));
+		m_graph.setNodeName(id, name);
+		m_graph.setNodeUuid(id, uuid.isNull() ? QUuid::createUuid() : uuid);
+		m_viewportLayer->scheduleUpdate();
+		return id;
+	}
+
+	SlotId Scene::addGraphPlug(const SlotId &node, const QString &name, PlugDirection direction)
+	{
+		bool isValid = m_graph.containsNode(node) && (direction != PlugDirection::BOTH);
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return SlotId();
+		}
+#endif
+
+		// realized nodes create the plug item along with it
+		Node *nodeItem = getNode(node);
+		if (nodeItem)
+		{
+			return nodeItem->createPlug(name, direction)->getGraphId();
+		}
+
+		m_clusterLayer->invalidate();
+		SlotId id = m_graph.addPlug(node, direction);
+		m_graph.setPlugName(id, m_nameTable.intern(getUniquePlugName(node, name)));
+		return id;
+	}
+
+	SlotId Scene::addGraphEdge(const SlotId &fromPlug, const SlotId &toPlug)
+	{
+		bool isValid = m_graph.containsPlug(fromPlug) && m_graph.containsPlug(toPlug);
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return SlotId();
+		}
+#endif
+
+		// edges between realized nodes get their item right away
+		Plug *fromItem = getPlug(fromPlug);
+		Plug *toItem = getPlug(toPlug);
+		if (fromItem && toItem)
+		{
+			PlugEdge *edge = createEdge(fromItem, toItem);
+			return edge ? edge->getGraphId() : SlotId();
+		}
+
+		// apply the same rules as createEdge(), a second edge to the incoming plug would also be a duplicate
+		if ((m_graph.getPlugNode(fromPlug) == m_graph.getPlugNode(toPlug))
+		    || (m_graph.getPlugDirection(fromPlug) != PlugDirection::OUT)
+		    || (m_graph.getPlugDirection(toPlug) != PlugDirection::IN) || (m_graph.getPlugEdgeCount(toPlug) != 0))
+		{
+			return SlotId();
+		}
+
+		m_clusterLayer->invalidate();
+		return m_graph.addEdge(fromPlug, toPlug);
+	}
+
+	Node *Scene::realizeNode(const SlotId &id)
+	{
+		bool isValid = m_graph.containsNode(id);
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return nullptr;
+		}
+#endif
+		Node *node = getNode(id);
+		if (node)
+		{
+			return node;
+		}
+
+		m_clusterLayer->invalidate();
+		beginBatch();
+
+		// the node is positioned before it is bound to the graph store, so it does not write its position back
+		node = new Node(this, m_graph.getNodeName(id), m_graph.getNodeUuid(id));
+		node->setPos(m_graph.getNodePos(id));
+		node->setGraphId(id);
+		setView(m_nodeViews, id, node);
+		addItem(node);
+
+		// create the plugs for the existing plugs in the graph store
+		QVector<SlotId> plugIds = m_graph.getNodePlugs(id);
+		for (const SlotId &plugId: plugIds)
+		{
+			node->createPlug(m_nameTable.getName(m_graph.getPlugName(plugId)), m_graph.getPlugDirection(plugId), plugId);
+		}
+
+		// create the edges to all other realized nodes
+		for (const SlotId &plugId: plugIds)
+		{
+			for (const SlotId &edgeId: m_graph.getPlugEdges(plugId))
+			{
+				Plug *fromPlug = getPlug(m_graph.getEdgeFrom(edgeId));
+				Plug *toPlug = getPlug(m_graph.getEdgeTo(edgeId));
+				if (fromPlug && toPlug)
+				{
+					createEdgeItem(fromPlug, toPlug, edgeId);
+				}
+			}
+		}
+
+		endBatch();
+		m_viewportLayer->registerNode(node);
+		m_viewportLayer->scheduleUpdate();
+		return node;
+	}
+
+	bool Scene::releaseNode(Node *node)
+	{
+		bool isValid = getNode(node->getGraphId()) == node;
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return false;
+		}
+#endif
+
+		m_clusterLayer->invalidate();
+		beginBatch();
+
+		// delete the edge items, the connections stay in the graph store
+		QVector<SlotId> plugIds = m_graph.getNodePlugs(node->getGraphId());
+		QList<PlugEdge *> edges;
+		for (const SlotId &plugId: plugIds)
+		{
+			for (const SlotId &edgeId: m_graph.getPlugEdges(plugId))
+			{
+				PlugEdge *edge = getEdge(edgeId);
+				if (edge)
+				{
+					edges.append(edge);
+				}
+			}
+		}
+		takeEdges(edges, false);
+
+		// delete all references to the node, but keep it in the graph store
+		forgetNode(node);
+		for (Plug *plug: node->getPlugs())
+		{
+			if (Plug::getDragTargetPlug() == plug)
+			{
+				Plug::clearDragTargetPlug();
+			}
+			if (Perimeter::getClosestPlugToMouse() == plug)
+			{
+				Perimeter::clearClosestPlugToMouse();
+			}
+			setView<Plug>(m_plugViews, plug->getGraphId(), nullptr);
+			plug->setGraphId(SlotId());
+		}
+		setView<Node>(m_nodeViews, node->getGraphId(), nullptr);
+		node->setGraphId(SlotId());
+		takeItem(node);
+		node->deleteLater();
+
+		endBatch();
+		return true;
+	}
+
+	Node *Scene::getNode(const SlotId &id) const
+	{
+		return m_graph.containsNode(id) ? m_nodeViews.value(int(id.index), nullptr) : nullptr;
+	}
+
+	Plug *Scene::getPlug(const SlotId &id) const
+	{
+		return m_graph.containsPlug(id) ? m_plugViews.value(int(id.index), nullptr) : nullptr;
+	}
+
+	PlugEdge *Scene::getEdge(const SlotId &id) const
+	{
+		return m_graph.containsEdge(id) ? m_edgeViews.value(int(id.index), nullptr) : nullptr;
+	}
+
+	const QVector<Node *> &Scene::getSelectedNodes()
+	{
+		// close the holes left by deselected nodes
+		if (m_selectionHoleCount > 0)
+		{
+			int target = 0;
+			for (Node *node: m_selectedNodes)
+			{
+				if (node)
+				{
+					m_selectedNodes[target] = node;
+					m_selectionPositions.insert(node, target);
+					++target;
+				}
+			}
+			m_selectedNodes.resize(target);
+			m_selectionHoleCount = 0;
+		}
+		return m_selectedNodes;
+	}
+
+	void Scene::deselectAllNodes()
+	{
+		// deselect back to front, so no holes are left in the selection
+		const QVector<Node *> selectedNodes = getSelectedNodes();
+		for (int position = selectedNodes.size() - 1; position >= 0; --position)
+		{
+			selectedNodes.at(position)->setSelected(false);
+		}
+	}
+
+	void Scene::updateNodeSelection(Node *node, bool isSelected)
+	{
+		if (isSelected)
+		{
+			if (!m_selectionPositions.contains(node))
+			{
+				m_selectionPositions.insert(node, m_selectedNodes.size());
+				m_selectedNodes.append(node);
+			}
+			return;
+		}
+
+		int position = m_selectionPositions.value(node, -1);
+		if (position < 0)
+		{
+			return;
+		}
+		m_selectionPositions.remove(node);
+		if (position == m_selectedNodes.size() - 1)
+		{
+			// the last node can simply be dropped, along with the holes before it
+			m_selectedNodes.removeLast();
+			while (!m_selectedNodes.isEmpty() && !m_selectedNodes.last())
+			{
+				m_selectedNodes.removeLast();
+				--m_selectionHoleCount;
+			}
+		} else
+		{
+			m_selectedNodes[position] = nullptr;
+			++m_selectionHoleCount;
+		}
+	}
+
 	void Scene::collapseAllNodes()
 	{
-		for (Node *node: m_nodes)
+		for (Node *node: getNodes())
 		{
 			node->forceCollapse();
 		}
 	}
 
+	void Scene::arrangeAllPlugs()
+	{
+		// take a snapshot of every node with a stale arrangement
+		flushMovedNodes();
+		QVector<Node *> nodes;
+		QVector<Node::Arrangement> arrangements;
+		for (Node *node: getNodes())
+		{
+			if (node->isArrangementStale())
+			{
+				nodes.append(node);
+				arrangements.append(node->prepareArrangement());
+			}
+		}
+		int nodeCount = nodes.size();
+		if (nodeCount == 0)
+		{
+			return;
+		}
+
+		// solve the arrangements, interleaved over as many jobs as there are threads
+		QThreadPool *threadPool = QThreadPool::globalInstance();
+		int jobCount = qMin(nodeCount, qMax(1, threadPool->maxThreadCount()));
+		if (jobCount == 1)
+		{
+			for (Node::Arrangement &arrangement: arrangements)
+			{
+				Node::solveArrangement(arrangement);
+			}
+		} else
+		{
+			QSemaphore done;
+			Node::Arrangement *arrangementData = arrangements.data();
+			for (int job = 0; job < jobCount; ++job)
+			{
+				threadPool->start(new ArrangementJob(arrangementData, nodeCount, job, jobCount, &done));
+			}
+			done.acquire(jobCount);
+		}
+
+		// apply all arrangements in one pass
+		beginBatch();
+		for (int index = 0; index < nodeCount; ++index)
+		{
+			nodes.at(index)->applyArrangement(arrangements.at(index));
+		}
+		for (Node *node: nodes)
+		{
+			node->validateArrangement();
+		}
+		endBatch();
+	}
+
 	void Scene::updateStyle()
 	{
-		for (Node *node: m_nodes)
+		// drop the layouts of the old fonts and plug sizes before the labels and plugs are laid out again
+		m_textLayoutCache.clear();
+		m_plugArcCache.clear();
+		for (Node *node: getNodes())
 		{
 			node->updateStyle();
 		}
@@ -204,7 +777,682 @@ namespace zodiac
 		{
 			pair->updateStyle();
 		}
+		m_clusterLayer->updateStyle();
+		m_straightEdgeLayer->updateStyle();
 		m_drawEdge->updateStyle();
+		m_spriteAtlas.clear();
+		updateSpatialIndexCellSize();
+		emit styleChanged();
+	}
+
+	void Scene::applyGraphLayout()
+	{
+		m_clusterLayer->invalidate();
+		m_viewportLayer->scheduleUpdate();
+		for (Node *node: getNodes())
+		{
+			QPointF graphPos = m_graph.getNodePos(node->getGraphId());
+			if (node->pos() != graphPos)
+			{
+				node->setPos(graphPos);
+				node->updateConnectedEdges();
+			}
+		}
+		arrangeAllPlugs();
+	}
+
+	void Scene::registerPlug(Plug *plug, const SlotId &graphId)
+	{
+		m_clusterLayer->invalidate();
+		if (graphId.isNull())
+		{
+			plug->setGraphId(m_graph.addPlug(plug->getNode()->getGraphId(), plug->getDirection()));
+			m_graph.setPlugName(plug->getGraphId(), plug->getNameAtom());
+		} else
+		{
+			// bind the plug to the existing plug of a realized node
+			bool isValid = (m_graph.getPlugNode(graphId) == plug->getNode()->getGraphId()) && !getPlug(graphId);
+#ifdef QT_DEBUG
+			Q_ASSERT(isValid);
+#else
+			if (!isValid)
+			{
+				return;
+			}
+#endif
+			plug->setGraphId(graphId);
+		}
+		setView(m_plugViews, plug->getGraphId(), plug);
+	}
+
+	void Scene::unregisterPlug(Plug *plug)
+	{
+		bool isValid = getPlug(plug->getGraphId()) == plug;
+#ifdef QT_DEBUG
+		Q_ASSERT(isValid);
+#else
+		if (!isValid)
+		{
+			return;
+		}
+#endif
+		m_clusterLayer->invalidate();
+		m_graph.removePlug(plug->getGraphId());
+		setView<Plug>(m_plugViews, plug->getGraphId(), nullptr);
+		plug->setGraphId(SlotId());
+	}
+
+	void Scene::beginBatch()
+	{
+		if (m_batchDepth++ > 0)
+		{
+			return;
+		}
+
+		// items are added and moved a lot while building, let the BSP tree be rebuilt only once at the end
+		m_indexMethodBeforeBatch = itemIndexMethod();
+		setItemIndexMethod(NoIndex);
+	}
+
+	void Scene::endBatch()
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_batchDepth > 0);
+#else
+		if (m_batchDepth <= 0)
+		{
+			return;
+		}
+#endif
+		// only the outermost batch applies the deferred updates
+		if (m_batchDepth > 1)
+		{
+			--m_batchDepth;
+			return;
+		}
+
+		m_batchDepth = 0;
+
+		// arrange and restyle every dirty node once
+		QSet<Node *> deferredNodes;
+		deferredNodes.swap(m_deferredNodes);
+		for (Node *node: deferredNodes)
+		{
+			node->updateStyle();
+		}
+
+		setItemIndexMethod(m_indexMethodBeforeBatch);
+
+		// collapse the clusters that were expanded or requested during the batch
+		m_clusterLayer->rebuild();
+	}
+
+	void Scene::unregisterEdge(PlugEdge *edge, bool isRemovedFromGraph)
+	{
+		// unregister from the connected plugs
+		Plug *fromPlug = edge->getStartPlug();
+		Plug *toPlug = edge->getEndPlug();
+		fromPlug->removeEdge(edge);
+		toPlug->removeEdge(edge);
+
+		// remove the edge from the Scene's register
+		m_edges.remove(QPair<Plug *, Plug *>(fromPlug, toPlug));
+		forgetEdge(edge);
+
+		// remove the edge from the graph store
+		if (isRemovedFromGraph)
+		{
+			m_graph.removeEdge(edge->getGraphId());
+		}
+		setView<PlugEdge>(m_edgeViews, edge->getGraphId(), nullptr);
+		edge->setGraphId(SlotId());
+	}
+
+	QList<QPair<Plug *, Plug *> > Scene::takeEdges(const QList<PlugEdge *> &edges, bool isRemovedFromGraph)
+	{
+		QList<QPair<Plug *, Plug *> > connections;
+		connections.reserve(edges.size());
+		QSet<EdgeGroup *> touchedGroups;
+		QSet<EdgeGroupPair *> touchedPairs;
+		m_clusterLayer->invalidate();
+
+		// take the edges out of the graph without updating their groups
+		for (PlugEdge *edge: edges)
+		{
+			QPair<Plug *, Plug *> edgeKey(edge->getStartPlug(), edge->getEndPlug());
+#ifdef QT_DEBUG
+			Q_ASSERT(m_edges.value(edgeKey, nullptr) == edge);
+#else
+			if (m_edges.value(edgeKey, nullptr) != edge)
+			{
+				continue;
+			}
+#endif
+			unregisterEdge(edge, isRemovedFromGraph);
+
+			EdgeGroup *edgeGroup = edge->getGroup();
+			edgeGroup->takeEdge(edge);
+			touchedGroups.insert(edgeGroup);
+			touchedPairs.insert(edgeGroup->getEdgeGroupPair());
+
+			takeItem(edge);
+			edge->deleteLater();
+			connections.append(edgeKey);
+		}
+
+		// delete emptied group pairs and update the remaining ones once
+		for (EdgeGroupPair *edgeGroupPair: touchedPairs)
+		{
+			if (edgeGroupPair->isEmpty())
+			{
+				touchedGroups.remove(edgeGroupPair->getFirstGroup());
+				touchedGroups.remove(edgeGroupPair->getSecondGroup());
+				deleteEdgeGroupPair(edgeGroupPair);
+			} else
+			{
+				edgeGroupPair->updateVisibility();
+			}
+		}
+
+		// only relabel the groups that survived
+		for (EdgeGroup *edgeGroup: touchedGroups)
+		{
+			edgeGroup->updateLabelText();
+		}
+
+		return connections;
+	}
+
+	QString Scene::getUniquePlugName(const SlotId &node, const QString &name) const
+	{
+		// the same suffixes as Node::getUniquePlugName(), names that were never interned are always unique
+		QVector<SlotId> plugIds = m_graph.getNodePlugs(node);
+		auto isTaken = [this, &plugIds](const QString &candidate) {
+			NameAtom atom = m_nameTable.find(candidate);
+			if (atom.isNull())
+			{
+				return false;
+			}
+			for (const SlotId &plugId: plugIds)
+			{
+				if (m_graph.getPlugName(plugId) == atom)
+				{
+					return true;
+				}
+			}
+			return false;
+		};
+
+		QString uniqueName = name;
+		for (uint index = 2; isTaken(uniqueName); ++index)
+		{
+			uniqueName = name + Node::getPlugSuffix() + QString::number(index);
+		}
+		return uniqueName;
+	}
+
+	void Scene::deleteEdgeGroupPair(EdgeGroupPair *edgeGroupPair)
+	{
+		QPair<Node *, Node *> firstKey = edgeGroupPair->getFirstGroup()->getKey();
+		QPair<Node *, Node *> secondKey = edgeGroupPair->getSecondGroup()->getKey();
+		Q_ASSERT(m_edgeGroups.contains(firstKey));
+		Q_ASSERT(m_edgeGroups.contains(secondKey));
+		m_edgeGroups.remove(firstKey);
+		m_edgeGroups.remove(secondKey);
+		m_edgeGroupPairs.remove(edgeGroupPair);
+		delete edgeGroupPair; // also deletes the EdgeGroups
+	}
+
+	void Scene::markEdgeDirty(BaseEdge *edge)
+	{
+		// schedule a flush with the first dirty edge of the frame
+		if (m_dirtyEdges.isEmpty())
+		{
+			QMetaObject::invokeMethod(this, "flushDirtyEdges", Qt::QueuedConnection);
+		}
+		m_dirtyEdges.insert(edge);
+	}
+
+	void Scene::flushDirtyEdges()
+	{
+		QSet<BaseEdge *> dirtyEdges;
+		dirtyEdges.swap(m_dirtyEdges);
+		for (BaseEdge *edge: dirtyEdges)
+		{
+			// a translated edge that changes its shape during a drag is rebuilt for the rest of the drag
+			if (m_rigidEdges.remove(edge))
+			{
+				edge->setOffset(QPointF());
+				m_boundaryEdges.insert(edge);
+			}
+			edge->refreshGeometry();
+		}
+		m_straightEdgeLayer->flushDirtyEdges();
+	}
+
+	bool Scene::event(QEvent *event)
+	{
+		if (event->type() == QEvent::MetaCall)
+		{
+			flushDirtyEdges();
+		}
+		return QGraphicsScene::event(event);
+	}
+
+	void Scene::forgetEdge(BaseEdge *edge)
+	{
+		m_clusterLayer->forgetEdge(edge);
+		m_viewportLayer->forgetEdge(edge);
+		m_dirtyEdges.remove(edge);
+		m_rigidEdges.remove(edge);
+		m_boundaryEdges.remove(edge);
+	}
+
+	void Scene::forgetNode(Node *node)
+	{
+		m_clusterLayer->forgetNode(node);
+		m_viewportLayer->forgetNode(node);
+		m_deferredNodes.remove(node);
+		m_movedNodes.remove(node);
+		m_dirtyIndexItems.remove(node);
+		m_spatialIndex.remove(node);
+		m_detachCounts.remove(node);
+		updateNodeSelection(node, false);
+		if (node == m_dragAnchor)
+		{
+			endNodeDrag();
+		}
+	}
+
+	void Scene::beginNodeDrag(Node *anchor)
+	{
+		if (isDraggingNodes())
+		{
+			endNodeDrag();
+		}
+		m_dragAnchor = anchor;
+		m_dragStartPos = anchor->pos();
+		updateItemIndexMethod();
+
+		// bring all edges up-to-date, so none of the rigid ones has to be rebuilt during the drag
+		flushDirtyEdges();
+
+		// the anchor is moved by Qt as well, even if it is not selected
+		QVector<Node *> draggedNodes = getSelectedNodes();
+		if (!anchor->isSelected())
+		{
+			draggedNodes.append(anchor);
+		}
+
+		// sort all connected edges, internal edges are only added by their start node so they are only visited once
+		for (Node *node: draggedNodes)
+		{
+			// detached nodes are not moved by Qt
+			if (!node->scene())
+			{
+				continue;
+			}
+			for (const SlotId &plugId: m_graph.getNodePlugs(node->getGraphId()))
+			{
+				for (const SlotId &edgeId: m_graph.getPlugEdges(plugId))
+				{
+					// connections to nodes without items have no edge to move
+					PlugEdge *edge = getEdge(edgeId);
+					if (!edge)
+					{
+						continue;
+					}
+					Node *startNode = edge->getStartPlug()->getNode();
+					Node *otherNode = startNode == node ? edge->getEndPlug()->getNode() : startNode;
+					if (!isDraggedNode(otherNode))
+					{
+						m_boundaryEdges.insert(edge);
+					} else if (startNode == node)
+					{
+						m_rigidEdges.insert(edge);
+					}
+				}
+			}
+			for (StraightEdge *edge: node->getStraightEdges())
+			{
+				Node *otherNode = edge->getFromNode() == node ? edge->getToNode() : edge->getFromNode();
+				if (!isDraggedNode(otherNode))
+				{
+					m_boundaryEdges.insert(edge);
+				} else if (edge->getFromNode() == node)
+				{
+					m_rigidEdges.insert(edge);
+				}
+			}
+		}
+	}
+
+	void Scene::updateNodeDrag()
+	{
+		if (!isDraggingNodes())
+		{
+			return;
+		}
+
+		// all dragged nodes are moved by the same offset
+		QPointF offset = m_dragAnchor->pos() - m_dragStartPos;
+		for (BaseEdge *edge: m_rigidEdges)
+		{
+			edge->setOffset(offset);
+		}
+		for (BaseEdge *edge: m_boundaryEdges)
+		{
+			markEdgeDirty(edge);
+		}
+	}
+
+	void Scene::endNodeDrag()
+	{
+		// move the translated edges back onto their geometry and rebuild it at the final position
+		for (BaseEdge *edge: m_rigidEdges)
+		{
+			edge->setOffset(QPointF());
+			markEdgeDirty(edge);
+		}
+		m_rigidEdges.clear();
+		m_boundaryEdges.clear();
+		m_dragAnchor = nullptr;
+		updateItemIndexMethod();
+	}
+
+	void Scene::detachNode(Node *node)
+	{
+		int count = m_detachCounts.value(node, 0);
+		m_detachCounts.insert(node, count + 1);
+		if (count == 0)
+		{
+			removeItem(node);
+		}
+	}
+
+	void Scene::attachNode(Node *node)
+	{
+		int count = m_detachCounts.value(node, 0);
+#ifdef QT_DEBUG
+		Q_ASSERT(count > 0);
+#else
+		if (count <= 0)
+		{
+			return;
+		}
+#endif
+		if (count > 1)
+		{
+			m_detachCounts.insert(node, count - 1);
+			return;
+		}
+		m_detachCounts.remove(node);
+		addItem(node);
+	}
+
+	void Scene::detachEdge(BaseEdge *edge)
+	{
+		int count = m_detachCounts.value(edge, 0);
+		m_detachCounts.insert(edge, count + 1);
+		if (count == 0)
+		{
+			edge->detach();
+		}
+		m_straightEdgeLayer->markEdgeDirty(edge);
+	}
+
+	void Scene::attachEdge(BaseEdge *edge)
+	{
+		int count = m_detachCounts.value(edge, 0);
+#ifdef QT_DEBUG
+		Q_ASSERT(count > 0);
+#else
+		if (count <= 0)
+		{
+			return;
+		}
+#endif
+		m_straightEdgeLayer->markEdgeDirty(edge);
+		if (count > 1)
+		{
+			m_detachCounts.insert(edge, count - 1);
+			return;
+		}
+		m_detachCounts.remove(edge);
+		edge->attach();
+	}
+
+	void Scene::takeItem(QGraphicsItem *item)
+	{
+		// a detached item is not part of the scene anymore, a forgotten node may already have lost its detach count
+		m_detachCounts.remove(item);
+		if (item->scene() == this)
+		{
+			removeItem(item);
+		} else
+		{
+			emit itemChanged(item);
+		}
+	}
+
+	void Scene::setSpatialIndexEnabled(bool enabled)
+	{
+		if (enabled == m_isSpatialIndexEnabled)
+		{
+			return;
+		}
+		m_isSpatialIndexEnabled = enabled;
+		m_spatialIndex.clear();
+		m_dirtyIndexItems.clear();
+
+		// index all nodes and edges that are currently in the scene
+		if (m_isSpatialIndexEnabled)
+		{
+			for (QGraphicsItem *item: items())
+			{
+				QGraphicsObject *object = item->toGraphicsObject();
+				if ((!item->parentItem()) && (qobject_cast<Node *>(object) || qobject_cast<BaseEdge *>(object)
+				                              || qobject_cast<StraightEdgeLayer *>(object)))
+				{
+					m_dirtyIndexItems.insert(item);
+				}
+			}
+		}
+
+		updateItemIndexMethod();
+	}
+
+	void Scene::markIndexDirty(QGraphicsItem *item)
+	{
+		emit itemChanged(item);
+		if (!m_isSpatialIndexEnabled)
+		{
+			return;
+		}
+		if (item->scene() != this)
+		{
+			m_dirtyIndexItems.remove(item);
+			m_spatialIndex.remove(item);
+			return;
+		}
+		m_dirtyIndexItems.insert(item);
+	}
+
+	void Scene::markNodeMoved(Node *node)
+	{
+		m_movedNodes.insert(node);
+	}
+
+	void Scene::flushMovedNodes()
+	{
+		for (Node *node: m_movedNodes)
+		{
+			node->invalidateConnectedArrangements();
+		}
+		m_movedNodes.clear();
+	}
+
+	QList<QGraphicsItem *> Scene::getItemsAt(const QPointF &pos)
+	{
+		if (!m_isSpatialIndexEnabled)
+		{
+			return items(pos);
+		}
+		flushSpatialIndex();
+
+		// top-level items are sorted by their z-value, their children by collectItems()
+		QVector<QGraphicsItem *> candidates = m_spatialIndex.query(pos);
+		std::stable_sort(candidates.begin(), candidates.end(), [](QGraphicsItem *a, QGraphicsItem *b) {
+			return a->zValue() > b->zValue();
+		});
+		QList<QGraphicsItem *> result;
+		for (QGraphicsItem *candidate: candidates)
+		{
+			collectItems(candidate, [&pos](QGraphicsItem *item) {
+				return item->contains(item->mapFromScene(pos));
+			}, result);
+		}
+		return result;
+	}
+
+	QGraphicsItem *Scene::getItemAt(const QPointF &pos)
+	{
+		QList<QGraphicsItem *> itemsAtPos = getItemsAt(pos);
+		return itemsAtPos.isEmpty() ? nullptr : itemsAtPos.first();
+	}
+
+	QList<QGraphicsItem *> Scene::getItemsIn(const QRectF &rect)
+	{
+		if (!m_isSpatialIndexEnabled)
+		{
+			return items(rect);
+		}
+		flushSpatialIndex();
+
+		QPainterPath path;
+		path.addRect(rect);
+		QList<QGraphicsItem *> result;
+		for (QGraphicsItem *candidate: m_spatialIndex.query(rect))
+		{
+			collectItems(candidate, [&path](QGraphicsItem *item) {
+				return item->collidesWithPath(item->mapFromScene(path));
+			}, result);
+		}
+		return result;
+	}
+
+	bool Scene::isDraggedNode(Node *node) const
+	{
+		return (node->isSelected() && node->scene()) || (node == m_dragAnchor);
+	}
+
+	void Scene::flushSpatialIndex()
+	{
+		QSet<QGraphicsItem *> dirtyItems;
+		dirtyItems.swap(m_dirtyIndexItems);
+		for (QGraphicsItem *item: dirtyItems)
+		{
+			if (item->scene() != this)
+			{
+				m_spatialIndex.remove(item);
+				continue;
+			}
+
+			// plugs move out to the perimeter while the node expands, without the node being marked dirty
+			QRectF rect = item->sceneBoundingRect().united(item->mapRectToScene(item->childrenBoundingRect()));
+			qreal margin = Plug::getWidth();
+			m_spatialIndex.insert(item, rect.marginsAdded(QMarginsF(margin, margin, margin, margin)));
+		}
+	}
+
+	void Scene::updateSpatialIndexCellSize()
+	{
+		// a cell should hold about one node of minimal size with its plugs
+		qreal cellSize = 2. * (qMax(Perimeter::getMinRadius(), Node::getCoreRadius()) + Plug::getWidth());
+		m_spatialIndex.setCellSize(cellSize);
+		m_straightEdgeLayer->setCellSize(cellSize);
+		m_graph.setCellSize(cellSize);
+	}
+
+	void Scene::updateItemIndexMethod()
+	{
+		ItemIndexMethod indexMethod = (m_isSpatialIndexEnabled && isDraggingNodes()) ? NoIndex : BspTreeIndex;
+
+		// an open batch restores the index method when it ends
+		if (m_batchDepth > 0)
+		{
+			m_indexMethodBeforeBatch = indexMethod;
+		} else if (itemIndexMethod() != indexMethod)
+		{
+			setItemIndexMethod(indexMethod);
+		}
 	}
 
 } // namespace zodiac
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER
+//
+
+///
+/// \brief Stores the item viewing a GraphStore element at the slot index of the element's id.
+///
+/// \param [in,out] views   Items indexed by slot index.
+/// \param [in] id          Id of the element in the GraphStore.
+/// \param [in] item        Item to store, <i>nullptr</i> to clear the slot.
+///
+template<typename T>
+static void setView(QVector<T *> &views, const zodiac::SlotId &id, T *item)
+{
+	int index = int(id.index);
+	if (index >= views.size())
+	{
+		views.resize(index + 1);
+	}
+	views[index] = item;
+}
+
+///
+/// \brief Collects a visible item and all of its descendants that are hit, in descending stacking order.
+///
+/// Like the QGraphicsScene, fully transparent items are skipped and so are their children, unless the item does not
+/// propagate its opacity.
+///
+/// \param [in] item        Item to test along with its descendants.
+/// \param [in] hit         Function returning true for every item that is hit.
+/// \param [in,out] result  List to append the hit items to.
+///
+template<typename Hit>
+static void collectItems(QGraphicsItem *item, Hit hit, QList<QGraphicsItem *> &result)
+{
+	if (!item->isVisible())
+	{
+		return;
+	}
+	bool isTransparent = qFuzzyIsNull(item->opacity());
+	bool isSearchingChildren = !isTransparent || (item->flags() & QGraphicsItem::ItemDoesntPropagateOpacityToChildren);
+
+	// child items are sorted in ascending stacking order, some of them are stacked behind their parent
+	QList<QGraphicsItem *> children = isSearchingChildren ? item->childItems() : QList<QGraphicsItem *>();
+	for (int index = children.size() - 1; index >= 0; --index)
+	{
+		QGraphicsItem *child = children.at(index);
+		if (!(child->flags() & QGraphicsItem::ItemStacksBehindParent) && (child->zValue() >= 0.))
+		{
+			collectItems(child, hit, result);
+		}
+	}
+	if (!isTransparent && hit(item))
+	{
+		result.append(item);
+	}
+	for (int index = children.size() - 1; index >= 0; --index)
+	{
+		QGraphicsItem *child = children.at(index);
+		if ((child->flags() & QGraphicsItem::ItemStacksBehindParent) || (child->zValue() < 0.))
+		{
+			collectItems(child, hit, result);
+		}
+	}
+}
@@ -37,11 +37,29 @@
 #include <QGraphicsScene>
 #include <QUuid>
 #include <QSet>
+#include <QVector>
 #include <QtGlobal>
 
+#include "flathashmap.h"
+#include "graphstore.h"
+#include "itemcache.h"
+#include "nametable.h"
+#include "plugarccache.h"
+#include "spatialindex.h"
+#include "spriteatlas.h"
+#include "textlayoutcache.h"
+
 namespace zodiac
 {
 
+	class BaseEdge;
+
+	class ClusterLayer;
+
+	class ViewportLayer;
+
+	class StraightEdgeLayer;
+
 	class DrawEdge;
 
 	class PlugEdge;
@@ -112,12 +130,122 @@ namespace zodiac
 		///
 		bool removeNode(Node *node);
 
+		///
+		/// \brief Removes many Node%s from this Scene at once, including all PlugEdge%s connected to them.
+		///
+		/// The connected PlugEdge%s are removed as with removeEdges(), all deferred updates are applied once at the end.
+		/// Instead of the per-Node signals emitted by removeEdge(), a single elementsRemoved() signal is emitted for all
+		/// removed connections and Node%s.
+		///
+		/// Make sure that this Scene actually contains all given Node%s.
+		/// If it doesn't, this function will throw an assertion error in debug mode and skip the foreign Node%s in
+		/// release mode.
+		/// A Node given more than once is removed only once.
+		///
+		/// After calling this function, all remaining pointers to the removed Node%s are to be discarded without further
+		/// use.
+		///
+		/// \param [in] nodes   Node%s to remove.
+		///
+		void removeNodes(const QList<Node *> &nodes);
+
 		///
 		/// \brief Returns all Node%s managed by the Scene.
 		///
+		/// Nodes that only exist in the GraphStore have no Node item and are not part of the result.
+		///
 		/// \return All Node%s managed by the Scene.
 		///
-		QList<Node *> getNodes() const { return m_nodes.toList(); }
+		QList<Node *> getNodes() const;
+
+		///
+		/// \brief Adds a new node to the GraphStore without creating any items for it.
+		///
+		/// Use this instead of createNode() to load graphs that are too large to hold a Node item for every node.
+		/// The items of the node are created on demand with realizeNode(), for example by the ViewportLayer once the
+		/// node comes into view.
+		///
+		/// \param [in] name    Name of the new node.
+		/// \param [in] pos     (optional) Position of the new node in scene coordinates.
+		/// \param [in] uuid    (optional) The unique identifier of the new node.
+		///
+		/// \return             Id of the new node in the GraphStore.
+		///
+		SlotId addGraphNode(const QString &name, const QPointF &pos = QPointF(), const QUuid &uuid = QUuid());
+
+		///
+		/// \brief Adds a new plug to a node in the GraphStore.
+		///
+		/// If the node has a Node item, this is the same as calling Node::createPlug().
+		/// Like there, the name is only a proposal and a suffix is appended to it if it is already taken.
+		///
+		/// \param [in] node        Id of the node in the GraphStore.
+		/// \param [in] name        The proposed name of the plug.
+		/// \param [in] direction   Direction of the plug, must either be IN or OUT.
+		///
+		/// \return                 Id of the new plug in the GraphStore, or a null SlotId if it could not be created.
+		///
+		SlotId addGraphPlug(const SlotId &node, const QString &name, PlugDirection direction);
+
+		///
+		/// \brief Connects two plugs in the GraphStore.
+		///
+		/// If both nodes have Node items, this is the same as calling createEdge().
+		/// Otherwise the connection is only added to the GraphStore and its PlugEdge is created once both of its nodes
+		/// have been realized.
+		/// No signals are emitted for connections to nodes without items.
+		///
+		/// \param [in] fromPlug    Id of the start plug.
+		/// \param [in] toPlug      Id of the end plug.
+		///
+		/// \return                 Id of the new edge in the GraphStore, or a null SlotId if it could not be created.
+		///
+		SlotId addGraphEdge(const SlotId &fromPlug, const SlotId &toPlug);
+
+		///
+		/// \brief Creates the items of a node in the GraphStore.
+		///
+		/// Creates the Node with all of its Plug%s and the PlugEdge%s to all other Node%s with items.
+		/// If the node already has items, its existing Node is returned.
+		///
+		/// \param [in] id  Id of the node in the GraphStore.
+		///
+		/// \return         The Node of the given id, or <i>nullptr</i> if the id is null or stale.
+		///
+		Node *realizeNode(const SlotId &id);
+
+		///
+		/// \brief Deletes the items of a Node, while keeping it and its connections in the GraphStore.
+		///
+		/// This is the opposite of realizeNode().
+		/// The Node, its Plug%s and PlugEdge%s are deleted without emitting any signals, the node can be realized again
+		/// at any time.
+		/// After calling this function, all remaining pointers to the released Node are to be discarded without
+		/// further use.
+		///
+		/// \param [in] node    Node to release.
+		///
+		/// \return             <i>true</i> if the Node was released -- <i>false</i> otherwise.
+		///
+		bool releaseNode(Node *node);
+
+		///
+		/// \brief Looks up a Node by its id in the GraphStore.
+		///
+		/// \param [in] id  Id of the Node.
+		///
+		/// \return         The Node or <i>nullptr</i>, if the id is null or stale.
+		///
+		Node *getNode(const SlotId &id) const;
+
+		///
+		/// \brief Looks up a Plug by its id in the GraphStore.
+		///
+		/// \param [in] id  Id of the Plug.
+		///
+		/// \return         The Plug or <i>nullptr</i>, if the id is null or stale.
+		///
+		Plug *getPlug(const SlotId &id) const;
 
 		///
 		/// \brief  Creates and adds a new PlugEdge to the graph, connecting two Plug%s.
@@ -149,6 +277,22 @@ namespace zodiac
 		///
 		void removeEdge(PlugEdge *edge);
 
+		///
+		/// \brief Removes many PlugEdge%s from the Scene at once.
+		///
+		/// Unlike calling removeEdge() for every PlugEdge, every affected EdgeGroupPair is either deleted or updated
+		/// only once, labels are only regenerated for EdgeGroup%s that survive the removal and instead of the per-Node
+		/// signals, a single elementsRemoved() signal is emitted.
+		///
+		/// Make sure that this Scene actually contains all given PlugEdge%s.
+		/// If it doesn't, this function will throw an assertion error in debug mode and skip the foreign edges in
+		/// release mode.
+		/// A PlugEdge given more than once is removed only once.
+		///
+		/// \param [in] edges   PlugEdge%s to remove.
+		///
+		void removeEdges(const QList<PlugEdge *> &edges);
+
 		///
 		/// \brief Returns an existing PlugEdge from the Scene.
 		///
@@ -160,11 +304,56 @@ namespace zodiac
 		///
 		PlugEdge *getEdge(Plug *fromPlug, Plug *toPlug);
 
+		///
+		/// \brief Looks up a PlugEdge by its id in the GraphStore.
+		///
+		/// \param [in] id  Id of the PlugEdge.
+		///
+		/// \return         The PlugEdge or <i>nullptr</i>, if the id is null or stale.
+		///
+		PlugEdge *getEdge(const SlotId &id) const;
+
+		///
+		/// \brief All selected Node%s in the order in which they were selected.
+		///
+		/// The selection is maintained incrementally by the Node%s, so unlike QGraphicsScene::selectedItems() this does
+		/// not walk all items in the Scene.
+		///
+		/// \return Selected Node%s.
+		///
+		const QVector<Node *> &getSelectedNodes();
+
+		///
+		/// \brief Deselects all selected Node%s.
+		///
+		void deselectAllNodes();
+
+		///
+		/// \brief Adds a Node to or removes it from the selection returned by getSelectedNodes().
+		///
+		/// Must only be called by the Node whose selection state has changed.
+		///
+		/// \param [in] node        Node that was selected or deselected.
+		/// \param [in] isSelected  <i>true</i> if the Node was selected -- <i>false</i> if it was deselected.
+		///
+		void updateNodeSelection(Node *node, bool isSelected);
+
 		///
 		/// \brief Force-collapses all Node%s in the scene.
 		///
 		void collapseAllNodes();
 
+		///
+		/// \brief Arranges the Plug%s of all Node%s with a stale arrangement at once.
+		///
+		/// The target directions of all Plug%s are taken in a snapshot first, then the arrangement of each Node is solved
+		/// in parallel on the global QThreadPool and finally applied to all Plug%s in a single pass.
+		/// Node%s connected to a Node that has moved are arranged as well.
+		/// Call this after building or moving many Node%s, so they do not have to arrange their Plug%s one by one when
+		/// they are first expanded.
+		///
+		void arrangeAllPlugs();
+
 		///
 		/// \brief Returns the DrawEdge used to draw new PlugEdge%s in the scene.
 		///
@@ -177,6 +366,478 @@ namespace zodiac
 		///
 		void updateStyle();
 
+		///
+		/// \brief Opens a batch of structural changes to the Scene.
+		///
+		/// While a batch is open, Node%s do not re-arrange and restyle themselves after every created or removed Plug
+		/// and the QGraphicsScene index is disabled.
+		/// Instead, every affected Node is remembered and updated exactly once when the batch is closed with endBatch().
+		/// Edge labels need no batching, their texts are only generated when they are about to be shown.
+		///
+		/// Batches can be nested, only closing the outermost batch applies the deferred updates.
+		/// Every call to beginBatch() must be matched with a call to endBatch() -- see SceneBatch for a RAII guard.
+		///
+		void beginBatch();
+
+		///
+		/// \brief Closes a batch opened with beginBatch().
+		///
+		/// If this closes the outermost batch, all deferred updates are applied.
+		/// Calling this function without an open batch throws an assertion error in debug mode and does nothing in
+		/// release mode.
+		///
+		void endBatch();
+
+		///
+		/// \brief Tests whether there is currently a batch open on this Scene.
+		///
+		/// \return <i>true</i> if updates are currently deferred -- <i>false</i> otherwise.
+		///
+		inline bool isInBatch() const { return m_batchDepth > 0; }
+
+		///
+		/// \brief Remembers a Node that needs to update its style once the current batch is closed.
+		///
+		/// \param [in] node    Node to update.
+		///
+		inline void deferNodeUpdate(Node *node) { m_deferredNodes.insert(node); }
+
+
+		///
+		/// \brief The headless GraphStore mirroring the topology and geometry of this Scene.
+		///
+		/// Every Node, Plug and PlugEdge in the Scene is a view onto an element of the GraphStore, identified by its
+		/// graph index.
+		/// The reverse is not true: nodes added with addGraphNode() only get their items once they are realized.
+		/// Node positions may be modified freely in the GraphStore (for example by a layout algorithm) and applied to
+		/// the Node%s with applyGraphLayout(), but structural changes must only be made through the Scene.
+		///
+		/// \return The GraphStore of this Scene.
+		///
+		inline GraphStore &getGraph() { return m_graph; }
+
+		///
+		/// \brief The headless GraphStore mirroring the topology and geometry of this Scene.
+		///
+		/// \return The GraphStore of this Scene.
+		///
+		inline const GraphStore &getGraph() const { return m_graph; }
+
+		///
+		/// \brief The ClusterLayer collapsing clusters of Node%s into aggregates when the View is zoomed out.
+		///
+		/// \return The ClusterLayer of this Scene.
+		///
+		inline ClusterLayer *getClusterLayer() { return m_clusterLayer; }
+
+		///
+		/// \brief The ViewportLayer taking Node%s and edges far outside of the View%s out of the Scene.
+		///
+		/// \return The ViewportLayer of this Scene.
+		///
+		inline ViewportLayer *getViewportLayer() { return m_viewportLayer; }
+
+		///
+		/// \brief The StraightEdgeLayer drawing all StraightEdge%s of the EdgeGroup%s at once, if it is batching.
+		///
+		/// \return The StraightEdgeLayer of this Scene.
+		///
+		inline StraightEdgeLayer *getStraightEdgeLayer() { return m_straightEdgeLayer; }
+
+		///
+		/// \brief The SpriteAtlas shared by all Node cores and Perimeter%s of this Scene.
+		///
+		/// \return Sprite atlas.
+		///
+		inline SpriteAtlas &getSpriteAtlas() { return m_spriteAtlas; }
+
+		///
+		/// \brief The ItemCache holding the device pixmaps of all Plug%s and labels of this Scene.
+		///
+		/// \return Item cache.
+		///
+		inline ItemCache &getItemCache() { return m_itemCache; }
+
+		///
+		/// \brief The ItemCache holding the device pixmaps of all Plug%s and labels of this Scene.
+		///
+		/// \return Item cache.
+		///
+		inline const ItemCache &getItemCache() const { return m_itemCache; }
+
+		///
+		/// \brief The TextLayoutCache shared by all NodeLabel%s and PlugLabel%s of this Scene.
+		///
+		/// \return Text layout cache.
+		///
+		inline TextLayoutCache &getTextLayoutCache() { return m_textLayoutCache; }
+
+		///
+		/// \brief The PlugArcCache shared by all Plug%s of this Scene.
+		///
+		/// \return Plug arc cache.
+		///
+		inline PlugArcCache &getPlugArcCache() { return m_plugArcCache; }
+
+		///
+		/// \brief The NameTable interning the names of all Plug%s of this Scene.
+		///
+		/// \return Name table.
+		///
+		inline NameTable &getNameTable() { return m_nameTable; }
+
+		///
+		/// \brief The NameTable interning the names of all Plug%s of this Scene.
+		///
+		/// \return Name table.
+		///
+		inline const NameTable &getNameTable() const { return m_nameTable; }
+
+		///
+		/// \brief Takes a Node out of the Scene without deleting it, until it is attached again with attachNode().
+		///
+		/// A Node can be detached several times (for example by the ClusterLayer and the ViewportLayer), it is only
+		/// put back into the Scene once it was attached as many times as it was detached.
+		/// The Node keeps its selection state while it is detached.
+		///
+		/// \param [in] node    Node to detach.
+		///
+		void detachNode(Node *node);
+
+		///
+		/// \brief Attaches a Node detached with detachNode().
+		///
+		/// \param [in] node    Node to attach.
+		///
+		void attachNode(Node *node);
+
+		///
+		/// \brief Takes an edge and its EdgeLabel out of the Scene without deleting them, see detachNode().
+		///
+		/// \param [in] edge    Edge to detach.
+		///
+		void detachEdge(BaseEdge *edge);
+
+		///
+		/// \brief Attaches an edge detached with detachEdge().
+		///
+		/// \param [in] edge    Edge to attach.
+		///
+		void attachEdge(BaseEdge *edge);
+
+		///
+		/// \brief Removes an item that is about to be deleted from the Scene, whether it is currently detached or not.
+		///
+		/// \param [in] item    Item to remove.
+		///
+		void takeItem(QGraphicsItem *item);
+
+		///
+		/// \brief How often an item was detached without being attached again.
+		///
+		/// \param [in] item    Item to test.
+		///
+		/// \return             Number of pending detachments, zero if the item is attached.
+		///
+		inline int getDetachCount(QGraphicsItem *item) const { return m_detachCounts.value(item, 0); }
+
+		///
+		/// \brief Moves all Node%s to the positions stored in the GraphStore.
+		///
+		/// Afterwards, the Plug%s of all moved Node%s are arranged with arrangeAllPlugs().
+		///
+		void applyGraphLayout();
+
+		///
+		/// \brief Adds a new Plug to the GraphStore, or binds it to an existing plug in the GraphStore.
+		///
+		/// Must only be called by the Node creating the Plug.
+		///
+		/// \param [in] plug    Plug to register.
+		/// \param [in] graphId (optional) Id of the existing plug that the Plug is created for, see realizeNode().
+		///                     If null, a new plug is added to the GraphStore.
+		///
+		void registerPlug(Plug *plug, const SlotId &graphId = SlotId());
+
+		///
+		/// \brief Removes a Plug from the GraphStore.
+		///
+		/// Must only be called by the Node removing the Plug.
+		///
+		/// \param [in] plug    Plug to unregister.
+		///
+		void unregisterPlug(Plug *plug);
+
+		///
+		/// \brief Marks an edge whose geometry needs to be rebuilt before the next frame is painted.
+		///
+		/// Edges are notified many times per frame when a Node is dragged or expanded, marking them instead of
+		/// updating them right away makes sure every edge is rebuilt at most once per frame.
+		/// The dirty edges are updated in flushDirtyEdges(), which is called from the event loop before the
+		/// QGraphicsScene processes its own changes, see event().
+		///
+		/// \param [in] edge    Edge to update.
+		///
+		void markEdgeDirty(BaseEdge *edge);
+
+		///
+		/// \brief Forgets about an edge that was marked dirty or is moved by a Node drag.
+		///
+		/// Must be called before an edge is deleted.
+		///
+		/// \param [in] edge    Edge that is about to be deleted.
+		///
+		void forgetEdge(BaseEdge *edge);
+
+		///
+		/// \brief Removes a Node from every register of the Scene that does not own it.
+		///
+		/// Is called by the destructor of every Node, including the aggregates of the ClusterLayer, and by the
+		/// Scene itself as soon as a Node is removed or released.
+		///
+		/// \param [in] node    Node that is about to be deleted.
+		///
+		void forgetNode(Node *node);
+
+		///
+		/// \brief Starts dragging all selected Node%s.
+		///
+		/// Sorts the edges connected to the dragged Node%s into two kinds:
+		/// Edges between two dragged Node%s are translated rigidly with the drag, edges with only one dragged end are
+		/// rebuilt with every step of the drag.
+		/// This way, dragging a large selection only rebuilds the edges at its boundary.
+		///
+		/// \param [in] anchor  Node grabbed by the mouse, is dragged even if it is not selected.
+		///
+		void beginNodeDrag(Node *anchor);
+
+		///
+		/// \brief Updates the edges of the dragged Node%s after they were moved.
+		///
+		void updateNodeDrag();
+
+		///
+		/// \brief Ends dragging the Node%s and rebuilds the translated edges at their final position.
+		///
+		void endNodeDrag();
+
+		///
+		/// \brief Tests, whether Node%s are currently dragged.
+		///
+		/// \return <i>true</i> between calls to beginNodeDrag() and endNodeDrag() -- <i>false</i> otherwise.
+		///
+		inline bool isDraggingNodes() const { return m_dragAnchor != nullptr; }
+
+		///
+		/// \brief Answers item queries with the SpatialIndex of this Scene instead of the BSP tree of the QGraphicsScene.
+		///
+		/// Queries through getItemsAt(), getItemAt() and getItemsIn() are answered by the SpatialIndex.
+		/// Only Node%s and edges are indexed, other items are not found by these queries while the index is enabled.
+		/// The BSP tree of Qt stays in use for hover events, rubber band selection and painting.
+		/// Only while Node%s are dragged it is switched off, so moving them does not re-insert them into the tree --
+		/// Qt does no hover hit-testing while an item grabs the mouse anyway.
+		///
+		/// \param [in] enabled <i>true</i> to use the SpatialIndex -- <i>false</i> to use the BSP tree of Qt only.
+		///
+		void setSpatialIndexEnabled(bool enabled);
+
+		///
+		/// \brief Tests, whether the SpatialIndex of this Scene is used instead of the BSP tree of the QGraphicsScene.
+		///
+		/// \return <i>true</i> if the SpatialIndex is enabled -- <i>false</i> otherwise.
+		///
+		inline bool isSpatialIndexEnabled() const { return m_isSpatialIndexEnabled; }
+
+		///
+		/// \brief Marks a Node, edge or layer whose position or extent in the SpatialIndex needs to be updated.
+		///
+		/// Dirty items are updated lazily with the next query.
+		/// Items that have left the Scene are removed from the index right away, so they can be deleted afterwards.
+		/// Emits itemChanged(), whether the SpatialIndex is enabled or not.
+		///
+		/// \param [in] item    Item that was moved, changed its shape or visibility or was added to or removed from the
+		///                     Scene.
+		///
+		void markIndexDirty(QGraphicsItem *item);
+
+		///
+		/// \brief Emits itemChanged() for a Node or edge, whose extent stayed the same but which is drawn differently.
+		///
+		/// \param [in] item    Item that was selected, expanded, hovered or the like.
+		///
+		inline void markItemChanged(QGraphicsItem *item) { emit itemChanged(item); }
+
+		///
+		/// \brief Remembers a Node that has moved, so the arrangements of its neighbours can be invalidated lazily.
+		///
+		/// Moving a Node changes the target directions of all Plug%s connected to it.
+		/// Instead of visiting them with every move, their Node%s are invalidated once by flushMovedNodes().
+		///
+		/// \param [in] node    Node that has moved.
+		///
+		void markNodeMoved(Node *node);
+
+		///
+		/// \brief Invalidates the arrangements of all Node%s connected to a Node that has moved since the last call.
+		///
+		/// Is called before any Plug%s are arranged.
+		///
+		void flushMovedNodes();
+
+		///
+		/// \brief All visible items whose shape contains the given point, topmost first.
+		///
+		/// \param [in] pos Point in scene coordinates.
+		///
+		/// \return         Items under the point.
+		///
+		QList<QGraphicsItem *> getItemsAt(const QPointF &pos);
+
+		///
+		/// \brief The topmost visible item whose shape contains the given point.
+		///
+		/// \param [in] pos Point in scene coordinates.
+		///
+		/// \return         Topmost item under the point, or <i>nullptr</i> if there is none.
+		///
+		QGraphicsItem *getItemAt(const QPointF &pos);
+
+		///
+		/// \brief All visible items whose shape intersects the given rectangle, in no particular order.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Items intersecting the rectangle.
+		///
+		QList<QGraphicsItem *> getItemsIn(const QRectF &rect);
+
+	public slots:
+
+		///
+		/// \brief Rebuilds the geometry of all edges marked with markEdgeDirty().
+		///
+		void flushDirtyEdges();
+
+	signals:
+
+		///
+		/// \brief Is emitted once by removeEdges() and removeNodes() for all removed elements.
+		///
+		/// The Plug%s of removed Node%s are only valid until control returns to the event loop.
+		///
+		/// \param [out] connections    Start and end Plug of every removed PlugEdge.
+		/// \param [out] nodes          Unique ids of all removed Node%s.
+		///
+		void elementsRemoved(const QList<QPair<Plug *, Plug *> > &connections, const QList<QUuid> &nodes);
+
+		///
+		/// \brief Is emitted whenever a Node or edge was moved, changed its shape, visibility or state, or was added or
+		/// removed.
+		///
+		/// Removed items are only valid until the signal returns.
+		///
+		/// \param [out] item   Item that has changed.
+		///
+		void itemChanged(QGraphicsItem *item);
+
+		///
+		/// \brief Is emitted by updateStyle(), after the style changes were applied to all items.
+		///
+		void styleChanged();
+
+	protected: // methods
+
+		///
+		/// \brief Rebuilds the dirty edges before any queued call is processed.
+		///
+		/// The QGraphicsScene collects the changed items of a frame in queued calls as well, so flushing the edges
+		/// first makes sure that they are part of the same update and not drawn a frame late.
+		///
+		/// \param [in] event   Event to handle.
+		///
+		/// \return             <i>true</i> if the event was handled -- <i>false</i> otherwise.
+		///
+		bool event(QEvent *event) override;
+
+	private: // methods
+
+		///
+		/// \brief Creates the PlugEdge item for an edge in the GraphStore, along with its EdgeGroupPair if necessary.
+		///
+		/// \param [in] fromPlug    Start Plug of the PlugEdge.
+		/// \param [in] toPlug      End Plug of the PlugEdge.
+		/// \param [in] graphId     Id of the edge in the GraphStore.
+		///
+		/// \return                 New PlugEdge.
+		///
+		PlugEdge *createEdgeItem(Plug *fromPlug, Plug *toPlug, const SlotId &graphId);
+
+		///
+		/// \brief Removes a PlugEdge from its Plug%s and the registers of the Scene.
+		///
+		/// \param [in] edge                PlugEdge to unregister.
+		/// \param [in] isRemovedFromGraph  <i>true</i> if the edge is removed from the GraphStore as well --
+		///                                 <i>false</i> if only its item is deleted, see releaseNode().
+		///
+		void unregisterEdge(PlugEdge *edge, bool isRemovedFromGraph);
+
+		///
+		/// \brief Removes many PlugEdge%s without emitting any signals, see removeEdges().
+		///
+		/// \param [in] edges               PlugEdge%s to remove.
+		/// \param [in] isRemovedFromGraph  <i>true</i> if the edges are removed from the GraphStore as well --
+		///                                 <i>false</i> if only their items are deleted, see releaseNode().
+		///
+		/// \return                         Start and end Plug of every removed PlugEdge.
+		///
+		QList<QPair<Plug *, Plug *> > takeEdges(const QList<PlugEdge *> &edges, bool isRemovedFromGraph);
+
+		///
+		/// \brief Makes the name of a new plug unique among the plugs of a node without items, see
+		/// Node::createPlug().
+		///
+		/// \param [in] node    Id of the node in the GraphStore.
+		/// \param [in] name    The proposed name of the plug.
+		///
+		/// \return             A name that no other plug of the node has.
+		///
+		QString getUniquePlugName(const SlotId &node, const QString &name) const;
+
+		///
+		/// \brief Unregisters and deletes an empty EdgeGroupPair along with its EdgeGroup%s.
+		///
+		/// \param [in] edgeGroupPair   Empty EdgeGroupPair to delete.
+		///
+		void deleteEdgeGroupPair(EdgeGroupPair *edgeGroupPair);
+
+		///
+		/// \brief Tests, whether a Node is moved by the current Node drag.
+		///
+		/// \param [in] node    Node to test.
+		///
+		/// \return             <i>true</i> if the Node is dragged -- <i>false</i> otherwise.
+		///
+		bool isDraggedNode(Node *node) const;
+
+		///
+		/// \brief Updates the SpatialIndex with all items marked with markIndexDirty().
+		///
+		void flushSpatialIndex();
+
+		///
+		/// \brief Updates the cell size of the SpatialIndex and the node grid of the GraphStore to the current size of the
+		/// Node%s.
+		///
+		void updateSpatialIndexCellSize();
+
+		///
+		/// \brief Switches the index of the QGraphicsScene off while Node%s are dragged with the SpatialIndex enabled and
+		/// back on otherwise.
+		///
+		/// An open batch restores the index method when it ends, see endBatch().
+		///
+		void updateItemIndexMethod();
+
 	private: // members
 
 		///
@@ -185,28 +846,168 @@ namespace zodiac
 		DrawEdge *m_drawEdge;
 
 		///
-		/// \brief All Node instances in the graph.
+		/// \brief Semantic zoom layer, owned by the Scene through Qt's parent-child mechanism.
 		///
-		QSet<Node *> m_nodes;
+		ClusterLayer *m_clusterLayer;
+
+		///
+		/// \brief Viewport virtualization layer, owned by the Scene through Qt's parent-child mechanism.
+		///
+		ViewportLayer *m_viewportLayer;
+
+		///
+		/// \brief Batched renderer of the StraightEdge%s, only a child of the Scene while it is batching.
+		///
+		StraightEdgeLayer *m_straightEdgeLayer;
+
+		///
+		/// \brief How often every detached item was detached, see detachNode().
+		///
+		FlatHashMap<QGraphicsItem *, int> m_detachCounts;
 
 		///
 		/// \brief All PlugEdge instances in the graph.
 		///
-		QHash<QPair<Plug *, Plug *>, PlugEdge *> m_edges;
+		FlatHashMap<QPair<Plug *, Plug *>, PlugEdge *> m_edges;
 
 		///
 		/// \brief All EdgeGroup instances of the scene.
 		///
-		/// EdgeGroup instances are stored in a hashmap with a hash value generated from EdgeGroup::getHashOf() as key.
+		/// EdgeGroup instances are stored in a flat hashmap with the directed pair of Node%s returned by
+		/// EdgeGroup::getKeyOf() as key.
 		/// This way we can easily find the EdgeGroup for a directed connection between to Node%s in the graph.
 		///
-		QHash<uint, EdgeGroup *> m_edgeGroups;
+		FlatHashMap<QPair<Node *, Node *>, EdgeGroup *> m_edgeGroups;
 
 		///
 		/// \brief All EdgeGroupPair%s owned by the scene.
 		///
 		QSet<EdgeGroupPair *> m_edgeGroupPairs;
 
+		///
+		/// \brief Number of currently open batches, see beginBatch().
+		///
+		int m_batchDepth;
+
+		///
+		/// \brief Index method of the QGraphicsScene before the outermost batch was opened.
+		///
+		ItemIndexMethod m_indexMethodBeforeBatch;
+
+		///
+		/// \brief Node%s whose style update was deferred by the current batch.
+		///
+		QSet<Node *> m_deferredNodes;
+
+
+		///
+		/// \brief Edges whose geometry is rebuilt in the next call to flushDirtyEdges().
+		///
+		QSet<BaseEdge *> m_dirtyEdges;
+
+		///
+		/// \brief Node grabbed by the mouse in the current Node drag, is <i>nullptr</i> if there is none.
+		///
+		Node *m_dragAnchor;
+
+		///
+		/// \brief Position of the drag anchor when the current Node drag was started.
+		///
+		QPointF m_dragStartPos;
+
+		///
+		/// \brief Edges between two dragged Node%s that are translated with the current drag.
+		///
+		QSet<BaseEdge *> m_rigidEdges;
+
+		///
+		/// \brief Edges with a single dragged Node that are rebuilt with every step of the current drag.
+		///
+		QSet<BaseEdge *> m_boundaryEdges;
+
+		///
+		/// \brief Hierarchical grid of Node%s and edges, answers item queries if enabled.
+		///
+		SpatialIndex m_spatialIndex;
+
+		///
+		/// \brief Pre-rasterized discs of the Node cores and Perimeter%s.
+		///
+		SpriteAtlas m_spriteAtlas;
+
+		///
+		/// \brief Device pixmaps of the Plug%s and labels.
+		///
+		ItemCache m_itemCache;
+
+		///
+		/// \brief Shaped texts of the NodeLabel%s and PlugLabel%s.
+		///
+		TextLayoutCache m_textLayoutCache;
+
+		///
+		/// \brief Outlines of the Plug%s.
+		///
+		PlugArcCache m_plugArcCache;
+
+		///
+		/// \brief Interned names of the Plug%s.
+		///
+		NameTable m_nameTable;
+
+		///
+		/// \brief Whether item queries are answered by the SpatialIndex.
+		///
+		bool m_isSpatialIndexEnabled;
+
+		///
+		/// \brief Items that are updated in the SpatialIndex with the next query.
+		///
+		QSet<QGraphicsItem *> m_dirtyIndexItems;
+
+		///
+		/// \brief Node%s that have moved since the arrangements of their neighbours were last invalidated.
+		///
+		QSet<Node *> m_movedNodes;
+
+		///
+		/// \brief Selected Node%s in the order of their selection.
+		///
+		/// Deselected Node%s leave a <i>nullptr</i> hole to keep the order, holes are removed the next time the
+		/// selection is read.
+		///
+		QVector<Node *> m_selectedNodes;
+
+		///
+		/// \brief Position of every selected Node in m_selectedNodes.
+		///
+		FlatHashMap<Node *, int> m_selectionPositions;
+
+		///
+		/// \brief Number of holes in m_selectedNodes.
+		///
+		int m_selectionHoleCount;
+
+		///
+		/// \brief Headless store of the graph's topology and geometry.
+		///
+		GraphStore m_graph;
+
+		///
+		/// \brief All Node instances in the graph, at the slot index of their id in the GraphStore.
+		///
+		QVector<Node *> m_nodeViews;
+
+		///
+		/// \brief All Plug instances in the graph, at the slot index of their id in the GraphStore.
+		///
+		QVector<Plug *> m_plugViews;
+
+		///
+		/// \brief All PlugEdge instances in the graph, at the slot index of their id in the GraphStore.
+		///
+		QVector<PlugEdge *> m_edgeViews;
+
 	};
 
 } // namespace zodiac
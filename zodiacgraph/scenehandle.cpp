@@ -1,7 +1,12 @@
 #include "scenehandle.h"
 
+#include "clusterlayer.h"
 #include "node.h"
+#include "plug.h"
+#include "plugedge.h"
 #include "scene.h"
+#include "straightedgelayer.h"
+#include "viewportlayer.h"
 
 namespace zodiac
 {
@@ -57,6 +62,63 @@ namespace zodiac
 		return result;
 	}
 
+	void SceneHandle::removeNodes(const QList<NodeHandle> &nodes)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		QList<Node *> sceneNodes;
+		sceneNodes.reserve(nodes.size());
+		for (const NodeHandle &node: nodes)
+		{
+			if (node.isValid())
+			{
+				sceneNodes.append(node.data());
+			}
+		}
+		m_scene->removeNodes(sceneNodes);
+	}
+
+	void SceneHandle::disconnectPlugs(const QList<PlugHandle> &plugs)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		// collect every edge exactly once, even if both of its plugs are given
+		QSet<PlugEdge *> edges;
+		for (const PlugHandle &plug: plugs)
+		{
+			if (!plug.isValid())
+			{
+				continue;
+			}
+			for (Plug *otherPlug: plug.data()->getConnectedPlugs())
+			{
+				PlugEdge *edge;
+				if (plug.data()->getDirection() == PlugDirection::OUT)
+				{
+					edge = m_scene->getEdge(plug.data(), otherPlug);
+				} else
+				{
+					edge = m_scene->getEdge(otherPlug, plug.data());
+				}
+				Q_ASSERT(edge);
+				edges.insert(edge);
+			}
+		}
+		m_scene->removeEdges(edges.values());
+	}
+
 	void SceneHandle::deselectAll() const
 	{
 #ifdef QT_DEBUG
@@ -67,10 +129,138 @@ namespace zodiac
 			return;
 		}
 #endif
-		for (QGraphicsItem *item: m_scene->selectedItems())
+		m_scene->deselectAllNodes();
+	}
+
+	void SceneHandle::beginBatch()
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
 		{
-			item->setSelected(false);
+			return;
+		}
+#endif
+		m_scene->beginBatch();
+	}
+
+	void SceneHandle::endBatch()
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		m_scene->endBatch();
+	}
+
+	void SceneHandle::arrangeAllPlugs()
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
 		}
+#endif
+		m_scene->arrangeAllPlugs();
+	}
+
+	void SceneHandle::setNodeCluster(const NodeHandle &node, const QString &cluster)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+		Q_ASSERT(node.isValid());
+#else
+		if (!m_isValid || !node.isValid())
+		{
+			return;
+		}
+#endif
+		m_scene->getClusterLayer()->setNodeCluster(node.data(), cluster);
+	}
+
+	void SceneHandle::setDetectingClusters(bool enabled)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		m_scene->getClusterLayer()->setDetectingClusters(enabled);
+	}
+
+	void SceneHandle::setVirtualizationEnabled(bool enabled)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		m_scene->getViewportLayer()->setEnabled(enabled);
+	}
+
+	void SceneHandle::setSpatialIndexEnabled(bool enabled)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		m_scene->setSpatialIndexEnabled(enabled);
+	}
+
+	void SceneHandle::setBatchingStraightEdges(bool batching)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		m_scene->getStraightEdgeLayer()->setBatching(batching);
+	}
+
+	void SceneHandle::setItemCacheBudget(qint64 bytes)
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return;
+		}
+#endif
+		m_scene->getItemCache().setBudget(bytes);
+	}
+
+	ItemCache::Statistics SceneHandle::getItemCacheStatistics() const
+	{
+#ifdef QT_DEBUG
+		Q_ASSERT(m_isValid);
+#else
+		if (!m_isValid)
+		{
+			return ItemCache::Statistics{0, 0, 0, 0, 0, 0};
+		}
+#endif
+		return m_scene->getItemCache().getStatistics();
 	}
 
 	void SceneHandle::connectSignals()
@@ -81,25 +271,52 @@ namespace zodiac
 		}
 		connect(m_scene, SIGNAL(destroyed()), this, SLOT(sceneWasDestroyed()));
 		connect(m_scene, SIGNAL(selectionChanged()), this, SLOT(updateSelection()));
+		connect(m_scene, SIGNAL(elementsRemoved(const QList<QPair<Plug *, Plug *> > &, const QList<QUuid> &)),
+		        this, SLOT(passElementsRemoved(const QList<QPair<Plug *, Plug *> > &, const QList<QUuid> &)));
 	}
 
 	void SceneHandle::updateSelection()
 	{
 		QList<NodeHandle> selection;
-		for (QGraphicsItem *item: m_scene->selectedItems())
+		const QVector<Node *> &selectedNodes = m_scene->getSelectedNodes();
+		selection.reserve(selectedNodes.size());
+		for (Node *selectedNode: selectedNodes)
 		{
-			Node *selectedNode = qobject_cast<Node *>(item->toGraphicsObject());
-			if (selectedNode)
-			{
-				selection.append(NodeHandle(selectedNode));
-			}
+			selection.append(NodeHandle(selectedNode));
 		}
 		emit selectionChanged(selection);
 	}
 
+	void SceneHandle::passElementsRemoved(const QList<QPair<Plug *, Plug *> > &connections, const QList<QUuid> &nodes)
+	{
+		QList<QPair<PlugHandle, PlugHandle> > connectionHandles;
+		connectionHandles.reserve(connections.size());
+		for (const QPair<Plug *, Plug *> &connection: connections)
+		{
+			connectionHandles.append(QPair<PlugHandle, PlugHandle>(PlugHandle(connection.first),
+			                                                       PlugHandle(connection.second)));
+		}
+		emit elementsRemoved(connectionHandles, nodes);
+	}
+
 	void SceneHandle::sceneWasDestroyed()
 	{
 		m_isValid = false;
 	}
 
+	SceneBatch::SceneBatch(const SceneHandle &scene)
+			: m_scene(scene)
+	{
+		m_scene.beginBatch();
+	}
+
+	SceneBatch::~SceneBatch()
+	{
+		// the scene might have been destroyed while the batch was open
+		if (m_scene.isValid())
+		{
+			m_scene.endBatch();
+		}
+	}
+
 } // namespace zodiac
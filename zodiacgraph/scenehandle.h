@@ -36,11 +36,14 @@
 #include <QUuid>
 #include <QtGlobal>
 
+#include "itemcache.h"
 #include "nodehandle.h"
 
 namespace zodiac
 {
 
+	class Plug;
+
 	class PlugHandle;
 
 	class Scene;
@@ -140,11 +143,106 @@ namespace zodiac
 		///
 		QList<NodeHandle> getNodes() const;
 
+		///
+		/// \brief Removes many Node%s from the Scene at once, including all of their connections.
+		///
+		/// Much faster than disconnecting and removing each Node on its own.
+		/// Does not emit the disconnection signals of the individual NodeHandle%s, but a single elementsRemoved() signal
+		/// instead.
+		///
+		/// \param [in] nodes   Handles of the Node%s to remove, are invalid afterwards.
+		///
+		void removeNodes(const QList<NodeHandle> &nodes);
+
+		///
+		/// \brief Removes all connections of many Plug%s at once.
+		///
+		/// Much faster than calling PlugHandle::disconnectAll() on each Plug.
+		/// Does not emit the disconnection signals of the individual NodeHandle%s, but a single elementsRemoved() signal
+		/// instead.
+		///
+		/// \param [in] plugs   Handles of the Plug%s to disconnect.
+		///
+		void disconnectPlugs(const QList<PlugHandle> &plugs);
+
 		///
 		/// \brief Clears the selection of the Scene.
 		///
 		void deselectAll() const;
 
+		///
+		/// \brief Opens a batch of structural changes to the Scene.
+		///
+		/// Use this when creating or removing many Node%s, Plug%s or connections at once.
+		/// Instead of updating after each change, the affected Node%s and labels are updated once, when the batch
+		/// is closed.
+		/// See SceneBatch for a RAII guard that closes the batch automatically.
+		///
+		void beginBatch();
+
+		///
+		/// \brief Closes a batch of structural changes opened with beginBatch().
+		///
+		void endBatch();
+
+		///
+		/// \brief Arranges the Plug%s of all Node%s in parallel, after they have been loaded or moved in bulk.
+		///
+		/// See Scene::arrangeAllPlugs() for details.
+		///
+		void arrangeAllPlugs();
+
+		///
+		/// \brief Assigns a Node to a cluster that is collapsed into a single aggregate when the View is zoomed out.
+		///
+		/// \param [in] node    Node to assign.
+		/// \param [in] cluster Name of the cluster, pass an empty string to remove the assignment.
+		///
+		void setNodeCluster(const NodeHandle &node, const QString &cluster);
+
+		///
+		/// \brief Enables or disables the automatic detection of clusters among the Node%s without a cluster.
+		///
+		/// \param [in] enabled <i>true</i> to detect clusters -- <i>false</i> to only collapse assigned clusters.
+		///
+		void setDetectingClusters(bool enabled);
+
+		///
+		/// \brief Enables or disables the removal of items far outside the visible area of the View from the Scene.
+		///
+		/// \param [in] enabled <i>true</i> to only keep items close to the visible area in the Scene.
+		///
+		void setVirtualizationEnabled(bool enabled);
+
+		///
+		/// \brief Enables or disables the grid index of the Scene that answers item queries and stands in for the BSP
+		/// tree of Qt while nodes are dragged.
+		///
+		/// \param [in] enabled <i>true</i> to use the grid index -- <i>false</i> to use the BSP tree only.
+		///
+		void setSpatialIndexEnabled(bool enabled);
+
+		///
+		/// \brief Enables or disables drawing all collapsed straight edges in a single item.
+		///
+		/// \param [in] batching    <i>true</i> to batch the straight edges -- <i>false</i> to draw each one by itself.
+		///
+		void setBatchingStraightEdges(bool batching);
+
+		///
+		/// \brief Sets the memory budget of the cache holding the pixmaps of all Plug%s and labels in the Scene.
+		///
+		/// \param [in] bytes   New budget in bytes.
+		///
+		void setItemCacheBudget(qint64 bytes);
+
+		///
+		/// \brief Memory use, hits, misses and re-rasters of the cache holding the pixmaps of the Scene.
+		///
+		/// \return Counters of the ItemCache.
+		///
+		ItemCache::Statistics getItemCacheStatistics() const;
+
 	signals:
 
 		///
@@ -154,6 +252,14 @@ namespace zodiac
 		///
 		void selectionChanged(QList<zodiac::NodeHandle> selection);
 
+		///
+		/// \brief Emitted once after many connections and / or Node%s were removed at once.
+		///
+		/// \param [out] connections    Output and input Plug of every removed connection.
+		/// \param [out] nodes          Unique ids of all removed Node%s.
+		///
+		void elementsRemoved(QList<QPair<zodiac::PlugHandle, zodiac::PlugHandle> > connections, QList<QUuid> nodes);
+
 	private: // methods
 
 		///
@@ -168,6 +274,14 @@ namespace zodiac
 		///
 		void updateSelection();
 
+		///
+		/// \brief Passes the 'elementsRemoved'-signal from the managed Scene.
+		///
+		/// \param [in] connections Start and end Plug of every removed PlugEdge.
+		/// \param [in] nodes       Unique ids of all removed Node%s.
+		///
+		void passElementsRemoved(const QList<QPair<Plug *, Plug *> > &connections, const QList<QUuid> &nodes);
+
 		///
 		/// \brief Called, when the mangaged Scene was destroyed.
 		///
@@ -186,6 +300,47 @@ namespace zodiac
 		bool m_isValid;
 	};
 
+///
+/// \brief RAII guard for a batch of structural changes to a Scene.
+///
+/// Opens a batch on the Scene when constructed and closes it again when destroyed.
+///
+/// \code
+/// {
+///     zodiac::SceneBatch batch(sceneHandle);
+///     // create many nodes, plugs and connections ...
+/// } // all nodes are arranged and labelled once here
+/// \endcode
+///
+	class Q_DECL_EXPORT SceneBatch
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] scene   Handle of the Scene to open a batch on.
+		///
+		explicit SceneBatch(const SceneHandle &scene);
+
+		///
+		/// \brief Destructor.
+		///
+		~SceneBatch();
+
+	private: // members
+
+		///
+		/// \brief Handle of the Scene with the open batch.
+		///
+		SceneHandle m_scene;
+
+	private:
+
+		Q_DISABLE_COPY(SceneBatch)
+	};
+
 } // namespace zodiac
 
 ///
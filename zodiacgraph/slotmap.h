@@ -0,0 +1,314 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_SLOTMAP_H
+#define ZODIAC_SLOTMAP_H
+
+///
+/// \file slotmap.h
+///
+/// \brief Contains the definition of the zodiac::SlotId and zodiac::SlotIndex classes.
+///
+
+#include <QHash>
+#include <QVector>
+#include <QtGlobal>
+
+namespace zodiac
+{
+
+///
+/// \brief Generation-checked identifier of an element in a SlotIndex.
+///
+/// A SlotId stays valid for as long as the element it identifies exists.
+/// Once the element is removed, its slot may be reused by another element, but with a new generation, so that a stale
+/// SlotId can never accidentally refer to the new element.
+///
+/// A default constructed SlotId is null and never refers to any element.
+///
+	struct Q_DECL_EXPORT SlotId
+	{
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] index       Index of the slot.
+		/// \param [in] generation  Generation of the slot.
+		///
+		SlotId(quint32 index = 0, quint32 generation = 0)
+				: index(index), generation(generation) {}
+
+		///
+		/// \brief Tests whether this is a null SlotId.
+		///
+		/// \return <i>true</i> if the SlotId does not refer to any element -- <i>false</i> otherwise.
+		///
+		inline bool isNull() const { return generation == 0; }
+
+		///
+		/// \brief Equality operator.
+		///
+		/// \param [in] other   Other SlotId to compare to.
+		///
+		/// \return             <i>true</i> if both SlotId%s are equal -- <i>false</i> otherwise.
+		///
+		inline bool operator==(const SlotId &other) const { return (index == other.index) && (generation == other.generation); }
+
+		///
+		/// \brief Inequality operator.
+		///
+		/// \param [in] other   Other SlotId to compare to.
+		///
+		/// \return             <i>true</i> if both SlotId%s differ -- <i>false</i> otherwise.
+		///
+		inline bool operator!=(const SlotId &other) const { return !(*this == other); }
+
+		///
+		/// \brief Index of the slot, stable for the lifetime of the identified element.
+		///
+		quint32 index;
+
+		///
+		/// \brief Generation of the slot, is never 0 for a valid SlotId.
+		///
+		quint32 generation;
+	};
+
+///
+/// \brief Allocates SlotId%s for elements stored in densely packed arrays.
+///
+/// The SlotIndex maps each SlotId to the position of its element in one or more dense arrays managed by the user.
+/// Insertion, removal and lookup are all O(1).
+/// When an element is removed, the last element in the dense arrays takes its place, which keeps the arrays packed for
+/// fast iteration.
+///
+/// \code
+/// SlotId id = index.insert();         // the new element is at dense position index.size() - 1
+/// values.append(value);
+/// ...
+/// int position = index.remove(id);    // the last element moves into the freed position
+/// values[position] = values.last();
+/// values.removeLast();
+/// \endcode
+///
+	class Q_DECL_EXPORT SlotIndex
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		SlotIndex()
+				: m_slotPositions(QVector<quint32>()), m_slotGenerations(QVector<quint32>()),
+				  m_positionSlots(QVector<quint32>()), m_freeSlot(NO_SLOT) {}
+
+		///
+		/// \brief Allocates a SlotId for a new element appended to the end of the dense arrays.
+		///
+		/// \return New SlotId.
+		///
+		SlotId insert()
+		{
+			quint32 position = quint32(m_positionSlots.size());
+			quint32 slot;
+			if (m_freeSlot != NO_SLOT)
+			{
+				// reuse a free slot, the free list is threaded through the positions of free slots
+				slot = m_freeSlot;
+				m_freeSlot = m_slotPositions.at(int(slot));
+				m_slotPositions[int(slot)] = position;
+			} else
+			{
+				slot = quint32(m_slotPositions.size());
+				m_slotPositions.append(position);
+				m_slotGenerations.append(1);
+			}
+			m_positionSlots.append(slot);
+			return SlotId(slot, m_slotGenerations.at(int(slot)));
+		}
+
+		///
+		/// \brief Frees the SlotId of an element.
+		///
+		/// The caller must then move the last element of the dense arrays into the returned position and remove the last
+		/// element from the arrays.
+		///
+		/// \param [in] id  SlotId to free.
+		///
+		/// \return         Dense position of the removed element or -1, if the SlotId was not valid.
+		///
+		int remove(const SlotId &id)
+		{
+			int position = indexOf(id);
+			if (position < 0)
+			{
+				return -1;
+			}
+
+			// the last element moves into the freed position
+			quint32 lastSlot = m_positionSlots.last();
+			m_positionSlots[position] = lastSlot;
+			m_slotPositions[int(lastSlot)] = quint32(position);
+			m_positionSlots.removeLast();
+
+			// invalidate all existing ids of the slot and add it to the free list
+			quint32 &generation = m_slotGenerations[int(id.index)];
+			generation = (generation == MAX_GENERATION) ? 1 : generation + 1;
+			m_slotPositions[int(id.index)] = m_freeSlot;
+			m_freeSlot = id.index;
+
+			return position;
+		}
+
+		///
+		/// \brief Dense position of an element.
+		///
+		/// \param [in] id  SlotId of the element.
+		///
+		/// \return         Dense position of the element, or -1 if the SlotId is null or stale.
+		///
+		inline int indexOf(const SlotId &id) const
+		{
+			return ((id.index < quint32(m_slotGenerations.size())) && (m_slotGenerations.at(int(id.index)) == id.generation))
+			       ? int(m_slotPositions.at(int(id.index))) : -1;
+		}
+
+		///
+		/// \brief Tests whether a SlotId refers to an existing element.
+		///
+		/// \param [in] id  SlotId to test.
+		///
+		/// \return         <i>true</i> if the element exists -- <i>false</i> otherwise.
+		///
+		inline bool contains(const SlotId &id) const { return indexOf(id) >= 0; }
+
+		///
+		/// \brief SlotId of the element at a given dense position.
+		///
+		/// \param [in] position    Dense position in the range [0, size()).
+		///
+		/// \return                 SlotId of the element.
+		///
+		inline SlotId idAt(int position) const
+		{
+			quint32 slot = m_positionSlots.at(position);
+			return SlotId(slot, m_slotGenerations.at(int(slot)));
+		}
+
+		///
+		/// \brief Number of elements.
+		///
+		/// \return Number of elements.
+		///
+		inline int size() const { return m_positionSlots.size(); }
+
+		///
+		/// \brief Number of slots ever allocated, every SlotId::index is smaller than this.
+		///
+		/// \return Number of slots.
+		///
+		inline int getSlotCount() const { return m_slotGenerations.size(); }
+
+		///
+		/// \brief Reserves memory for the given number of elements.
+		///
+		/// \param [in] count   Number of elements.
+		///
+		void reserve(int count)
+		{
+			m_slotPositions.reserve(count);
+			m_slotGenerations.reserve(count);
+			m_positionSlots.reserve(count);
+		}
+
+		///
+		/// \brief Removes all elements, invalidating all existing SlotId%s.
+		///
+		void clear()
+		{
+			// keep the generations, so that old ids stay invalid
+			m_positionSlots.clear();
+			m_freeSlot = NO_SLOT;
+			for (int slot = m_slotGenerations.size() - 1; slot >= 0; --slot)
+			{
+				quint32 &generation = m_slotGenerations[slot];
+				generation = (generation == MAX_GENERATION) ? 1 : generation + 1;
+				m_slotPositions[slot] = m_freeSlot;
+				m_freeSlot = quint32(slot);
+			}
+		}
+
+	private: // static members
+
+		///
+		/// \brief Marks the end of the free list.
+		///
+		static const quint32 NO_SLOT = 0xffffffff;
+
+		///
+		/// \brief The highest generation before wrapping back to 1.
+		///
+		static const quint32 MAX_GENERATION = 0xffffffff;
+
+	private: // members
+
+		///
+		/// \brief Dense position of each used slot, or the next free slot for each free one.
+		///
+		QVector<quint32> m_slotPositions;
+
+		///
+		/// \brief Current generation of each slot.
+		///
+		QVector<quint32> m_slotGenerations;
+
+		///
+		/// \brief Slot of each dense position.
+		///
+		QVector<quint32> m_positionSlots;
+
+		///
+		/// \brief Head of the free list.
+		///
+		quint32 m_freeSlot;
+	};
+
+///
+/// \brief Returns the hash of a SlotId.
+///
+/// Is declared in the namespace of SlotId, so QHash and QSet find it through argument-dependent lookup.
+///
+/// \param [in] key SlotId to hash.
+///
+/// \return         Hash of the SlotId.
+///
+	inline uint qHash(const SlotId &key)
+	{
+		return ::qHash((quint64(key.generation) << 32) | quint64(key.index));
+	}
+
+} // namespace zodiac
+
+#endif // ZODIAC_SLOTMAP_H
@@ -0,0 +1,234 @@
+#include "spatialindex.h"
+
+#include <cmath>
+
+namespace zodiac
+{
+
+	SpatialIndex::SpatialIndex(qreal cellSize)
+			: m_cellSize(qMax(1., cellSize)), m_items(FlatHashMap<QGraphicsItem *, Entry>()),
+			  m_levels(QVector<QHash<quint64, QVector<QGraphicsItem *>>>()), m_bounds(QRectF()), m_isBoundsDirty(false)
+	{
+	}
+
+	void SpatialIndex::setCellSize(qreal cellSize)
+	{
+		cellSize = qMax(1., cellSize);
+		if (qFuzzyCompare(cellSize, m_cellSize))
+		{
+			return;
+		}
+		m_cellSize = cellSize;
+
+		// sort all items into the new grids
+		QList<Entry> entries = m_items.values();
+		clear();
+		for (const Entry &entry: entries)
+		{
+			insert(entry.item, entry.rect);
+		}
+	}
+
+	void SpatialIndex::insert(QGraphicsItem *item, const QRectF &rect)
+	{
+		int level = getLevelOf(rect);
+		QRect cells = getCellsOf(rect, level);
+
+		// only touch the grids if the item moved into other cells
+		if (m_items.contains(item))
+		{
+			Entry oldEntry = m_items.value(item);
+			if ((oldEntry.level != level) || (oldEntry.cells != cells))
+			{
+				removeFromCells(item, oldEntry.level, oldEntry.cells);
+				addToCells(item, level, cells);
+			}
+			if (touchesBounds(oldEntry.rect))
+			{
+				m_isBoundsDirty = true;
+			}
+		} else
+		{
+			addToCells(item, level, cells);
+		}
+		m_items.insert(item, Entry{item, rect, level, cells});
+
+		// growing the bounds is cheap, shrinking them is left to getBounds()
+		if (!m_isBoundsDirty)
+		{
+			m_bounds = m_bounds.united(rect.normalized());
+		}
+	}
+
+	void SpatialIndex::remove(QGraphicsItem *item)
+	{
+		if (!m_items.contains(item))
+		{
+			return;
+		}
+		Entry entry = m_items.value(item);
+		removeFromCells(item, entry.level, entry.cells);
+		m_items.remove(item);
+		if (touchesBounds(entry.rect))
+		{
+			m_isBoundsDirty = true;
+		}
+	}
+
+	void SpatialIndex::clear()
+	{
+		m_items.clear();
+		m_levels.clear();
+		m_bounds = QRectF();
+		m_isBoundsDirty = false;
+	}
+
+	QRectF SpatialIndex::getBounds() const
+	{
+		if (m_isBoundsDirty)
+		{
+			m_bounds = QRectF();
+			for (const Entry &entry: m_items.values())
+			{
+				m_bounds = m_bounds.united(entry.rect.normalized());
+			}
+			m_isBoundsDirty = false;
+		}
+		return m_bounds;
+	}
+
+	QVector<QGraphicsItem *> SpatialIndex::query(const QPointF &pos) const
+	{
+		QVector<QGraphicsItem *> result;
+		for (int level = 0; level < m_levels.size(); ++level)
+		{
+			const QHash<quint64, QVector<QGraphicsItem *>> &cells = m_levels.at(level);
+			if (cells.isEmpty())
+			{
+				continue;
+			}
+			QRect cell = getCellsOf(QRectF(pos, pos), level);
+			for (QGraphicsItem *item: cells.value(getCellKey(cell.left(), cell.top())))
+			{
+				if (m_items.value(item).rect.contains(pos))
+				{
+					result.append(item);
+				}
+			}
+		}
+		return result;
+	}
+
+	QVector<QGraphicsItem *> SpatialIndex::query(const QRectF &rect) const
+	{
+		QVector<QGraphicsItem *> result;
+		for (int level = 0; level < m_levels.size(); ++level)
+		{
+			const QHash<quint64, QVector<QGraphicsItem *>> &cells = m_levels.at(level);
+			if (cells.isEmpty())
+			{
+				continue;
+			}
+
+			// an item covering several cells is only reported in the first cell that it shares with the query
+			QRect range = getCellsOf(rect, level);
+			auto collect = [&](int x, int y, const QVector<QGraphicsItem *> &cellItems) {
+				for (QGraphicsItem *item: cellItems)
+				{
+					Entry entry = m_items.value(item);
+					if ((x != qMax(entry.cells.left(), range.left())) || (y != qMax(entry.cells.top(), range.top())))
+					{
+						continue;
+					}
+					if (entry.rect.intersects(rect))
+					{
+						result.append(item);
+					}
+				}
+			};
+
+			// a large query only visits the occupied cells instead of every cell in range
+			if (qint64(range.width()) * qint64(range.height()) > cells.size())
+			{
+				for (auto it = cells.constBegin(); it != cells.constEnd(); ++it)
+				{
+					QPoint cell = getCellCoordinates(it.key());
+					if (range.contains(cell))
+					{
+						collect(cell.x(), cell.y(), it.value());
+					}
+				}
+				continue;
+			}
+			for (int y = range.top(); y <= range.bottom(); ++y)
+			{
+				for (int x = range.left(); x <= range.right(); ++x)
+				{
+					auto it = cells.constFind(getCellKey(x, y));
+					if (it != cells.constEnd())
+					{
+						collect(x, y, it.value());
+					}
+				}
+			}
+		}
+		return result;
+	}
+
+	int SpatialIndex::getLevelOf(const QRectF &rect) const
+	{
+		qreal extent = qMax(qAbs(rect.width()), qAbs(rect.height()));
+		int level = 0;
+		for (qreal cellSize = m_cellSize; cellSize < extent; cellSize *= 2.)
+		{
+			++level;
+		}
+		return level;
+	}
+
+	QRect SpatialIndex::getCellsOf(const QRectF &rect, int level) const
+	{
+		qreal cellSize = std::ldexp(m_cellSize, level);
+		QRectF normalized = rect.normalized();
+		return QRect(QPoint(int(std::floor(normalized.left() / cellSize)), int(std::floor(normalized.top() / cellSize))),
+		             QPoint(int(std::floor(normalized.right() / cellSize)), int(std::floor(normalized.bottom() / cellSize))));
+	}
+
+	void SpatialIndex::addToCells(QGraphicsItem *item, int level, const QRect &cells)
+	{
+		if (level >= m_levels.size())
+		{
+			m_levels.resize(level + 1);
+		}
+		QHash<quint64, QVector<QGraphicsItem *>> &levelCells = m_levels[level];
+		for (int y = cells.top(); y <= cells.bottom(); ++y)
+		{
+			for (int x = cells.left(); x <= cells.right(); ++x)
+			{
+				levelCells[getCellKey(x, y)].append(item);
+			}
+		}
+	}
+
+	void SpatialIndex::removeFromCells(QGraphicsItem *item, int level, const QRect &cells)
+	{
+		QHash<quint64, QVector<QGraphicsItem *>> &levelCells = m_levels[level];
+		for (int y = cells.top(); y <= cells.bottom(); ++y)
+		{
+			for (int x = cells.left(); x <= cells.right(); ++x)
+			{
+				QHash<quint64, QVector<QGraphicsItem *>>::iterator cell = levelCells.find(getCellKey(x, y));
+				if (cell == levelCells.end())
+				{
+					continue;
+				}
+				cell->removeOne(item);
+				if (cell->isEmpty())
+				{
+					levelCells.erase(cell);
+				}
+			}
+		}
+	}
+
+} // namespace zodiac
@@ -0,0 +1,283 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_SPATIALINDEX_H
+#define ZODIAC_SPATIALINDEX_H
+
+///
+/// \file spatialindex.h
+///
+/// \brief Contains the definition of the zodiac::SpatialIndex class.
+///
+
+#include <QHash>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QVector>
+#include <QtGlobal>
+
+#include "flathashmap.h"
+
+class QGraphicsItem;
+
+namespace zodiac
+{
+
+///
+/// \brief A hierarchy of uniform grids over the scene, mapping rectangles to the QGraphicsItem%s that cover them.
+///
+/// Unlike the BSP tree of the QGraphicsScene, moving an item only touches the few grid cells it leaves and enters, no
+/// matter how many other items there are, so it stays cheap when thousands of edges move at once.
+///
+/// Every level of the hierarchy doubles the cell size of the level below, starting with getCellSize() at level 0.
+/// Each item is sorted into the lowest level whose cells are at least as large as the item, so it covers no more than
+/// four cells there -- long edges just end up on a higher level with few, large cells.
+/// The grids work best, if the base cell size is about the size of the typical item.
+///
+/// The index only knows about rectangles, queries return all items whose rectangle intersects the query in no
+/// particular order, to be tested against the exact shape by the caller.
+///
+	class Q_DECL_EXPORT SpatialIndex
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] cellSize    Width and height of a grid cell in scene coordinates.
+		///
+		explicit SpatialIndex(qreal cellSize = 64.);
+
+		///
+		/// \brief Changes the size of the grid cells and sorts all items into the new grid.
+		///
+		/// \param [in] cellSize    Width and height of a grid cell in scene coordinates.
+		///
+		void setCellSize(qreal cellSize);
+
+		///
+		/// \brief The size of the grid cells.
+		///
+		/// \return Width and height of a grid cell in scene coordinates.
+		///
+		inline qreal getCellSize() const { return m_cellSize; }
+
+		///
+		/// \brief Number of items in the index.
+		///
+		/// \return Number of items.
+		///
+		inline int size() const { return m_items.size(); }
+
+		///
+		/// \brief Adds an item to the index or moves it, if it is already indexed.
+		///
+		/// \param [in] item    Item to add.
+		/// \param [in] rect    Rectangle covered by the item, in scene coordinates.
+		///
+		void insert(QGraphicsItem *item, const QRectF &rect);
+
+		///
+		/// \brief Removes an item from the index.
+		///
+		/// \param [in] item    Item to remove, unknown items are ignored.
+		///
+		void remove(QGraphicsItem *item);
+
+		///
+		/// \brief Checks if an item is in the index.
+		///
+		/// \param [in] item    Item to test.
+		///
+		/// \return             <i>true</i> if the item is indexed -- <i>false</i> otherwise.
+		///
+		inline bool contains(QGraphicsItem *item) const { return m_items.contains(item); }
+
+		///
+		/// \brief The rectangle around all indexed items.
+		///
+		/// Grows with every inserted item, but is only recalculated from all items after an item on its boundary has
+		/// moved or was removed.
+		///
+		/// \return Bounds of all items in scene coordinates, null if the index is empty.
+		///
+		QRectF getBounds() const;
+
+		///
+		/// \brief Removes all items from the index.
+		///
+		void clear();
+
+		///
+		/// \brief All items whose rectangle contains the given point.
+		///
+		/// \param [in] pos Point in scene coordinates.
+		///
+		/// \return         Items covering the point.
+		///
+		QVector<QGraphicsItem *> query(const QPointF &pos) const;
+
+		///
+		/// \brief All items whose rectangle intersects the given rectangle.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Items intersecting the rectangle, each one only once.
+		///
+		QVector<QGraphicsItem *> query(const QRectF &rect) const;
+
+	private: // methods
+
+		///
+		/// \brief The lowest level of the hierarchy whose cells are at least as large as a rectangle.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Level of the rectangle.
+		///
+		int getLevelOf(const QRectF &rect) const;
+
+		///
+		/// \brief The range of grid cells on a level covered by a rectangle.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		/// \param [in] level   Level of the grid.
+		///
+		/// \return             Inclusive range of cell coordinates.
+		///
+		QRect getCellsOf(const QRectF &rect, int level) const;
+
+		///
+		/// \brief Combines the two coordinates of a cell into a single key.
+		///
+		/// \param [in] x   Horizontal cell coordinate.
+		/// \param [in] y   Vertical cell coordinate.
+		///
+		/// \return         Key of the cell.
+		///
+		static inline quint64 getCellKey(int x, int y) { return (quint64(quint32(x)) << 32) | quint64(quint32(y)); }
+
+		///
+		/// \brief Splits the key of a cell into its two coordinates.
+		///
+		/// \param [in] key Key of the cell.
+		///
+		/// \return         Coordinates of the cell.
+		///
+		static inline QPoint getCellCoordinates(quint64 key) { return QPoint(int(quint32(key >> 32)), int(quint32(key))); }
+
+		///
+		/// \brief Sorts an item into the cells of a grid.
+		///
+		/// \param [in] item    Item to sort in.
+		/// \param [in] level   Level of the grid.
+		/// \param [in] cells   Range of cells covered by the item on that level.
+		///
+		void addToCells(QGraphicsItem *item, int level, const QRect &cells);
+
+		///
+		/// \brief Removes an item from the cells of a grid.
+		///
+		/// \param [in] item    Item to remove.
+		/// \param [in] level   Level of the grid.
+		/// \param [in] cells   Range of cells covered by the item on that level.
+		///
+		void removeFromCells(QGraphicsItem *item, int level, const QRect &cells);
+
+		///
+		/// \brief Checks if a rectangle touches the boundary of all items, so the bounds might shrink without it.
+		///
+		/// \param [in] rect    Rectangle of an indexed item.
+		///
+		/// \return             <i>true</i> if the rectangle is not strictly inside the bounds.
+		///
+		inline bool touchesBounds(const QRectF &rect) const
+		{
+			return !((rect.left() > m_bounds.left()) && (rect.top() > m_bounds.top()) && (rect.right() < m_bounds.right())
+			         && (rect.bottom() < m_bounds.bottom()));
+		}
+
+	private: // structs
+
+		///
+		/// \brief Index entry of a single item.
+		///
+		struct Entry
+		{
+			///
+			/// \brief The indexed item.
+			///
+			QGraphicsItem *item;
+
+			///
+			/// \brief Rectangle covered by the item, in scene coordinates.
+			///
+			QRectF rect;
+
+			///
+			/// \brief Level of the grid that the item was sorted into.
+			///
+			int level;
+
+			///
+			/// \brief Range of cells that the item was sorted into.
+			///
+			QRect cells;
+		};
+
+	private: // members
+
+		///
+		/// \brief Width and height of a grid cell on level 0 in scene coordinates.
+		///
+		qreal m_cellSize;
+
+		///
+		/// \brief Entries of all indexed items.
+		///
+		FlatHashMap<QGraphicsItem *, Entry> m_items;
+
+		///
+		/// \brief Items in each non-empty cell, for every level of the hierarchy.
+		///
+		QVector<QHash<quint64, QVector<QGraphicsItem *>>> m_levels;
+
+		///
+		/// \brief Rectangle around all items, valid unless m_isBoundsDirty is set.
+		///
+		mutable QRectF m_bounds;
+
+		///
+		/// \brief Is true, if an item on the boundary has moved or was removed since the bounds were calculated.
+		///
+		mutable bool m_isBoundsDirty;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_SPATIALINDEX_H
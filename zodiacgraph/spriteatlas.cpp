@@ -0,0 +1,184 @@
+#include "spriteatlas.h"
+
+#include <QPaintDevice>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtMath>
+
+#include <cmath>
+
+namespace zodiac
+{
+
+	int SpriteAtlas::s_bucketsPerOctave = 4;
+	int SpriteAtlas::s_pageSize = 1024;
+	int SpriteAtlas::s_maxPageCount = 4;
+	int SpriteAtlas::s_maxSpriteSize = 256;
+
+	SpriteAtlas::SpriteAtlas()
+			: m_sprites(QHash<Key, Sprite>()), m_pages(QVector<Page>()), m_currentPage(-1), m_useCounter(0)
+	{
+	}
+
+	void SpriteAtlas::drawDisc(QPainter *painter, const QPointF &center, qreal radius, const QColor &fill,
+	                           const QPen &outline)
+	{
+		qreal zoom = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+		if (zoom <= 0.)
+		{
+			return;
+		}
+
+		bool hasOutline = outline.style() != Qt::NoPen;
+		Key key;
+		key.radius = radius;
+		key.fill = fill.rgba();
+		key.line = hasOutline ? outline.color().rgba() : 0;
+		key.lineWidth = hasOutline ? outline.widthF() : 0.;
+		key.bucket = qCeil(std::log2(zoom) * s_bucketsPerOctave);
+		key.pixelRatio = painter->device()->devicePixelRatioF();
+
+		Sprite sprite;
+		auto it = m_sprites.constFind(key);
+		if (it != m_sprites.constEnd())
+		{
+			sprite = it.value();
+		} else if (addSprite(key, outline, sprite))
+		{
+			m_sprites.insert(key, sprite);
+		} else
+		{
+			// too large for the atlas
+			painter->setPen(outline);
+			painter->setBrush(fill);
+			painter->drawEllipse(center, radius, radius);
+			return;
+		}
+
+		m_pages[sprite.page].lastUsed = ++m_useCounter;
+
+		// the sprite is rendered for a zoom at least as large as the current one, so it is only scaled down
+		qreal size = sprite.rect.width() / sprite.scale;
+		QRectF target(center.x() - (size / 2.), center.y() - (size / 2.), size, size);
+		painter->setRenderHint(QPainter::SmoothPixmapTransform);
+		painter->drawPixmap(target, m_pages[sprite.page].pixmap, QRectF(sprite.rect));
+	}
+
+	void SpriteAtlas::clear()
+	{
+		m_sprites.clear();
+		m_pages.clear();
+		m_currentPage = -1;
+	}
+
+	bool SpriteAtlas::addSprite(const Key &key, const QPen &outline, Sprite &sprite)
+	{
+		// one pixel of margin around the anti-aliased edge
+		qreal scale = qPow(2., qreal(key.bucket) / s_bucketsPerOctave) * key.pixelRatio;
+		qreal extent = key.radius + (key.lineWidth / 2.);
+		int size = qCeil(extent * 2. * scale) + 2;
+		if (size > s_maxSpriteSize)
+		{
+			return false;
+		}
+		int page;
+		QPoint pos;
+		if (!allocate(size, page, pos))
+		{
+			return false;
+		}
+
+		QPainter painter(&m_pages[page].pixmap);
+		painter.setRenderHint(QPainter::Antialiasing);
+		painter.translate(pos.x() + (size / 2.), pos.y() + (size / 2.));
+		painter.scale(scale, scale);
+		painter.setPen(outline);
+		painter.setBrush(QColor::fromRgba(key.fill));
+		painter.drawEllipse(QPointF(), key.radius, key.radius);
+
+		sprite.page = page;
+		sprite.rect = QRect(pos, QSize(size, size));
+		sprite.scale = scale;
+		return true;
+	}
+
+	bool SpriteAtlas::allocate(int size, int &page, QPoint &pos)
+	{
+		if (size > s_pageSize)
+		{
+			return false;
+		}
+		if ((m_currentPage >= 0) && allocateOn(m_pages[m_currentPage], size, pos))
+		{
+			page = m_currentPage;
+			return true;
+		}
+
+		// continue on a new page, or empty the one that was least recently drawn from
+		if (m_pages.size() < s_maxPageCount)
+		{
+			Page newPage;
+			newPage.pixmap = QPixmap(s_pageSize, s_pageSize);
+			newPage.pixmap.fill(Qt::transparent);
+			newPage.cursorX = 0;
+			newPage.cursorY = 0;
+			newPage.rowHeight = 0;
+			newPage.lastUsed = m_useCounter;
+			m_pages.append(newPage);
+			m_currentPage = m_pages.size() - 1;
+		} else
+		{
+			m_currentPage = 0;
+			for (int index = 1; index < m_pages.size(); ++index)
+			{
+				if (m_pages.at(index).lastUsed < m_pages.at(m_currentPage).lastUsed)
+				{
+					m_currentPage = index;
+				}
+			}
+			evictPage(m_currentPage);
+		}
+		page = m_currentPage;
+		return allocateOn(m_pages[page], size, pos);
+	}
+
+	bool SpriteAtlas::allocateOn(Page &page, int size, QPoint &pos)
+	{
+		// sprites are separated by a single pixel, so smooth scaling does not bleed into the neighbours
+		if (page.cursorX + size > s_pageSize)
+		{
+			page.cursorX = 0;
+			page.cursorY += page.rowHeight + 1;
+			page.rowHeight = 0;
+		}
+		if (page.cursorY + size > s_pageSize)
+		{
+			return false;
+		}
+		pos = QPoint(page.cursorX, page.cursorY);
+		page.cursorX += size + 1;
+		page.rowHeight = qMax(page.rowHeight, size);
+		return true;
+	}
+
+	void SpriteAtlas::evictPage(int page)
+	{
+		for (auto it = m_sprites.begin(); it != m_sprites.end();)
+		{
+			if (it.value().page == page)
+			{
+				it = m_sprites.erase(it);
+			} else
+			{
+				++it;
+			}
+		}
+		Page &evicted = m_pages[page];
+		evicted.pixmap.fill(Qt::transparent);
+		evicted.cursorX = 0;
+		evicted.cursorY = 0;
+		evicted.rowHeight = 0;
+		evicted.lastUsed = m_useCounter;
+	}
+
+} // namespace zodiac
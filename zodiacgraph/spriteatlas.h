@@ -0,0 +1,364 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_SPRITEATLAS_H
+#define ZODIAC_SPRITEATLAS_H
+
+/// \file spriteatlas.h
+///
+/// \brief Contains the definition of the zodiac::SpriteAtlas class.
+///
+
+#include <QColor>
+#include <QHash>
+#include <QPen>
+#include <QPixmap>
+#include <QPointF>
+#include <QRect>
+#include <QVector>
+#include <QtGlobal>
+
+class QPainter;
+
+namespace zodiac
+{
+
+///
+/// \brief Pre-rasterized discs shared by all Node cores and Perimeter%s of a Scene.
+///
+/// Instead of every item caching its own pixmap of the same anti-aliased circle, each distinct disc (radius, fill,
+/// outline) is rendered once per zoom bucket and device pixel ratio into a few shared atlas pages and blitted from
+/// there.
+/// Zoom buckets are a fraction of an octave apart and the disc is always rendered for the larger zoom of its bucket,
+/// so it is only ever scaled down, by no more than 2^(1/getBucketsPerOctave()).
+///
+/// Discs larger than getMaxSpriteSize() on screen, like the Perimeter%s of expanded Node%s at a high zoom, are drawn
+/// directly, so they do not crowd out the many small ones.
+/// Once all pages are full, the least recently used page is emptied for the new sprites, the others are kept.
+///
+	class Q_DECL_EXPORT SpriteAtlas
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		SpriteAtlas();
+
+		///
+		/// \brief Draws a filled and outlined disc.
+		///
+		/// \param [in] painter Painter to draw with.
+		/// \param [in] center  Center of the disc in item coordinates.
+		/// \param [in] radius  Radius of the disc in item coordinates.
+		/// \param [in] fill    Fill color.
+		/// \param [in] outline Outline, Qt::NoPen to draw no outline.
+		///
+		void drawDisc(QPainter *painter, const QPointF &center, qreal radius, const QColor &fill, const QPen &outline);
+
+		///
+		/// \brief Discards all sprites.
+		///
+		void clear();
+
+		///
+		/// \brief The number of sprites currently in the atlas.
+		///
+		/// \return Number of sprites.
+		///
+		inline int size() const { return m_sprites.size(); }
+
+	public: // static methods
+
+		///
+		/// \brief Number of zoom buckets per doubling of the zoom factor.
+		///
+		/// \return Buckets per octave.
+		///
+		static inline int getBucketsPerOctave() { return s_bucketsPerOctave; }
+
+		///
+		/// \brief Sets the number of zoom buckets per doubling of the zoom factor.
+		///
+		/// More buckets mean sharper sprites but more of them.
+		/// Call clear() on all atlases afterwards.
+		///
+		/// \param [in] buckets New number of buckets, at least one.
+		///
+		static inline void setBucketsPerOctave(int buckets) { s_bucketsPerOctave = qMax(1, buckets); }
+
+		///
+		/// \brief Width and height of an atlas page in pixels.
+		///
+		/// \return Page size.
+		///
+		static inline int getPageSize() { return s_pageSize; }
+
+		///
+		/// \brief Sets the width and height of the atlas pages in pixels.
+		///
+		/// Call clear() on all atlases afterwards.
+		///
+		/// \param [in] size    New page size, at least 64 pixels.
+		///
+		static inline void setPageSize(int size) { s_pageSize = qMax(64, size); }
+
+		///
+		/// \brief Width and height in pixels above which discs are drawn directly instead of through the atlas.
+		///
+		/// \return Maximum sprite size.
+		///
+		static inline int getMaxSpriteSize() { return s_maxSpriteSize; }
+
+		///
+		/// \brief Sets the width and height in pixels above which discs are drawn directly instead of through the atlas.
+		///
+		/// \param [in] size    New maximum sprite size, at least 8 pixels.
+		///
+		static inline void setMaxSpriteSize(int size) { s_maxSpriteSize = qMax(8, size); }
+
+		///
+		/// \brief Maximum number of pages in an atlas before its least recently used page is emptied.
+		///
+		/// \return Maximum page count.
+		///
+		static inline int getMaxPageCount() { return s_maxPageCount; }
+
+		///
+		/// \brief Sets the maximum number of pages in an atlas before its least recently used page is emptied.
+		///
+		/// \param [in] count   New maximum page count, at least one.
+		///
+		static inline void setMaxPageCount(int count) { s_maxPageCount = qMax(1, count); }
+
+	private: // structs
+
+		///
+		/// \brief Everything that makes the pixels of a sprite unique.
+		///
+		struct Key
+		{
+			///
+			/// \brief Radius of the disc in item coordinates.
+			///
+			qreal radius;
+
+			///
+			/// \brief Fill color.
+			///
+			QRgb fill;
+
+			///
+			/// \brief Outline color, fully transparent if there is no outline.
+			///
+			QRgb line;
+
+			///
+			/// \brief Width of the outline.
+			///
+			qreal lineWidth;
+
+			///
+			/// \brief Zoom bucket.
+			///
+			int bucket;
+
+			///
+			/// \brief Device pixel ratio of the paint device.
+			///
+			qreal pixelRatio;
+
+			///
+			/// \brief Equality operator.
+			///
+			/// \param [in] other   Key to compare with.
+			///
+			/// \return             <i>true</i> if both keys describe the same sprite -- <i>false</i> otherwise.
+			///
+			inline bool operator==(const Key &other) const
+			{
+				return (radius == other.radius) && (fill == other.fill) && (line == other.line)
+				       && (lineWidth == other.lineWidth) && (bucket == other.bucket) && (pixelRatio == other.pixelRatio);
+			}
+
+			///
+			/// \brief Hash function for QHash.
+			///
+			/// \param [in] key     Key to hash.
+			/// \param [in] seed    Seed of the QHash.
+			///
+			/// \return             Hash value.
+			///
+			friend inline uint qHash(const Key &key, uint seed = 0)
+			{
+				return ::qHash(key.radius, seed) ^ ::qHash(key.fill) ^ (::qHash(key.line) << 1) ^ ::qHash(key.lineWidth)
+				       ^ (uint(key.bucket) << 16) ^ ::qHash(key.pixelRatio);
+			}
+		};
+
+		///
+		/// \brief Position of a sprite in the atlas.
+		///
+		struct Sprite
+		{
+			///
+			/// \brief Index of the page.
+			///
+			int page;
+
+			///
+			/// \brief Area of the sprite on its page, in pixels.
+			///
+			QRect rect;
+
+			///
+			/// \brief Pixels per item coordinate the sprite was rendered with.
+			///
+			qreal scale;
+		};
+
+		///
+		/// \brief A single atlas page, filled in rows from top to bottom.
+		///
+		struct Page
+		{
+			///
+			/// \brief Pixels of the page.
+			///
+			QPixmap pixmap;
+
+			///
+			/// \brief Horizontal position of the next sprite in the current row.
+			///
+			int cursorX;
+
+			///
+			/// \brief Top of the current row.
+			///
+			int cursorY;
+
+			///
+			/// \brief Height of the tallest sprite in the current row.
+			///
+			int rowHeight;
+
+			///
+			/// \brief Value of the use counter of the atlas, when a sprite on this page was last drawn.
+			///
+			quint64 lastUsed;
+		};
+
+	private: // methods
+
+		///
+		/// \brief Renders a new sprite into the atlas.
+		///
+		/// \param [in] key     Description of the sprite.
+		/// \param [in] outline Outline pen of the sprite.
+		/// \param [out] sprite Position of the new sprite.
+		///
+		/// \return             <i>true</i> if the sprite was rendered -- <i>false</i> if it is too large for the atlas.
+		///
+		bool addSprite(const Key &key, const QPen &outline, Sprite &sprite);
+
+		///
+		/// \brief Reserves an area for a new sprite on the pages.
+		///
+		/// \param [in] size    Size of the sprite in pixels, including its margin.
+		/// \param [out] page   Index of the page.
+		/// \param [out] pos    Top left corner of the area on the page.
+		///
+		/// \return             <i>true</i> if space was found -- <i>false</i> if the sprite is larger than a page.
+		///
+		bool allocate(int size, int &page, QPoint &pos);
+
+		///
+		/// \brief Reserves an area for a new sprite in the current row of a page, or a new row below it.
+		///
+		/// \param [in,out] page    Page to reserve the area on.
+		/// \param [in] size        Size of the sprite in pixels, including its margin.
+		/// \param [out] pos        Top left corner of the area on the page.
+		///
+		/// \return                 <i>true</i> if space was found -- <i>false</i> if the page is full.
+		///
+		static bool allocateOn(Page &page, int size, QPoint &pos);
+
+		///
+		/// \brief Discards all sprites on a page and empties it.
+		///
+		/// \param [in] page    Index of the page.
+		///
+		void evictPage(int page);
+
+	private: // members
+
+		///
+		/// \brief All sprites in the atlas.
+		///
+		QHash<Key, Sprite> m_sprites;
+
+		///
+		/// \brief All pages of the atlas.
+		///
+		QVector<Page> m_pages;
+
+		///
+		/// \brief Index of the page that new sprites are added to, -1 if there is none.
+		///
+		int m_currentPage;
+
+		///
+		/// \brief Counter increased with every drawn sprite, used to find the least recently used page.
+		///
+		quint64 m_useCounter;
+
+	private: // static members
+
+		///
+		/// \brief Number of zoom buckets per doubling of the zoom factor.
+		///
+		static int s_bucketsPerOctave;
+
+		///
+		/// \brief Width and height of an atlas page in pixels.
+		///
+		static int s_pageSize;
+
+		///
+		/// \brief Maximum number of pages in an atlas.
+		///
+		static int s_maxPageCount;
+
+		///
+		/// \brief Width and height in pixels above which discs are drawn directly.
+		///
+		static int s_maxSpriteSize;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_SPRITEATLAS_H
@@ -4,6 +4,8 @@
 
 #include "edgearrow.h"
 #include "edgegroupinterface.h"
+#include "scene.h"
+#include "straightedgelayer.h"
 
 namespace zodiac
 {
@@ -14,10 +16,8 @@ namespace zodiac
 	{
 		m_arrow->setKind(ArrowKind::DOUBLE);
 
-		// initialize the shape
-		// the StraightEdge Constructor does so as well, but at that time this part of the instance is not constructed yet
-		// so the wrong function is called (it calls StraightEdge::updateShape instead).
-		updateShape();
+		// the StraightEdge constructor has marked the edge dirty, so the scene will call the right updateShape() once
+		// this instance is fully constructed
 	}
 
 	void StraightDoubleEdge::updateLabel()
@@ -29,6 +29,8 @@ namespace zodiac
 	void StraightDoubleEdge::updateShape()
 	{
 		prepareGeometryChange();
+		m_scene->markIndexDirty(this);
+		m_scene->getStraightEdgeLayer()->markEdgeDirty(this);
 
 		// calculate the perpendicular edge offset
 		QVector2D direction = QVector2D(m_endPoint - m_startPoint);
@@ -43,10 +45,28 @@ namespace zodiac
 		doubleLine.moveTo(m_startPoint - offset);
 		doubleLine.lineTo(m_endPoint - offset);
 
-		m_path.swap(doubleLine);
+		setPath(doubleLine);
 
 		// update the arrow
 		placeArrowAt(.5);
 	}
 
+	void StraightDoubleEdge::appendLines(QVector<QPointF> &pointPairs) const
+	{
+		// both lines are offset perpendicular to the direction of the edge, like in updateShape()
+		QVector2D direction = QVector2D(m_endPoint - m_startPoint);
+		direction.normalize();
+		QPointF offset = QPointF(-direction.y(), direction.x()) * s_width;
+		QPointF translation = pos();
+		pointPairs.append(m_startPoint + offset + translation);
+		pointPairs.append(m_endPoint + offset + translation);
+		pointPairs.append(m_startPoint - offset + translation);
+		pointPairs.append(m_endPoint - offset + translation);
+	}
+
+	qreal StraightDoubleEdge::getHitRadius() const
+	{
+		return s_width * 1.5;
+	}
+
 } // namespace zodiac
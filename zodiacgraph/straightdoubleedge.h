@@ -69,7 +69,14 @@ namespace zodiac
 		///
 		/// \brief Generates and updates the text for the EdgeLabel of this edge.
 		///
-		void updateLabel();
+		void updateLabel() override;
+
+		///
+		/// \brief Appends both lines drawing this edge to a buffer, used by the StraightEdgeLayer.
+		///
+		/// \param [in,out] pointPairs  Start and end point of every line in scene coordinates.
+		///
+		void appendLines(QVector<QPointF> &pointPairs) const override;
 
 	protected: // methods
 
@@ -77,6 +84,13 @@ namespace zodiac
 		/// \brief Updates the shape of the edge.
 		///
 		virtual void updateShape() override;
+
+		///
+		/// \brief Distance from the center line, within which a point is on one of the two lines of this edge.
+		///
+		/// \return The offset of both lines plus half their width.
+		///
+		qreal getHitRadius() const override;
 	};
 
 } // namespace zodiac
@@ -6,6 +6,8 @@
 #include "edgearrow.h"
 #include "edgegroupinterface.h"
 #include "node.h"
+#include "scene.h"
+#include "straightedgelayer.h"
 #include "view.h"
 
 namespace zodiac
@@ -25,6 +27,12 @@ namespace zodiac
 	}
 
 	void StraightEdge::nodePositionHasChanged()
+	{
+		// the shape is rebuilt once per frame by the scene
+		m_scene->markEdgeDirty(this);
+	}
+
+	void StraightEdge::refreshGeometry()
 	{
 		// return early, if the shape has not changed
 		QPointF startPoint = m_fromNode->scenePos();
@@ -58,17 +66,36 @@ namespace zodiac
 	void StraightEdge::updateShape()
 	{
 		prepareGeometryChange();
+		m_scene->markIndexDirty(this);
+		m_scene->getStraightEdgeLayer()->markEdgeDirty(this);
 
 		// update the path
 		QPainterPath straightLine;
 		straightLine.moveTo(m_startPoint);
 		straightLine.lineTo(m_endPoint);
-		m_path.swap(straightLine);
+		setPath(straightLine);
 
 		// update the arrow
 		placeArrowAt(.5);
 	}
 
+	void StraightEdge::appendLines(QVector<QPointF> &pointPairs) const
+	{
+		QPointF offset = pos();
+		pointPairs.append(m_startPoint + offset);
+		pointPairs.append(m_endPoint + offset);
+	}
+
+	bool StraightEdge::isTileable() const
+	{
+		return !isUnderMouse();
+	}
+
+	QPolygonF StraightEdge::getCenterLine() const
+	{
+		return QPolygonF() << m_startPoint << m_endPoint;
+	}
+
 	void StraightEdge::mousePressEvent(QGraphicsSceneMouseEvent *event)
 	{
 		if (event->buttons() & View::getRemovalButton())
@@ -91,4 +118,27 @@ namespace zodiac
 		BaseEdge::mouseDoubleClickEvent(event);
 	}
 
+	void StraightEdge::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+	{
+		m_scene->getStraightEdgeLayer()->activateEdge(this);
+		m_scene->markItemChanged(this);
+		BaseEdge::hoverEnterEvent(event);
+	}
+
+	void StraightEdge::hoverLeaveEvent(QGraphicsSceneHoverEvent *event)
+	{
+		BaseEdge::hoverLeaveEvent(event);
+		m_scene->markItemChanged(this);
+		m_scene->getStraightEdgeLayer()->releaseEdge(this);
+	}
+
+	QVariant StraightEdge::itemChange(GraphicsItemChange change, const QVariant &value)
+	{
+		if ((change == ItemPositionHasChanged) || (change == ItemVisibleHasChanged))
+		{
+			m_scene->getStraightEdgeLayer()->markEdgeDirty(this);
+		}
+		return BaseEdge::itemChange(change, value);
+	}
+
 } // namespace zodiac
@@ -33,6 +33,8 @@
 ///
 
 #include "baseedge.h"
+#include <QPointF>
+#include <QVector>
 #include <QtGlobal>
 
 namespace zodiac {
@@ -67,12 +69,21 @@ public: // methods
     ///
     /// \brief Is called from a Node to notify a connected StraightEdge of a change in position.
     ///
+    /// Only marks the edge as dirty, the shape is rebuilt at most once per frame in refreshGeometry().
+    ///
     void nodePositionHasChanged();
 
+    ///
+    /// \brief Rebuilds the shape of this StraightEdge from the current positions of its Node%s.
+    ///
+    /// Returns early, if neither Node has moved since the last call.
+    ///
+    void refreshGeometry() override;
+
     ///
     /// \brief Generates and updates the text for this edge's EdgeLabel.
     ///
-    void updateLabel();
+    void updateLabel() override;
 
     ///
     /// \brief The Node from which the PlugEdge%s in the EdgeGroup originate.
@@ -95,6 +106,20 @@ public: // methods
     ///
     void placeArrowAt(qreal fraction) override;
 
+    ///
+    /// \brief Appends the lines drawing this edge to a buffer, used by the StraightEdgeLayer.
+    ///
+    /// \param [in,out] pointPairs  Start and end point of every line in scene coordinates.
+    ///
+    virtual void appendLines(QVector<QPointF> &pointPairs) const;
+
+    ///
+    /// \brief StraightEdge%s are drawn from the tiles of a View, unless they are hovered.
+    ///
+    /// \return <i>true</i> if the edge is not under the mouse -- <i>false</i> otherwise.
+    ///
+    bool isTileable() const override;
+
 signals:
 
     ///
@@ -109,6 +134,13 @@ protected: // methods
     ///
     virtual void updateShape() override;
 
+    ///
+    /// \brief The center line of this StraightEdge, a single segment between its end points.
+    ///
+    /// \return Center line of the edge.
+    ///
+    QPolygonF getCenterLine() const override;
+
     ///
     /// \brief Called, when the mouse is pressed as the cursor is on this item.
     ///
@@ -125,6 +157,36 @@ protected: // methods
     ///
     void mouseDoubleClickEvent(QGraphicsSceneMouseEvent *event);
 
+    ///
+    /// \brief Called when the mouse enters the shape of the edge.
+    ///
+    /// Keeps the edge in the Scene while the StraightEdgeLayer is batching.
+    ///
+    /// \param [in] event   Qt event object.
+    ///
+    void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
+
+    ///
+    /// \brief Called when the mouse leaves the shape of the edge.
+    ///
+    /// Hands the edge back to the StraightEdgeLayer, if it is batching.
+    ///
+    /// \param [in] event   Qt event object.
+    ///
+    void hoverLeaveEvent(QGraphicsSceneHoverEvent *event);
+
+    ///
+    /// \brief Called when the state of this item changes.
+    ///
+    /// Notifies the StraightEdgeLayer when this edge is moved, shown or hidden.
+    ///
+    /// \param [in] change  What has changed.
+    /// \param [in] value   New value of the change.
+    ///
+    /// \return             Adjusted value.
+    ///
+    QVariant itemChange(GraphicsItemChange change, const QVariant &value);
+
 protected: // members
 
     ///
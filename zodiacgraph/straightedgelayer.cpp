@@ -0,0 +1,307 @@
+#include "straightedgelayer.h"
+
+#include <QGraphicsSceneHoverEvent>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QTimer>
+
+#include "edgearrow.h"
+#include "scene.h"
+#include "straightedge.h"
+#include "utils.h"
+#include "view.h"
+
+namespace zodiac
+{
+
+	StraightEdgeLayer::StraightEdgeLayer(Scene *scene)
+			: QGraphicsObject(nullptr), m_scene(scene), m_isBatching(false), m_edges(QSet<StraightEdge *>()),
+			  m_activeEdges(QSet<StraightEdge *>()), m_releasedEdges(QSet<StraightEdge *>()),
+			  m_dirtyEdges(QSet<StraightEdge *>()), m_index(SpatialIndex()), m_boundingRect(QRectF()), m_pen(QPen()),
+			  m_lineBuffer(QVector<QPointF>()), m_arrowBuffer(QVector<QPointF>()), m_arrowSizes(QVector<int>())
+	{
+		// the layer is drawn at the depth of the edges it replaces
+		setZValue(zStack::EDGE);
+
+		// there is nothing to cache, the edges change all the time
+		setCacheMode(NoCache);
+
+		// hovering an edge hands it back to the scene
+		setAcceptHoverEvents(true);
+		setAcceptedMouseButtons(Qt::NoButton);
+
+		updateStyle();
+	}
+
+	void StraightEdgeLayer::setBatching(bool batching)
+	{
+		if (batching == m_isBatching)
+		{
+			return;
+		}
+		m_isBatching = batching;
+
+		if (m_isBatching)
+		{
+			prepareGeometryChange();
+			m_boundingRect = QRectF();
+			for (StraightEdge *edge: m_edges)
+			{
+				m_scene->detachEdge(edge);
+				m_dirtyEdges.insert(edge);
+			}
+			m_scene->addItem(this);
+			flushDirtyEdges();
+			return;
+		}
+
+		// active edges are attached already
+		m_scene->removeItem(this);
+		for (StraightEdge *edge: m_edges)
+		{
+			if (!m_activeEdges.contains(edge))
+			{
+				m_scene->attachEdge(edge);
+			}
+		}
+		m_activeEdges.clear();
+		m_releasedEdges.clear();
+		m_dirtyEdges.clear();
+		m_index.clear();
+	}
+
+	void StraightEdgeLayer::addEdge(StraightEdge *edge)
+	{
+		m_edges.insert(edge);
+		if (m_isBatching)
+		{
+			m_scene->detachEdge(edge);
+			m_dirtyEdges.insert(edge);
+		}
+	}
+
+	void StraightEdgeLayer::removeEdge(StraightEdge *edge)
+	{
+		// the edge is taken out of the scene by its owner, whether it is detached or not
+		m_edges.remove(edge);
+		m_activeEdges.remove(edge);
+		m_releasedEdges.remove(edge);
+		m_dirtyEdges.remove(edge);
+		m_index.remove(edge);
+		if (m_isBatching)
+		{
+			updateBoundingRect();
+		}
+		update();
+	}
+
+	void StraightEdgeLayer::markEdgeDirty(BaseEdge *edge)
+	{
+		StraightEdge *straightEdge = qobject_cast<StraightEdge *>(edge);
+		if (!m_isBatching || !m_edges.contains(straightEdge))
+		{
+			return;
+		}
+		m_dirtyEdges.insert(straightEdge);
+		update();
+	}
+
+	void StraightEdgeLayer::activateEdge(StraightEdge *edge)
+	{
+		if (!m_isBatching || !m_edges.contains(edge))
+		{
+			return;
+		}
+		m_releasedEdges.remove(edge);
+		if (m_activeEdges.contains(edge))
+		{
+			return;
+		}
+		m_activeEdges.insert(edge);
+		m_scene->attachEdge(edge);
+	}
+
+	void StraightEdgeLayer::releaseEdge(StraightEdge *edge)
+	{
+		if (!m_activeEdges.contains(edge))
+		{
+			return;
+		}
+
+		// give the label time to fade out before the edge leaves the scene
+		if (m_releasedEdges.isEmpty())
+		{
+			QTimer::singleShot(int(BaseEdge::getSecondaryFadeOutDuration()), this, SLOT(detachReleasedEdges()));
+		}
+		m_releasedEdges.insert(edge);
+	}
+
+	void StraightEdgeLayer::flushDirtyEdges()
+	{
+		if (m_dirtyEdges.isEmpty())
+		{
+			return;
+		}
+		QSet<StraightEdge *> dirtyEdges;
+		dirtyEdges.swap(m_dirtyEdges);
+		for (StraightEdge *edge: dirtyEdges)
+		{
+			m_index.insert(edge, getEdgeRect(edge));
+		}
+		updateBoundingRect();
+	}
+
+	void StraightEdgeLayer::setCellSize(qreal cellSize)
+	{
+		m_index.setCellSize(cellSize);
+	}
+
+	void StraightEdgeLayer::updateStyle()
+	{
+		m_pen = QPen(QBrush(BaseEdge::getBaseColor()), BaseEdge::getBaseWidth(), Qt::SolidLine, Qt::RoundCap);
+		update();
+	}
+
+	void StraightEdgeLayer::detachReleasedEdges()
+	{
+		QSet<StraightEdge *> releasedEdges;
+		releasedEdges.swap(m_releasedEdges);
+		for (StraightEdge *edge: releasedEdges)
+		{
+			// the cursor may have come back without the edge noticing
+			if (edge->isUnderMouse())
+			{
+				continue;
+			}
+			m_activeEdges.remove(edge);
+			m_scene->detachEdge(edge);
+		}
+	}
+
+	QRectF StraightEdgeLayer::boundingRect() const
+	{
+		return m_boundingRect;
+	}
+
+	void StraightEdgeLayer::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
+	{
+		// the drawn edges are not hovered, so they are all part of the tiles
+		if (View::isTiled(widget))
+		{
+			return;
+		}
+
+		// collect the geometry of all visible edges into contiguous buffers
+		bool isDrawingArrows = View::isReadable(EdgeArrow::getArrowLength(), painter);
+		m_lineBuffer.resize(0);
+		m_arrowBuffer.resize(0);
+		m_arrowSizes.resize(0);
+		for (QGraphicsItem *item: m_index.query(option->exposedRect))
+		{
+			StraightEdge *edge = static_cast<StraightEdge *>(item);
+			if (!isDrawn(edge))
+			{
+				continue;
+			}
+			edge->appendLines(m_lineBuffer);
+			if (isDrawingArrows)
+			{
+				QPointF offset = edge->pos();
+				const QPolygonF &arrow = edge->getArrow()->getPolygon();
+				for (const QPointF &point: arrow)
+				{
+					m_arrowBuffer.append(point + offset);
+				}
+				m_arrowSizes.append(arrow.size());
+			}
+		}
+
+		// draw all lines at once, then the arrows on top
+		painter->setClipRect(option->exposedRect);
+		painter->setPen(m_pen);
+		painter->drawLines(m_lineBuffer);
+		painter->setPen(Qt::NoPen);
+		painter->setBrush(QBrush(EdgeArrow::getArrowColor()));
+		const QPointF *arrowPoints = m_arrowBuffer.constData();
+		for (int arrowSize: m_arrowSizes)
+		{
+			painter->drawConvexPolygon(arrowPoints, arrowSize);
+			arrowPoints += arrowSize;
+		}
+	}
+
+	bool StraightEdgeLayer::contains(const QPointF &point) const
+	{
+		return getEdgeAt(point) != nullptr;
+	}
+
+	void StraightEdgeLayer::hoverEnterEvent(QGraphicsSceneHoverEvent *event)
+	{
+		StraightEdge *edge = getEdgeAt(event->scenePos());
+		if (edge)
+		{
+			activateEdge(edge);
+		}
+		QGraphicsObject::hoverEnterEvent(event);
+	}
+
+	void StraightEdgeLayer::hoverMoveEvent(QGraphicsSceneHoverEvent *event)
+	{
+		StraightEdge *edge = getEdgeAt(event->scenePos());
+		if (edge)
+		{
+			activateEdge(edge);
+		}
+		QGraphicsObject::hoverMoveEvent(event);
+	}
+
+	QVector<StraightEdge *> StraightEdgeLayer::getEdgesIn(const QRectF &rect) const
+	{
+		QVector<StraightEdge *> result;
+		for (QGraphicsItem *item: m_index.query(rect))
+		{
+			StraightEdge *edge = static_cast<StraightEdge *>(item);
+			if (isDrawn(edge))
+			{
+				result.append(edge);
+			}
+		}
+		return result;
+	}
+
+	StraightEdge *StraightEdgeLayer::getEdgeAt(const QPointF &pos) const
+	{
+		for (QGraphicsItem *item: m_index.query(pos))
+		{
+			StraightEdge *edge = static_cast<StraightEdge *>(item);
+			if (isDrawn(edge) && edge->contains(edge->mapFromScene(pos)))
+			{
+				return edge;
+			}
+		}
+		return nullptr;
+	}
+
+	void StraightEdgeLayer::updateBoundingRect()
+	{
+		// the bounds shrink as well, when edges move inwards or are removed
+		QRectF boundingRect = m_index.getBounds();
+		if (boundingRect != m_boundingRect)
+		{
+			prepareGeometryChange();
+			m_boundingRect = boundingRect;
+			m_scene->markIndexDirty(this);
+		}
+	}
+
+	bool StraightEdgeLayer::isDrawn(StraightEdge *edge) const
+	{
+		return edge->isVisible() && (m_scene->getDetachCount(edge) == 1);
+	}
+
+	QRectF StraightEdgeLayer::getEdgeRect(StraightEdge *edge)
+	{
+		return edge->sceneBoundingRect().united(edge->mapRectToScene(edge->childrenBoundingRect()));
+	}
+
+} // namespace zodiac
@@ -0,0 +1,323 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_STRAIGHTEDGELAYER_H
+#define ZODIAC_STRAIGHTEDGELAYER_H
+
+///
+/// \file straightedgelayer.h
+///
+/// \brief Contains the definition of the zodiac::StraightEdgeLayer class.
+///
+
+#include <QGraphicsObject>
+#include <QPen>
+#include <QPointF>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+#include <QtGlobal>
+
+#include "spatialindex.h"
+
+namespace zodiac
+{
+
+	class BaseEdge;
+
+	class Scene;
+
+	class StraightEdge;
+
+///
+/// \brief A single item drawing all StraightEdge%s of the EdgeGroup%s and EdgeGroupPair%s at once.
+///
+/// While batching, the StraightEdge%s are detached from the Scene and drawn by this layer in a single paint() call,
+/// with one QPainter::drawLines() call for all lines and the arrows from a contiguous vertex buffer.
+/// This way, the QGraphicsScene neither has to index nor to paint a separate item for every collapsed connection.
+///
+/// As soon as the cursor hovers a StraightEdge, it is attached to the Scene again, so it can show its EdgeLabel and
+/// react to clicks like before.
+/// It is detached again once the cursor has left it and its EdgeLabel has faded out.
+///
+/// StraightEdge%s that are detached by anyone else (the ClusterLayer or the ViewportLayer) are not drawn.
+///
+/// Batching is disabled by default.
+///
+	class Q_DECL_EXPORT StraightEdgeLayer : public QGraphicsObject
+	{
+	Q_OBJECT
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// The StraightEdgeLayer is only added to the Scene while it is batching.
+		///
+		/// \param [in] scene   Scene containing the StraightEdge%s.
+		///
+		explicit StraightEdgeLayer(Scene *scene);
+
+		///
+		/// \brief Enables or disables batching.
+		///
+		/// Disabling batching attaches all StraightEdge%s to the Scene again.
+		///
+		/// \param [in] batching    <i>true</i> to draw the StraightEdge%s in this layer -- <i>false</i> to let them draw
+		///                         themselves.
+		///
+		void setBatching(bool batching);
+
+		///
+		/// \brief Tests whether this layer is batching.
+		///
+		/// \return <i>true</i> if this layer draws the StraightEdge%s -- <i>false</i> otherwise.
+		///
+		inline bool isBatching() const { return m_isBatching; }
+
+		///
+		/// \brief Registers a StraightEdge that is drawn by this layer while batching.
+		///
+		/// \param [in] edge    New StraightEdge.
+		///
+		void addEdge(StraightEdge *edge);
+
+		///
+		/// \brief Unregisters a StraightEdge that is about to be deleted.
+		///
+		/// \param [in] edge    StraightEdge to forget.
+		///
+		void removeEdge(StraightEdge *edge);
+
+		///
+		/// \brief Marks an edge whose geometry, visibility or attachment has changed.
+		///
+		/// Edges not registered with addEdge() are ignored.
+		///
+		/// \param [in] edge    Edge to update.
+		///
+		void markEdgeDirty(BaseEdge *edge);
+
+		///
+		/// \brief Attaches a hovered StraightEdge to the Scene, until it is released with releaseEdge().
+		///
+		/// \param [in] edge    Hovered StraightEdge.
+		///
+		void activateEdge(StraightEdge *edge);
+
+		///
+		/// \brief Detaches a StraightEdge activated with activateEdge(), once its EdgeLabel has faded out.
+		///
+		/// \param [in] edge    StraightEdge that is not hovered anymore.
+		///
+		void releaseEdge(StraightEdge *edge);
+
+		///
+		/// \brief Updates this layer with all edges marked with markEdgeDirty().
+		///
+		/// Is called by the Scene right before a View paints it.
+		///
+		void flushDirtyEdges();
+
+		///
+		/// \brief Changes the size of the cells on the finest grid of the index of all drawn edges.
+		///
+		/// Is kept at the cell size of the SpatialIndex of the Scene.
+		///
+		/// \param [in] cellSize    Width and height of a grid cell in scene coordinates.
+		///
+		void setCellSize(qreal cellSize);
+
+		///
+		/// \brief Applies style changes in the class' static members to this instance.
+		///
+		void updateStyle();
+
+		///
+		/// \brief All StraightEdge%s drawn by this layer whose rectangle intersects the given one.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Edges in no particular order.
+		///
+		QVector<StraightEdge *> getEdgesIn(const QRectF &rect) const;
+
+		///
+		/// \brief Tests, whether a StraightEdge is drawn by this layer.
+		///
+		/// \param [in] edge    StraightEdge to test.
+		///
+		/// \return             <i>true</i> if the edge is visible and only detached by this layer -- <i>false</i>
+		///                     otherwise.
+		///
+		bool isDrawn(StraightEdge *edge) const;
+
+	public slots:
+
+		///
+		/// \brief Detaches all released StraightEdge%s that were not activated again in the meantime.
+		///
+		void detachReleasedEdges();
+
+	protected: // methods
+
+		///
+		/// \brief Rectangular outer bounds of all StraightEdge%s.
+		///
+		/// \return Bounding rectangle of this item.
+		///
+		QRectF boundingRect() const;
+
+		///
+		/// \brief Draws all visible StraightEdge%s in the exposed area.
+		///
+		/// \param [in] painter Painter to draw with.
+		/// \param [in] option  Style options, the exposed rect in particular.
+		/// \param [in] widget  Widget painted on.
+		///
+		void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget);
+
+		///
+		/// \brief Tests, whether a point lies on any StraightEdge drawn by this layer.
+		///
+		/// Points between the edges are not part of this layer, so it doesn't hide empty space from the View.
+		///
+		/// \param [in] point   Point in local coordinates, which are the same as scene coordinates.
+		///
+		/// \return             <i>true</i> if the point is on a drawn StraightEdge -- <i>false</i> otherwise.
+		///
+		bool contains(const QPointF &point) const;
+
+		///
+		/// \brief Activates the StraightEdge under the cursor when the cursor enters this layer.
+		///
+		/// \param [in] event   Qt event object.
+		///
+		void hoverEnterEvent(QGraphicsSceneHoverEvent *event);
+
+		///
+		/// \brief Activates the StraightEdge under the cursor when the cursor moves over this layer.
+		///
+		/// \param [in] event   Qt event object.
+		///
+		void hoverMoveEvent(QGraphicsSceneHoverEvent *event);
+
+	private: // methods
+
+		///
+		/// \brief The drawn StraightEdge at the given position.
+		///
+		/// \param [in] pos Position in scene coordinates.
+		///
+		/// \return         A StraightEdge at the position, <i>nullptr</i> if there is none.
+		///
+		StraightEdge *getEdgeAt(const QPointF &pos) const;
+
+		///
+		/// \brief Fits the bounding rectangle of this layer to the edges in its index.
+		///
+		void updateBoundingRect();
+
+		///
+		/// \brief The area covered by a StraightEdge and its EdgeArrow.
+		///
+		/// \param [in] edge    StraightEdge to measure.
+		///
+		/// \return             Rectangle in scene coordinates.
+		///
+		static QRectF getEdgeRect(StraightEdge *edge);
+
+	private: // members
+
+		///
+		/// \brief Scene containing the StraightEdge%s.
+		///
+		Scene *m_scene;
+
+		///
+		/// \brief Whether this layer is drawing the StraightEdge%s.
+		///
+		bool m_isBatching;
+
+		///
+		/// \brief All registered StraightEdge%s.
+		///
+		QSet<StraightEdge *> m_edges;
+
+		///
+		/// \brief StraightEdge%s that are attached to the Scene because they are hovered.
+		///
+		QSet<StraightEdge *> m_activeEdges;
+
+		///
+		/// \brief Active StraightEdge%s that are detached with the next call to detachReleasedEdges().
+		///
+		QSet<StraightEdge *> m_releasedEdges;
+
+		///
+		/// \brief Edges that are updated with the next call to flushDirtyEdges().
+		///
+		QSet<StraightEdge *> m_dirtyEdges;
+
+		///
+		/// \brief Grid hierarchy of all registered StraightEdge%s while batching.
+		///
+		/// Long edges are sorted into coarser grids, so paint() and getEdgeAt() visit only a few cells per level.
+		///
+		SpatialIndex m_index;
+
+		///
+		/// \brief Bounding rectangle of all registered StraightEdge%s, follows the bounds of the index.
+		///
+		/// Shrinks as well when edges move inwards or are removed, see updateBoundingRect().
+		///
+		QRectF m_boundingRect;
+
+		///
+		/// \brief Pen used to draw the lines, mirrors the pen of the BaseEdge.
+		///
+		QPen m_pen;
+
+		///
+		/// \brief Pairs of points of all lines drawn in the last call to paint(), reused to avoid allocations.
+		///
+		QVector<QPointF> m_lineBuffer;
+
+		///
+		/// \brief Points of all arrows drawn in the last call to paint(), reused to avoid allocations.
+		///
+		QVector<QPointF> m_arrowBuffer;
+
+		///
+		/// \brief Number of points of each arrow in m_arrowBuffer.
+		///
+		QVector<int> m_arrowSizes;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_STRAIGHTEDGELAYER_H
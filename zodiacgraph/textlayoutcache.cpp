@@ -0,0 +1,60 @@
+#include "textlayoutcache.h"
+
+#include <QTextOption>
+#include <QTransform>
+#include <QtMath>
+
+namespace zodiac
+{
+
+	int TextLayoutCache::s_rotationBuckets = 64;
+	int TextLayoutCache::s_maxLayoutCount = 4096;
+
+	TextLayoutCache::TextLayoutCache()
+			: m_layouts(QHash<Key, Layout>())
+	{
+	}
+
+	TextLayoutCache::Layout TextLayoutCache::getLayout(const QString &text, const QFont &font, qreal rotation,
+	                                                   Qt::Alignment alignment)
+	{
+		// quantize the rotation into [0, s_rotationBuckets)
+		int bucket = qRound(rotation * s_rotationBuckets / (2. * M_PI)) % s_rotationBuckets;
+		if (bucket < 0)
+		{
+			bucket += s_rotationBuckets;
+		}
+
+		Key key{text, font.key(), bucket, int(alignment)};
+		auto it = m_layouts.constFind(key);
+		if (it != m_layouts.constEnd())
+		{
+			return it.value();
+		}
+
+		if (m_layouts.size() >= s_maxLayoutCount)
+		{
+			m_layouts.clear();
+		}
+
+		// shape the text once for the center rotation of its bucket
+		QStaticText staticText(text);
+		staticText.setTextFormat(Qt::PlainText);
+		QTextOption textOption(alignment);
+		textOption.setUseDesignMetrics(false);
+		staticText.setTextOption(textOption);
+		QTransform transform;
+		transform.rotateRadians(bucket * 2. * M_PI / s_rotationBuckets);
+		staticText.prepare(transform, font);
+
+		Layout layout{staticText, staticText.size()};
+		m_layouts.insert(key, layout);
+		return layout;
+	}
+
+	void TextLayoutCache::clear()
+	{
+		m_layouts.clear();
+	}
+
+} // namespace zodiac
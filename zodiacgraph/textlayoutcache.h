@@ -0,0 +1,217 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_TEXTLAYOUTCACHE_H
+#define ZODIAC_TEXTLAYOUTCACHE_H
+
+/// \file textlayoutcache.h
+///
+/// \brief Contains the definition of the zodiac::TextLayoutCache class.
+///
+
+#include <QFont>
+#include <QHash>
+#include <QSizeF>
+#include <QStaticText>
+#include <QString>
+#include <QtGlobal>
+
+namespace zodiac
+{
+
+///
+/// \brief Shaped and measured label texts shared by all NodeLabel%s and PlugLabel%s of a Scene.
+///
+/// Most label texts repeat across the graph ("in", "out", ...), so each distinct combination of text, font, alignment
+/// and rotation is laid out only once and handed out as an implicitly shared QStaticText.
+/// Rotations are quantized into getRotationBuckets() buckets per full turn, so labels pointing in almost the same
+/// direction share their layout.
+///
+/// Once the cache holds getMaxLayoutCount() layouts, it starts over.
+///
+	class Q_DECL_EXPORT TextLayoutCache
+	{
+
+	public: // structs
+
+		///
+		/// \brief A shaped text and its size.
+		///
+		struct Layout
+		{
+			///
+			/// \brief Text prepared for drawing with the font and rotation of its key.
+			///
+			QStaticText text;
+
+			///
+			/// \brief Unrotated size of the text.
+			///
+			QSizeF size;
+		};
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		TextLayoutCache();
+
+		///
+		/// \brief Returns the layout of a text, shaping it first if it is not cached yet.
+		///
+		/// \param [in] text        Plain text to lay out.
+		/// \param [in] font        Font to lay out the text with.
+		/// \param [in] rotation    Rotation of the text in radians, as passed to QTransform::rotateRadians().
+		/// \param [in] alignment   Alignment of the text.
+		///
+		/// \return                 Shaped text and its size.
+		///
+		Layout getLayout(const QString &text, const QFont &font, qreal rotation = 0.,
+		                 Qt::Alignment alignment = Qt::AlignLeft);
+
+		///
+		/// \brief Discards all layouts.
+		///
+		void clear();
+
+		///
+		/// \brief The number of layouts currently in the cache.
+		///
+		/// \return Number of layouts.
+		///
+		inline int size() const { return m_layouts.size(); }
+
+	public: // static methods
+
+		///
+		/// \brief Number of rotation buckets per full turn.
+		///
+		/// \return Rotation buckets.
+		///
+		static inline int getRotationBuckets() { return s_rotationBuckets; }
+
+		///
+		/// \brief Sets the number of rotation buckets per full turn.
+		///
+		/// Call clear() on all caches afterwards.
+		///
+		/// \param [in] buckets New number of buckets, at least one.
+		///
+		static inline void setRotationBuckets(int buckets) { s_rotationBuckets = qMax(1, buckets); }
+
+		///
+		/// \brief Maximum number of layouts in a cache before it starts over.
+		///
+		/// \return Maximum layout count.
+		///
+		static inline int getMaxLayoutCount() { return s_maxLayoutCount; }
+
+		///
+		/// \brief Sets the maximum number of layouts in a cache before it starts over.
+		///
+		/// \param [in] count   New maximum layout count, at least one.
+		///
+		static inline void setMaxLayoutCount(int count) { s_maxLayoutCount = qMax(1, count); }
+
+	private: // structs
+
+		///
+		/// \brief Everything that makes a layout unique.
+		///
+		struct Key
+		{
+			///
+			/// \brief Plain text.
+			///
+			QString text;
+
+			///
+			/// \brief Unique description of the font, as returned by QFont::key().
+			///
+			QString font;
+
+			///
+			/// \brief Rotation bucket.
+			///
+			int rotation;
+
+			///
+			/// \brief Alignment flags.
+			///
+			int alignment;
+
+			///
+			/// \brief Equality operator.
+			///
+			/// \param [in] other   Key to compare with.
+			///
+			/// \return             <i>true</i> if both keys describe the same layout -- <i>false</i> otherwise.
+			///
+			inline bool operator==(const Key &other) const
+			{
+				return (rotation == other.rotation) && (alignment == other.alignment) && (text == other.text)
+				       && (font == other.font);
+			}
+
+			///
+			/// \brief Hash function for QHash.
+			///
+			/// \param [in] key     Key to hash.
+			/// \param [in] seed    Seed of the QHash.
+			///
+			/// \return             Hash value.
+			///
+			friend inline uint qHash(const Key &key, uint seed = 0)
+			{
+				return ::qHash(key.text, seed) ^ (::qHash(key.font) << 1) ^ (uint(key.rotation) << 16)
+				       ^ uint(key.alignment);
+			}
+		};
+
+	private: // members
+
+		///
+		/// \brief All layouts in the cache.
+		///
+		QHash<Key, Layout> m_layouts;
+
+	private: // static members
+
+		///
+		/// \brief Number of rotation buckets per full turn.
+		///
+		static int s_rotationBuckets;
+
+		///
+		/// \brief Maximum number of layouts in a cache.
+		///
+		static int s_maxLayoutCount;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_TEXTLAYOUTCACHE_H
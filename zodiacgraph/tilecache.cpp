@@ -0,0 +1,609 @@
+#include "tilecache.h"
+
+#include <QGraphicsItem>
+#include <QPaintDevice>
+#include <QPainter>
+#include <QRunnable>
+#include <QtMath>
+
+#include "baseedge.h"
+#include "edgearrow.h"
+#include "node.h"
+#include "scene.h"
+#include "straightedge.h"
+#include "straightedgelayer.h"
+#include "view.h"
+
+static quint64 tileKey(int x, int y);
+
+static QPoint tileCoordinates(quint64 key);
+
+static bool isEdgeCached(const zodiac::StraightEdge *edge);
+
+static bool isItemCached(const QGraphicsItem *item);
+
+namespace zodiac
+{
+
+///
+/// \brief Renders a single tile of a TileSnapshot into an image on a worker thread.
+///
+	class TileJob : public QRunnable
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] cache       TileCache to report the finished image to.
+		/// \param [in] snapshot    Snapshot to render from.
+		/// \param [in] key         Key of the tile.
+		/// \param [in] rect        Area of the tile in scene coordinates.
+		/// \param [in] zoom        Zoom factor of the View.
+		/// \param [in] pixelRatio  Device pixel ratio of the View.
+		/// \param [in] epoch       Epoch of the TileCache when the tile was requested.
+		/// \param [in] generation  Generation of the tile when it was requested.
+		///
+		TileJob(TileCache *cache, QSharedDataPointer<TileSnapshot> snapshot, quint64 key, const QRectF &rect,
+		        qreal zoom, qreal pixelRatio, int epoch, quint64 generation)
+				: QRunnable(), m_cache(cache), m_snapshot(snapshot), m_key(key), m_rect(rect), m_zoom(zoom),
+				  m_pixelRatio(pixelRatio), m_epoch(epoch), m_generation(generation)
+		{
+		}
+
+		///
+		/// \brief Renders the tile and posts the image back to the thread of the TileCache.
+		///
+		void run() override
+		{
+			int pixelSize = qCeil(m_rect.width() * m_zoom * m_pixelRatio);
+			QImage image(pixelSize, pixelSize, QImage::Format_ARGB32_Premultiplied);
+			image.setDevicePixelRatio(m_pixelRatio);
+			image.fill(Qt::transparent);
+
+			QPainter painter(&image);
+			painter.setRenderHint(QPainter::Antialiasing);
+			painter.scale(m_zoom, m_zoom);
+			painter.translate(-m_rect.topLeft());
+			m_snapshot.constData()->drawTile(&painter, m_key);
+			painter.end();
+
+			QMetaObject::invokeMethod(m_cache, "finishTile", Qt::QueuedConnection, Q_ARG(quint64, m_key),
+			                          Q_ARG(int, m_epoch), Q_ARG(quint64, m_generation), Q_ARG(QImage, image));
+		}
+
+	private: // members
+
+		///
+		/// \brief TileCache to report the finished image to, outlives the job.
+		///
+		TileCache *m_cache;
+
+		///
+		/// \brief Snapshot to render from, keeps the TileCache from patching it in place.
+		///
+		QSharedDataPointer<TileSnapshot> m_snapshot;
+
+		///
+		/// \brief Key of the tile.
+		///
+		quint64 m_key;
+
+		///
+		/// \brief Area of the tile in scene coordinates.
+		///
+		QRectF m_rect;
+
+		///
+		/// \brief Zoom factor of the View.
+		///
+		qreal m_zoom;
+
+		///
+		/// \brief Device pixel ratio of the View.
+		///
+		qreal m_pixelRatio;
+
+		///
+		/// \brief Epoch of the TileCache when the tile was requested.
+		///
+		int m_epoch;
+
+		///
+		/// \brief Generation of the tile when it was requested.
+		///
+		quint64 m_generation;
+
+	};
+
+	TileSnapshot::TileSnapshot()
+			: QSharedData(), tileSize(0.), coreRadius(0.), nodeColor(QColor()), nodePen(QPen()), edgePen(QPen()),
+			  arrowColor(QColor()), nodeCenters(QVector<QPointF>()), edges(QVector<Edge>()),
+			  tiles(QHash<quint64, QPair<QVector<int>, QVector<int> > >())
+	{
+	}
+
+	void TileSnapshot::drawTile(QPainter *painter, quint64 key) const
+	{
+		auto it = tiles.constFind(key);
+		if (it == tiles.constEnd())
+		{
+			return;
+		}
+		const QVector<int> &tileNodes = it.value().first;
+		const QVector<int> &tileEdges = it.value().second;
+
+		// edges first, with their arrows on top
+		painter->setPen(edgePen);
+		for (int edge: tileEdges)
+		{
+			const QVector<QPointF> &linePoints = edges[edge].linePoints;
+			painter->drawLines(linePoints.constData(), linePoints.size() / 2);
+		}
+		painter->setPen(Qt::NoPen);
+		painter->setBrush(arrowColor);
+		for (int edge: tileEdges)
+		{
+			const QVector<QPointF> &arrowPoints = edges[edge].arrowPoints;
+			if (!arrowPoints.isEmpty())
+			{
+				painter->drawConvexPolygon(arrowPoints.constData(), arrowPoints.size());
+			}
+		}
+
+		// nodes above the edges
+		painter->setPen(nodePen);
+		painter->setBrush(nodeColor);
+		for (int node: tileNodes)
+		{
+			painter->drawEllipse(nodeCenters[node], coreRadius, coreRadius);
+		}
+	}
+
+	int TileCache::s_tileSize = 256;
+
+	TileCache::TileCache(QObject *parent)
+			: QObject(parent), m_scene(nullptr), m_isEnabled(false), m_tiles(QHash<quint64, Tile>()),
+			  m_snapshotItems(FlatHashMap<QGraphicsItem *, SnapshotItem>()), m_freeNodeSlots(QVector<int>()),
+			  m_freeEdgeSlots(QVector<int>()), m_snapshot(QSharedDataPointer<TileSnapshot>()), m_snapshotRange(QRect()),
+			  m_snapshotRect(QRectF()), m_isDrawingArrows(false), m_zoom(0.), m_pixelRatio(1.), m_tileSize(s_tileSize),
+			  m_epoch(0), m_nextGeneration(0)
+	{
+	}
+
+	TileCache::~TileCache()
+	{
+		// the jobs post their images to this object
+		m_threadPool.clear();
+		m_threadPool.waitForDone();
+	}
+
+	void TileCache::setScene(Scene *scene)
+	{
+		if (scene == m_scene)
+		{
+			return;
+		}
+		if (m_scene)
+		{
+			disconnect(m_scene, nullptr, this, nullptr);
+		}
+		m_scene = scene;
+		if (m_scene)
+		{
+			connect(m_scene, SIGNAL(itemChanged(QGraphicsItem *)), this, SLOT(invalidateItem(QGraphicsItem *)));
+			connect(m_scene, SIGNAL(styleChanged()), this, SLOT(clear()));
+		}
+		clear();
+	}
+
+	void TileCache::setEnabled(bool enabled)
+	{
+		m_isEnabled = enabled;
+		clear();
+	}
+
+	void TileCache::draw(QPainter *painter, const QRectF &exposedRect, const QRectF &visibleRect)
+	{
+		if (!m_isEnabled || !m_scene)
+		{
+			return;
+		}
+
+		// the tiles have a fixed size on screen, zooming discards all of them
+		qreal zoom = painter->worldTransform().m11();
+		qreal pixelRatio = painter->device()->devicePixelRatioF();
+		if ((zoom != m_zoom) || (pixelRatio != m_pixelRatio) || (s_tileSize != m_tileSize))
+		{
+			clear();
+			m_zoom = zoom;
+			m_pixelRatio = pixelRatio;
+			m_tileSize = s_tileSize;
+		}
+
+		// keep a ring of tiles around the visible ones, so they are ready when the View is panned
+		QRect range = getTileRange(visibleRect).adjusted(-1, -1, 1, 1);
+		if (range != m_snapshotRange)
+		{
+			takeSnapshot(range);
+		}
+
+		// request every tile in range that is neither valid nor already being rendered
+		for (int y = range.top(); y <= range.bottom(); ++y)
+		{
+			for (int x = range.left(); x <= range.right(); ++x)
+			{
+				quint64 key = tileKey(x, y);
+				auto it = m_tiles.find(key);
+				if (it == m_tiles.end())
+				{
+					it = m_tiles.insert(key, Tile{QImage(), ++m_nextGeneration, false, false});
+				}
+				if (it->isValid || it->isPending)
+				{
+					continue;
+				}
+				it->isPending = true;
+				m_threadPool.start(new TileJob(this, m_snapshot, key, getTileRect(QRect(x, y, 1, 1)), m_zoom,
+				                               m_pixelRatio, m_epoch, it->generation));
+			}
+		}
+
+		// draw the exposed tiles, the invalid ones directly from the snapshot
+		QRect exposedRange = getTileRange(exposedRect).intersected(range);
+		painter->save();
+		for (int y = exposedRange.top(); y <= exposedRange.bottom(); ++y)
+		{
+			for (int x = exposedRange.left(); x <= exposedRange.right(); ++x)
+			{
+				quint64 key = tileKey(x, y);
+				QRectF tileRect = getTileRect(QRect(x, y, 1, 1));
+				const Tile &tile = m_tiles[key];
+				if (tile.isValid)
+				{
+					painter->drawImage(tileRect, tile.image);
+				} else
+				{
+					painter->save();
+					painter->setClipRect(tileRect, Qt::IntersectClip);
+					m_snapshot.constData()->drawTile(painter, key);
+					painter->restore();
+				}
+			}
+		}
+		painter->restore();
+	}
+
+	void TileCache::clear()
+	{
+		++m_epoch;
+		m_threadPool.clear();
+		m_tiles.clear();
+		m_snapshotItems.clear();
+		m_freeNodeSlots.clear();
+		m_freeEdgeSlots.clear();
+		m_snapshot = QSharedDataPointer<TileSnapshot>();
+		m_snapshotRange = QRect();
+		m_snapshotRect = QRectF();
+	}
+
+	void TileCache::invalidateItem(QGraphicsItem *item)
+	{
+		if (!m_isEnabled || m_snapshotRect.isNull())
+		{
+			return;
+		}
+
+		// only the tiles under the item change, all others keep their images
+		invalidateRect(removeFromSnapshot(item));
+		if (isStatic(item))
+		{
+			invalidateRect(addToSnapshot(item));
+		}
+	}
+
+	void TileCache::finishTile(quint64 key, int epoch, quint64 generation, const QImage &image)
+	{
+		if (epoch != m_epoch)
+		{
+			return;
+		}
+		auto it = m_tiles.find(key);
+		if (it == m_tiles.end())
+		{
+			return;
+		}
+		it->isPending = false;
+
+		// a tile invalidated while it was rendered is requested again with the next draw
+		if (it->generation == generation)
+		{
+			it->image = image;
+			it->isValid = true;
+		}
+	}
+
+	void TileCache::takeSnapshot(const QRect &range)
+	{
+		QRectF rect = getTileRect(range);
+		m_snapshot = QSharedDataPointer<TileSnapshot>(new TileSnapshot());
+		m_snapshot->tileSize = m_tileSize / m_zoom;
+		m_snapshot->coreRadius = Node::getCoreRadius();
+		m_snapshot->nodeColor = Node::getIdleColor();
+		if (Node::getCoreRadius() * m_zoom >= View::getMinDetailSize())
+		{
+			m_snapshot->nodePen = QPen(QBrush(Node::getOutlineColor()), Node::getOutlineWidth());
+		} else
+		{
+			m_snapshot->nodePen = QPen(Qt::NoPen);
+		}
+		m_snapshot->edgePen = QPen(QBrush(BaseEdge::getBaseColor()), BaseEdge::getBaseWidth(), Qt::SolidLine,
+		                           Qt::RoundCap);
+		m_snapshot->arrowColor = EdgeArrow::getArrowColor();
+		m_isDrawingArrows = EdgeArrow::getArrowLength() * m_zoom >= View::getMinReadableSize();
+		m_snapshotItems.clear();
+		m_freeNodeSlots.clear();
+		m_freeEdgeSlots.clear();
+		m_snapshotRange = range;
+		m_snapshotRect = rect;
+
+		// copy the static items, batched StraightEdge%s are not part of the Scene
+		for (QGraphicsItem *item: m_scene->getItemsIn(rect))
+		{
+			if (isStatic(item))
+			{
+				addToSnapshot(item);
+			}
+		}
+		StraightEdgeLayer *edgeLayer = m_scene->getStraightEdgeLayer();
+		if (edgeLayer->isBatching())
+		{
+			for (StraightEdge *edge: edgeLayer->getEdgesIn(rect))
+			{
+				if (isStatic(edge))
+				{
+					addToSnapshot(edge);
+				}
+			}
+		}
+
+		// tiles that left the range are not kept up to date anymore
+		for (auto it = m_tiles.begin(); it != m_tiles.end();)
+		{
+			if (range.contains(tileCoordinates(it.key())))
+			{
+				++it;
+			} else
+			{
+				it = m_tiles.erase(it);
+			}
+		}
+	}
+
+	bool TileCache::isStatic(QGraphicsItem *item) const
+	{
+		QGraphicsObject *object = item->toGraphicsObject();
+		if (!object || isItemCached(item))
+		{
+			return false;
+		}
+		if (Node *node = qobject_cast<Node *>(object))
+		{
+			return (node->scene() == m_scene) && node->isVisible() && node->isTileable();
+		}
+		StraightEdge *edge = qobject_cast<StraightEdge *>(object);
+		if (!edge || isEdgeCached(edge) || !edge->isTileable())
+		{
+			return false;
+		}
+		if (edge->scene() == m_scene)
+		{
+			return edge->isVisible();
+		}
+		StraightEdgeLayer *edgeLayer = m_scene->getStraightEdgeLayer();
+		return edgeLayer->isBatching() && edgeLayer->isDrawn(edge);
+	}
+
+	QRectF TileCache::addToSnapshot(QGraphicsItem *item)
+	{
+		// copy the geometry of the item
+		SnapshotItem snapshotItem{QRectF(), -1, false};
+		QPointF nodeCenter;
+		TileSnapshot::Edge edgeGeometry;
+		if (Node *node = qobject_cast<Node *>(item->toGraphicsObject()))
+		{
+			qreal nodeExtent = Node::getCoreRadius() + (Node::getOutlineWidth() / 2.);
+			nodeCenter = node->scenePos();
+			snapshotItem.rect = QRectF(nodeCenter.x() - nodeExtent, nodeCenter.y() - nodeExtent, nodeExtent * 2.,
+			                           nodeExtent * 2.);
+			snapshotItem.isNode = true;
+		} else
+		{
+			StraightEdge *edge = static_cast<StraightEdge *>(item->toGraphicsObject());
+			edge->appendLines(edgeGeometry.linePoints);
+			if (m_isDrawingArrows)
+			{
+				QPointF offset = edge->pos();
+				for (const QPointF &point: edge->getArrow()->getPolygon())
+				{
+					edgeGeometry.arrowPoints.append(point + offset);
+				}
+			}
+			qreal edgeExtent = BaseEdge::getBaseWidth() / 2.;
+			QPolygonF outline(edgeGeometry.linePoints);
+			outline += edgeGeometry.arrowPoints;
+			snapshotItem.rect = outline.boundingRect().marginsAdded(
+					QMarginsF(edgeExtent, edgeExtent, edgeExtent, edgeExtent));
+		}
+		QRect itemRange = getTileRange(snapshotItem.rect).intersected(m_snapshotRange);
+		if (itemRange.isEmpty())
+		{
+			return QRectF();
+		}
+
+		// store it in a free slot, detaches the snapshot if it is still being rendered
+		if (snapshotItem.isNode)
+		{
+			if (m_freeNodeSlots.isEmpty())
+			{
+				snapshotItem.slot = m_snapshot->nodeCenters.size();
+				m_snapshot->nodeCenters.append(nodeCenter);
+			} else
+			{
+				snapshotItem.slot = m_freeNodeSlots.takeLast();
+				m_snapshot->nodeCenters[snapshotItem.slot] = nodeCenter;
+			}
+		} else
+		{
+			if (m_freeEdgeSlots.isEmpty())
+			{
+				snapshotItem.slot = m_snapshot->edges.size();
+				m_snapshot->edges.append(edgeGeometry);
+			} else
+			{
+				snapshotItem.slot = m_freeEdgeSlots.takeLast();
+				m_snapshot->edges[snapshotItem.slot] = edgeGeometry;
+			}
+		}
+		m_snapshotItems.insert(item, snapshotItem);
+
+		// sort it into the tiles it touches
+		for (int y = itemRange.top(); y <= itemRange.bottom(); ++y)
+		{
+			for (int x = itemRange.left(); x <= itemRange.right(); ++x)
+			{
+				QPair<QVector<int>, QVector<int> > &content = m_snapshot->tiles[tileKey(x, y)];
+				(snapshotItem.isNode ? content.first : content.second).append(snapshotItem.slot);
+			}
+		}
+		return snapshotItem.rect;
+	}
+
+	QRectF TileCache::removeFromSnapshot(QGraphicsItem *item)
+	{
+		SnapshotItem snapshotItem = m_snapshotItems.value(item, SnapshotItem{QRectF(), -1, false});
+		if (snapshotItem.slot < 0)
+		{
+			return QRectF();
+		}
+		m_snapshotItems.remove(item);
+
+		// take it out of the tiles it touched
+		QRect itemRange = getTileRange(snapshotItem.rect).intersected(m_snapshotRange);
+		for (int y = itemRange.top(); y <= itemRange.bottom(); ++y)
+		{
+			for (int x = itemRange.left(); x <= itemRange.right(); ++x)
+			{
+				auto it = m_snapshot->tiles.find(tileKey(x, y));
+				if (it != m_snapshot->tiles.end())
+				{
+					(snapshotItem.isNode ? it->first : it->second).removeOne(snapshotItem.slot);
+				}
+			}
+		}
+
+		// free its slot
+		if (snapshotItem.isNode)
+		{
+			m_freeNodeSlots.append(snapshotItem.slot);
+		} else
+		{
+			m_snapshot->edges[snapshotItem.slot] = TileSnapshot::Edge();
+			m_freeEdgeSlots.append(snapshotItem.slot);
+		}
+		return snapshotItem.rect;
+	}
+
+	void TileCache::invalidateRect(const QRectF &rect)
+	{
+		QRectF visibleRect = rect.intersected(m_snapshotRect);
+		if (visibleRect.isEmpty())
+		{
+			return;
+		}
+
+		QRect range = getTileRange(visibleRect);
+		for (int y = range.top(); y <= range.bottom(); ++y)
+		{
+			for (int x = range.left(); x <= range.right(); ++x)
+			{
+				auto it = m_tiles.find(tileKey(x, y));
+				if (it != m_tiles.end())
+				{
+					it->image = QImage();
+					it->generation = ++m_nextGeneration;
+					it->isValid = false;
+				}
+			}
+		}
+	}
+
+	QRect TileCache::getTileRange(const QRectF &rect) const
+	{
+		qreal size = m_tileSize / m_zoom;
+		return QRect(QPoint(qFloor(rect.left() / size), qFloor(rect.top() / size)),
+		             QPoint(qFloor(rect.right() / size), qFloor(rect.bottom() / size)));
+	}
+
+	QRectF TileCache::getTileRect(const QRect &range) const
+	{
+		qreal size = m_tileSize / m_zoom;
+		return QRectF(range.left() * size, range.top() * size, range.width() * size, range.height() * size);
+	}
+
+} // namespace zodiac
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER
+//
+
+///
+/// \brief Packs the coordinates of a tile into a single key.
+///
+/// \param [in] x   Horizontal tile coordinate.
+/// \param [in] y   Vertical tile coordinate.
+///
+/// \return         Key of the tile.
+///
+static quint64 tileKey(int x, int y)
+{
+	return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+}
+
+///
+/// \brief Unpacks the coordinates of a tile from its key.
+///
+/// \param [in] key Key of the tile.
+///
+/// \return         Coordinates of the tile.
+///
+static QPoint tileCoordinates(quint64 key)
+{
+	return QPoint(int(quint32(key >> 32)), int(quint32(key)));
+}
+
+///
+/// \brief Checks if a StraightEdge or its EdgeArrow is painted into a Qt item cache.
+///
+/// \param [in] edge    Edge to test.
+///
+/// \return             <i>true</i> if the edge or its arrow use a cache mode other than QGraphicsItem::NoCache.
+///
+static bool isEdgeCached(const zodiac::StraightEdge *edge)
+{
+	return isItemCached(edge) || isItemCached(edge->getArrow());
+}
+
+///
+/// \brief Checks if an item is painted into a Qt item cache.
+///
+/// \param [in] item    Item to test.
+///
+/// \return             <i>true</i> if the item uses a cache mode other than QGraphicsItem::NoCache.
+///
+static bool isItemCached(const QGraphicsItem *item)
+{
+	return item->cacheMode() != QGraphicsItem::NoCache;
+}
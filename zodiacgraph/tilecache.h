@@ -0,0 +1,476 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_TILECACHE_H
+#define ZODIAC_TILECACHE_H
+
+/// \file tilecache.h
+///
+/// \brief Contains the definition of the zodiac::TileCache class.
+///
+
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QPen>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QThreadPool>
+#include <QVector>
+#include <QtGlobal>
+
+#include "flathashmap.h"
+
+class QGraphicsItem;
+
+class QPainter;
+
+namespace zodiac
+{
+
+	class Scene;
+
+///
+/// \brief The static content of the area around a View, copied from the items of a Scene.
+///
+/// Is shared implicitly with the worker threads, which only read from it.
+/// The TileCache patches single items into its own copy, which is only detached while jobs still hold the old one.
+/// Removed items leave a free slot behind, that is reused by the next item of the same kind.
+///
+	class Q_DECL_EXPORT TileSnapshot final : public QSharedData
+	{
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		TileSnapshot();
+
+		///
+		/// \brief Draws the content of a single tile.
+		///
+		/// Is called from worker threads and only reads from the snapshot.
+		///
+		/// \param [in] painter Painter in scene coordinates.
+		/// \param [in] key     Key of the tile to draw.
+		///
+		void drawTile(QPainter *painter, quint64 key) const;
+
+	public: // structs
+
+		///
+		/// \brief Geometry of a single edge in scene coordinates.
+		///
+		struct Edge
+		{
+			///
+			/// \brief Pairs of points of the edge lines.
+			///
+			QVector<QPointF> linePoints;
+
+			///
+			/// \brief Points of the EdgeArrow, empty if it is too small to be drawn.
+			///
+			QVector<QPointF> arrowPoints;
+		};
+
+	public: // members
+
+		///
+		/// \brief Width and height of a tile in scene coordinates.
+		///
+		qreal tileSize;
+
+		///
+		/// \brief Core radius of all Node%s.
+		///
+		qreal coreRadius;
+
+		///
+		/// \brief Fill color of the Node cores.
+		///
+		QColor nodeColor;
+
+		///
+		/// \brief Outline of the Node cores, no pen if they are too small to be drawn in detail.
+		///
+		QPen nodePen;
+
+		///
+		/// \brief Pen used to draw the edges.
+		///
+		QPen edgePen;
+
+		///
+		/// \brief Fill color of the EdgeArrow%s.
+		///
+		QColor arrowColor;
+
+		///
+		/// \brief Center of each Node in scene coordinates, indexed by slot.
+		///
+		QVector<QPointF> nodeCenters;
+
+		///
+		/// \brief Geometry of each edge, indexed by slot.
+		///
+		QVector<Edge> edges;
+
+		///
+		/// \brief Slots of the Node%s and the edges touching each tile.
+		///
+		QHash<quint64, QPair<QVector<int>, QVector<int> > > tiles;
+
+	};
+
+///
+/// \brief Renders the static content of a Scene into cached image tiles on background threads.
+///
+/// The static content are all tileable Node%s and StraightEdge%s with their EdgeArrow%s (see Node::isTileable() and
+/// BaseEdge::isTileable()), which skip their paint() call for a tiled View (see View::isTiled()).
+/// They are copied into a snapshot, which is rendered tile by tile into QImage%s on a QThreadPool.
+/// The View draws the tiles as part of its background, everything else is painted live on top.
+///
+/// Tiles are square and have a fixed size on screen, changing the zoom of the View discards all of them.
+/// Whenever a Node or an edge changes, only that item is patched in the snapshot and only the tiles under its old and
+/// new geometry are invalidated.
+/// Invalid tiles in view are drawn directly from the snapshot, until their image was rendered anew -- so the tiles never
+/// show stale content and the static items do not need to know whether the tile under them is ready.
+/// Tiles around the visible area are rendered ahead, so panning into them only needs to draw their images.
+///
+	class Q_DECL_EXPORT TileCache : public QObject
+	{
+	Q_OBJECT
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] parent  Parent object, usually the View.
+		///
+		explicit TileCache(QObject *parent);
+
+		///
+		/// \brief Destructor.
+		///
+		/// Waits for all tiles that are currently being rendered.
+		///
+		~TileCache();
+
+		///
+		/// \brief Changes the Scene whose content is cached.
+		///
+		/// \param [in] scene   New Scene, may be <i>nullptr</i>.
+		///
+		void setScene(Scene *scene);
+
+		///
+		/// \brief Enables or disables the cache.
+		///
+		/// Disabling the cache discards all tiles.
+		///
+		/// \param [in] enabled <i>true</i> to cache the static content -- <i>false</i> to paint everything live.
+		///
+		void setEnabled(bool enabled);
+
+		///
+		/// \brief Tests whether the cache is enabled.
+		///
+		/// \return <i>true</i> if the static content is drawn from the tiles -- <i>false</i> otherwise.
+		///
+		inline bool isEnabled() const { return m_isEnabled; }
+
+		///
+		/// \brief Draws the static content in the exposed area.
+		///
+		/// \param [in] painter     Painter drawing the background of the View, in scene coordinates.
+		/// \param [in] exposedRect Area to draw in scene coordinates.
+		/// \param [in] visibleRect Area visible in the View, tiles around it are rendered ahead.
+		///
+		void draw(QPainter *painter, const QRectF &exposedRect, const QRectF &visibleRect);
+
+	public: // static methods
+
+		///
+		/// \brief The width and height of a tile in pixels.
+		///
+		/// \return Size of a tile.
+		///
+		static inline int getTileSize() { return s_tileSize; }
+
+		///
+		/// \brief Sets a new width and height of the tiles in pixels.
+		///
+		/// Only applies to the tiles of a View after it was zoomed or after View::updateStyle() was called.
+		///
+		/// \param [in] size    New size of a tile, at least 16 pixels.
+		///
+		static inline void setTileSize(int size) { s_tileSize = qMax(16, size); }
+
+	public slots:
+
+		///
+		/// \brief Discards all tiles.
+		///
+		void clear();
+
+		///
+		/// \brief Patches an item in the snapshot and invalidates the tiles under its old and its current geometry.
+		///
+		/// \param [in] item    Node or edge that has changed.
+		///
+		void invalidateItem(QGraphicsItem *item);
+
+	private slots:
+
+		///
+		/// \brief Called from a worker thread, when the image of a tile was rendered.
+		///
+		/// The image is only used if the tile was not invalidated in the meantime.
+		///
+		/// \param [in] key         Key of the tile.
+		/// \param [in] epoch       Value of m_epoch when the tile was requested.
+		/// \param [in] generation  Generation of the tile when it was requested.
+		/// \param [in] image       Rendered image.
+		///
+		void finishTile(quint64 key, int epoch, quint64 generation, const QImage &image);
+
+	private: // methods
+
+		///
+		/// \brief Copies the static content of a range of tiles from the Scene.
+		///
+		/// Also discards all tiles outside of the range.
+		///
+		/// \param [in] range   Range of tiles to copy, both ends inclusive.
+		///
+		void takeSnapshot(const QRect &range);
+
+		///
+		/// \brief Tests, whether an item is part of the static content.
+		///
+		/// Items with a Qt item cache are painted into a pixmap shared by all View%s (with a null widget), so they
+		/// cannot skip their paint() call for a tiled View and are always painted live instead.
+		///
+		/// \param [in] item    Item to test.
+		///
+		/// \return             <i>true</i> if the item is a tileable Node or StraightEdge, that is drawn in the Scene
+		///                     -- <i>false</i> otherwise.
+		///
+		bool isStatic(QGraphicsItem *item) const;
+
+		///
+		/// \brief Copies the geometry of a static item into the snapshot and sorts it into the tiles it touches.
+		///
+		/// \param [in] item    Static Node or StraightEdge, that is not part of the snapshot yet.
+		///
+		/// \return             Rectangle of the item in scene coordinates, null if it is outside of the snapshot.
+		///
+		QRectF addToSnapshot(QGraphicsItem *item);
+
+		///
+		/// \brief Removes an item from the snapshot and frees its slot.
+		///
+		/// \param [in] item    Item to remove, may already be partially destroyed.
+		///
+		/// \return             Rectangle of the item in scene coordinates, null if it was not part of the snapshot.
+		///
+		QRectF removeFromSnapshot(QGraphicsItem *item);
+
+		///
+		/// \brief Invalidates all tiles intersecting a rectangle.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		void invalidateRect(const QRectF &rect);
+
+		///
+		/// \brief The range of tiles covering a rectangle in scene coordinates.
+		///
+		/// \param [in] rect    Rectangle in scene coordinates.
+		///
+		/// \return             Range of tile coordinates, both ends inclusive.
+		///
+		QRect getTileRange(const QRectF &rect) const;
+
+		///
+		/// \brief The area covered by a range of tiles.
+		///
+		/// \param [in] range   Range of tile coordinates, both ends inclusive.
+		///
+		/// \return             Rectangle in scene coordinates.
+		///
+		QRectF getTileRect(const QRect &range) const;
+
+	private: // structs
+
+		///
+		/// \brief A single cached tile.
+		///
+		struct Tile
+		{
+			///
+			/// \brief Rendered content of the tile, only valid if isValid is set.
+			///
+			QImage image;
+
+			///
+			/// \brief Is increased every time the tile is invalidated, to discard outdated images.
+			///
+			quint64 generation;
+
+			///
+			/// \brief Whether the image shows the current content of the tile.
+			///
+			bool isValid;
+
+			///
+			/// \brief Whether the tile is currently being rendered by a worker thread.
+			///
+			bool isPending;
+		};
+
+		///
+		/// \brief An item in the current snapshot.
+		///
+		struct SnapshotItem
+		{
+			///
+			/// \brief Rectangle of the item in scene coordinates.
+			///
+			QRectF rect;
+
+			///
+			/// \brief Slot of the item in TileSnapshot::nodeCenters or TileSnapshot::edges, -1 if it is not in the
+			/// snapshot.
+			///
+			int slot;
+
+			///
+			/// \brief Whether the item is a Node or an edge.
+			///
+			bool isNode;
+		};
+
+	private: // members
+
+		///
+		/// \brief Scene whose content is cached.
+		///
+		Scene *m_scene;
+
+		///
+		/// \brief Whether the cache is enabled.
+		///
+		bool m_isEnabled;
+
+		///
+		/// \brief All tiles around the visible area.
+		///
+		QHash<quint64, Tile> m_tiles;
+
+		///
+		/// \brief Every item in the current snapshot.
+		///
+		FlatHashMap<QGraphicsItem *, SnapshotItem> m_snapshotItems;
+
+		///
+		/// \brief Unused slots in TileSnapshot::nodeCenters.
+		///
+		QVector<int> m_freeNodeSlots;
+
+		///
+		/// \brief Unused slots in TileSnapshot::edges.
+		///
+		QVector<int> m_freeEdgeSlots;
+
+		///
+		/// \brief The current snapshot, shared with the worker threads.
+		///
+		QSharedDataPointer<TileSnapshot> m_snapshot;
+
+		///
+		/// \brief Range of tiles covered by the current snapshot, both ends inclusive.
+		///
+		QRect m_snapshotRange;
+
+		///
+		/// \brief Area covered by the current snapshot, in scene coordinates, null if there is no snapshot.
+		///
+		QRectF m_snapshotRect;
+
+		///
+		/// \brief Whether the EdgeArrow%s are large enough to be part of the snapshot.
+		///
+		bool m_isDrawingArrows;
+
+		///
+		/// \brief Zoom factor of the View the tiles were rendered for.
+		///
+		qreal m_zoom;
+
+		///
+		/// \brief Device pixel ratio of the View the tiles were rendered for.
+		///
+		qreal m_pixelRatio;
+
+		///
+		/// \brief Width and height of the tiles in pixels, fixed until the tiles are discarded.
+		///
+		int m_tileSize;
+
+		///
+		/// \brief Is increased by clear(), to discard all images requested before.
+		///
+		int m_epoch;
+
+		///
+		/// \brief Source of unique tile generations.
+		///
+		quint64 m_nextGeneration;
+
+		///
+		/// \brief Threads rendering the tiles.
+		///
+		QThreadPool m_threadPool;
+
+	private: // static members
+
+		///
+		/// \brief Width and height of a tile in pixels.
+		///
+		static int s_tileSize;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_TILECACHE_H
@@ -7,16 +7,21 @@
 
 #include <QApplication>
 #include <QDebug>
+#include <QPainter>
 #include <QPanGesture>
 #include <QPinchGesture>
 #include <QScrollBar>
+#include <QStyleOptionGraphicsItem>
 #include <QWheelEvent>
 
 #if PRINT_REDRAW_SPEED
 #include <QElapsedTimer>
 #endif
 
+#include "clusterlayer.h"
 #include "scene.h"
+#include "tilecache.h"
+#include "viewportlayer.h"
 
 namespace zodiac
 {
@@ -29,10 +34,14 @@ namespace zodiac
 	int View::s_activationKey = Qt::Key_Return;
 	qreal View::s_minZoomFactor = 0.1;
 	qreal View::s_maxZoomFactor = 2.0;
+	qreal View::s_minReadableSize = 5.;
+	qreal View::s_minDetailSize = 5.;
 
 	View::View(QWidget *parent)
-			: QGraphicsView(parent), m_zoomFactor(1.0)
+			: QGraphicsView(parent), m_zoomFactor(1.0), m_tileCache(nullptr)
 	{
+		m_tileCache = new TileCache(this);
+
 		setBackgroundBrush(QBrush(s_backgroundColor));
 		setCacheMode(QGraphicsView::CacheBackground);
 		setRenderHints(QPainter::Antialiasing);
@@ -51,9 +60,29 @@ namespace zodiac
 		setBackgroundBrush(QBrush(s_backgroundColor));
 
 		// force a redraw for good measure
+		m_tileCache->clear();
 		resetCachedContent();
 	}
 
+	void View::setTileCacheEnabled(bool enabled)
+	{
+		if (enabled == m_tileCache->isEnabled())
+		{
+			return;
+		}
+		m_tileCache->setEnabled(enabled);
+
+		// the tiles change with the content, so the background cannot be cached as a whole
+		setCacheMode(enabled ? QGraphicsView::CacheNone : QGraphicsView::CacheBackground);
+		resetCachedContent();
+		viewport()->update();
+	}
+
+	bool View::isTileCacheEnabled() const
+	{
+		return m_tileCache->isEnabled();
+	}
+
 	bool View::event(QEvent *event)
 	{
 		event->accept();
@@ -101,6 +130,8 @@ namespace zodiac
 				// scale the view
 				scale(zoomDelta, zoomDelta);
 				m_zoomFactor *= zoomDelta;
+				updateClusterZoom();
+				updateVisibleRect();
 
 				return true;
 			}
@@ -136,12 +167,10 @@ namespace zodiac
 
 	void View::mousePressEvent(QMouseEvent *event)
 	{
-		static const QTransform nullTransform = QTransform();
-
 		if (event->button() == s_dragMoveButton)
 		{
 			// only allow scroll dragging if no item is clicked
-			if (!scene()->itemAt(mapToScene(event->pos()), nullTransform))
+			if (!static_cast<Scene *>(scene())->getItemAt(mapToScene(event->pos())))
 			{
 				setDragMode(QGraphicsView::ScrollHandDrag);
 				QMouseEvent fakeEvent(event->type(), event->pos(), Qt::LeftButton, Qt::LeftButton, event->modifiers());
@@ -180,7 +209,7 @@ namespace zodiac
 		if (event->buttons() & s_selectionButton)
 		{
 			// double clicking into empty space collapse all nodes
-			if (!itemAt(event->pos()))
+			if (!static_cast<Scene *>(scene())->getItemAt(mapToScene(event->pos())))
 			{
 				static_cast<Scene *>(scene())->collapseAllNodes();
 			}
@@ -204,6 +233,8 @@ namespace zodiac
 		// scale the view
 		scale(zoomDelta, zoomDelta);
 		m_zoomFactor *= zoomDelta;
+		updateClusterZoom();
+		updateVisibleRect();
 
 		// do not call QGraphicsView::wheelEvent here, because it will scroll up or down as well as zoom
 		return;
@@ -218,6 +249,13 @@ namespace zodiac
 		timer.start();
 #endif
 
+		// the dirty edges were rebuilt by the scene before it processed its changes
+		Scene *zodiacScene = qobject_cast<Scene *>(scene());
+		if (zodiacScene)
+		{
+			zodiacScene->getItemCache().beginFrame();
+		}
+
 		QGraphicsView::paintEvent(event);
 
 #if PRINT_REDRAW_SPEED
@@ -232,9 +270,65 @@ namespace zodiac
 #endif
 	}
 
+	void View::resizeEvent(QResizeEvent *event)
+	{
+		QGraphicsView::resizeEvent(event);
+		updateVisibleRect();
+	}
+
+	void View::scrollContentsBy(int dx, int dy)
+	{
+		QGraphicsView::scrollContentsBy(dx, dy);
+		updateVisibleRect();
+	}
+
 	void View::setScene(Scene *scene)
 	{
 		QGraphicsView::setScene(scene);
+		m_tileCache->setScene(scene);
+		updateClusterZoom();
+		updateVisibleRect();
+	}
+
+	bool View::isReadable(qreal size, const QPainter *painter)
+	{
+		return size * QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()) >= s_minReadableSize;
+	}
+
+	bool View::isDetailed(qreal radius, const QPainter *painter)
+	{
+		return radius * QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform()) >= s_minDetailSize;
+	}
+
+	bool View::isTiled(const QWidget *widget)
+	{
+		// items are painted on the viewport, whose parent is the View
+		const View *view = widget ? qobject_cast<const View *>(widget->parentWidget()) : nullptr;
+		return view && view->m_tileCache->isEnabled();
+	}
+
+	void View::drawBackground(QPainter *painter, const QRectF &rect)
+	{
+		QGraphicsView::drawBackground(painter, rect);
+		m_tileCache->draw(painter, rect, mapToScene(viewport()->rect()).boundingRect());
+	}
+
+	void View::updateClusterZoom()
+	{
+		Scene *zodiacScene = qobject_cast<Scene *>(scene());
+		if (zodiacScene)
+		{
+			zodiacScene->getClusterLayer()->updateZoom(m_zoomFactor);
+		}
+	}
+
+	void View::updateVisibleRect()
+	{
+		Scene *zodiacScene = qobject_cast<Scene *>(scene());
+		if (zodiacScene)
+		{
+			zodiacScene->getViewportLayer()->setVisibleRect(mapToScene(viewport()->rect()).boundingRect());
+		}
 	}
 
 } // namespace zodiac
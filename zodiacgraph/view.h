@@ -40,6 +40,10 @@ class QGestureEvent;
 
 class QMouseEvent;
 
+class QPainter;
+
+class QResizeEvent;
+
 class QWheelEvent;
 
 ///
@@ -53,6 +57,8 @@ namespace zodiac
 
 	class Scene;
 
+	class TileCache;
+
 ///
 /// \brief Widget that displays the contents of a Scene.
 ///
@@ -90,6 +96,23 @@ namespace zodiac
 		///
 		void updateStyle();
 
+		///
+		/// \brief Enables or disables drawing the static content of the Scene from cached tiles.
+		///
+		/// See TileCache for details.
+		///
+		/// \param [in] enabled <i>true</i> to draw collapsed Node%s and StraightEdge%s from tiles -- <i>false</i> to paint
+		///                     every item live.
+		///
+		void setTileCacheEnabled(bool enabled);
+
+		///
+		/// \brief Tests whether the static content of the Scene is drawn from cached tiles.
+		///
+		/// \return <i>true</i> if the TileCache is enabled -- <i>false</i> otherwise.
+		///
+		bool isTileCacheEnabled() const;
+
 	public: // static methods
 
 		///
@@ -178,6 +201,100 @@ namespace zodiac
 		///
 		static inline void setActivationKey(int key) { s_activationKey = key; }
 
+		///
+		/// \brief The smallest zoom factor of all View%s.
+		///
+		/// \return Minimal zoom factor.
+		///
+		static inline qreal getMinZoomFactor() { return s_minZoomFactor; }
+
+		///
+		/// \brief Sets the smallest zoom factor of all View%s.
+		///
+		/// \param [in] factor  New minimal zoom factor, larger than zero.
+		///
+		static inline void setMinZoomFactor(qreal factor) { s_minZoomFactor = qMax(0.001, factor); }
+
+		///
+		/// \brief The largest zoom factor of all View%s.
+		///
+		/// \return Maximal zoom factor.
+		///
+		static inline qreal getMaxZoomFactor() { return s_maxZoomFactor; }
+
+		///
+		/// \brief Sets the largest zoom factor of all View%s.
+		///
+		/// \param [in] factor  New maximal zoom factor.
+		///
+		static inline void setMaxZoomFactor(qreal factor) { s_maxZoomFactor = factor; }
+
+		///
+		/// \brief The smallest size on screen in pixels, at which text and EdgeArrow%s are still drawn.
+		///
+		/// \return Minimal readable size.
+		///
+		static inline qreal getMinReadableSize() { return s_minReadableSize; }
+
+		///
+		/// \brief Sets the smallest size on screen in pixels, at which text and EdgeArrow%s are still drawn.
+		///
+		/// \param [in] size    New minimal readable size in pixels.
+		///
+		static inline void setMinReadableSize(qreal size) { s_minReadableSize = qMax(0., size); }
+
+		///
+		/// \brief The smallest core radius on screen in pixels, at which Node%s and PlugEdge%s are drawn in detail.
+		///
+		/// Below, Node%s are drawn as flat dots without Plug%s and PlugEdge%s as straight lines.
+		///
+		/// \return Minimal detail size.
+		///
+		static inline qreal getMinDetailSize() { return s_minDetailSize; }
+
+		///
+		/// \brief Sets the smallest core radius on screen in pixels, at which Node%s and PlugEdge%s are drawn in detail.
+		///
+		/// \param [in] size    New minimal detail size in pixels.
+		///
+		static inline void setMinDetailSize(qreal size) { s_minDetailSize = qMax(0., size); }
+
+		///
+		/// \brief Tests whether text or a symbol is large enough on screen to be drawn.
+		///
+		/// The scale is taken from the world transformation of the painter, as with
+		/// QStyleOptionGraphicsItem::levelOfDetailFromTransform().
+		///
+		/// \param [in] size    Size in item coordinates, for text the point size of its font.
+		/// \param [in] painter Painter about to draw the item.
+		///
+		/// \return             <i>true</i> if the item is readable -- <i>false</i> if it can be skipped.
+		///
+		static bool isReadable(qreal size, const QPainter *painter);
+
+		///
+		/// \brief Tests whether a Node of the given core radius is large enough on screen to be drawn in detail.
+		///
+		/// \param [in] radius  Core radius of the Node in item coordinates.
+		/// \param [in] painter Painter about to draw the item.
+		///
+		/// \return             <i>true</i> if the item is drawn in detail -- <i>false</i> if it is drawn simplified.
+		///
+		static bool isDetailed(qreal radius, const QPainter *painter);
+
+		///
+		/// \brief Tests whether the static items painted on the given widget are already drawn by a TileCache.
+		///
+		/// Items with a Qt item cache are painted into their cache with a <i>nullptr</i> widget and are never tiled, the
+		/// TileCache leaves them out of its tiles.
+		///
+		/// \param [in] widget  Widget passed to QGraphicsItem::paint(), may be <i>nullptr</i>.
+		///
+		/// \return             <i>true</i> if the widget is the viewport of a View with an enabled TileCache --
+		///                     <i>false</i> otherwise.
+		///
+		static bool isTiled(const QWidget *widget);
+
 	protected: // methods
 
 		///
@@ -244,6 +361,41 @@ namespace zodiac
 		///
 		void paintEvent(QPaintEvent *event);
 
+		///
+		/// \brief Called when the viewport is resized.
+		///
+		/// \param [in] event   Qt event object.
+		///
+		void resizeEvent(QResizeEvent *event);
+
+		///
+		/// \brief Called when the contents of the viewport are scrolled.
+		///
+		/// \param [in] dx  Horizontal distance in pixels.
+		/// \param [in] dy  Vertical distance in pixels.
+		///
+		void scrollContentsBy(int dx, int dy);
+
+		///
+		/// \brief Draws the background of the Scene and, if enabled, the tiles of the TileCache.
+		///
+		/// \param [in] painter Painter in scene coordinates.
+		/// \param [in] rect    Exposed area in scene coordinates.
+		///
+		void drawBackground(QPainter *painter, const QRectF &rect);
+
+	private: // methods
+
+		///
+		/// \brief Reports the current zoom factor to the ClusterLayer of the Scene.
+		///
+		void updateClusterZoom();
+
+		///
+		/// \brief Reports the visible rectangle in scene coordinates to the ViewportLayer of the Scene.
+		///
+		void updateVisibleRect();
+
 	private: // members
 
 		///
@@ -251,6 +403,11 @@ namespace zodiac
 		///
 		qreal m_zoomFactor;
 
+		///
+		/// \brief Cached tiles of the static content of the Scene.
+		///
+		TileCache *m_tileCache;
+
 	private: // static members
 
 		///
@@ -293,6 +450,16 @@ namespace zodiac
 		///
 		static qreal s_maxZoomFactor;
 
+		///
+		/// \brief Smallest size in pixels at which text and EdgeArrow%s are drawn.
+		///
+		static qreal s_minReadableSize;
+
+		///
+		/// \brief Smallest Node core radius in pixels at which Node%s and PlugEdge%s are drawn in detail.
+		///
+		static qreal s_minDetailSize;
+
 	};
 
 } // namespace zodiac
@@ -0,0 +1,277 @@
+#include "viewportlayer.h"
+
+#include "clusterlayer.h"
+#include "graphstore.h"
+#include "node.h"
+#include "plug.h"
+#include "plugedge.h"
+#include "scene.h"
+#include "straightedge.h"
+
+static QRectF grownBy(const QRectF &rect, qreal fraction);
+
+namespace zodiac
+{
+
+	ViewportLayer::ViewportLayer(Scene *scene)
+			: QObject(scene), m_scene(scene), m_isEnabled(false), m_margin(0.5), m_farNodeLimit(256),
+			  m_visibleRect(QRectF()),
+			  m_isUpdatePending(false), m_activeNodes(QSet<SlotId>()), m_realizedNodes(QSet<SlotId>()),
+			  m_detachedNodes(QSet<Node *>()), m_detachedEdges(QSet<BaseEdge *>())
+	{
+	}
+
+	void ViewportLayer::setEnabled(bool enabled)
+	{
+		if (enabled == m_isEnabled)
+		{
+			return;
+		}
+		m_isEnabled = enabled;
+		if (m_isEnabled)
+		{
+			// all existing nodes are attached
+			for (Node *node: m_scene->getNodes())
+			{
+				m_activeNodes.insert(node->getGraphId());
+			}
+			scheduleUpdate();
+			return;
+		}
+		m_activeNodes.clear();
+		m_realizedNodes.clear();
+
+		// put everything back
+		for (BaseEdge *edge: m_detachedEdges)
+		{
+			m_scene->attachEdge(edge);
+		}
+		m_detachedEdges.clear();
+		for (Node *node: m_detachedNodes)
+		{
+			m_scene->attachNode(node);
+		}
+		m_detachedNodes.clear();
+	}
+
+	void ViewportLayer::setMargin(qreal margin)
+	{
+		m_margin = qMax(0., margin);
+		scheduleUpdate();
+	}
+
+	void ViewportLayer::setFarNodeLimit(int limit)
+	{
+		m_farNodeLimit = qMax(0, limit);
+		scheduleUpdate();
+	}
+
+	void ViewportLayer::setVisibleRect(const QRectF &rect)
+	{
+		m_visibleRect = rect;
+		scheduleUpdate();
+	}
+
+	void ViewportLayer::scheduleUpdate()
+	{
+		if (!m_isEnabled || m_isUpdatePending)
+		{
+			return;
+		}
+		m_isUpdatePending = true;
+		QMetaObject::invokeMethod(this, "update", Qt::QueuedConnection);
+	}
+
+	void ViewportLayer::registerNode(Node *node)
+	{
+		if (m_isEnabled)
+		{
+			m_activeNodes.insert(node->getGraphId());
+		}
+	}
+
+	void ViewportLayer::forgetNode(Node *node)
+	{
+		m_activeNodes.remove(node->getGraphId());
+		m_realizedNodes.remove(node->getGraphId());
+		m_detachedNodes.remove(node);
+	}
+
+	void ViewportLayer::forgetEdge(BaseEdge *edge)
+	{
+		m_detachedEdges.remove(edge);
+	}
+
+	void ViewportLayer::update()
+	{
+		m_isUpdatePending = false;
+		if (!m_isEnabled || m_visibleRect.isEmpty() || m_scene->getClusterLayer()->isCollapsed())
+		{
+			return;
+		}
+
+		// realize or attach nodes entering the margin, release or detach those leaving twice the margin
+		QSet<SlotId> wantedNodes = getNodesAround(grownBy(m_visibleRect, m_margin), m_farNodeLimit);
+		QSet<SlotId> keptNodes = getNodesAround(grownBy(m_visibleRect, m_margin * 2.), -1);
+
+		// realizing and releasing nodes would schedule another update
+		m_isUpdatePending = true;
+		m_scene->beginBatch();
+		QList<Node *> changedNodes;
+		for (const SlotId &nodeId: wantedNodes)
+		{
+			if (m_activeNodes.contains(nodeId))
+			{
+				continue;
+			}
+			Node *node = m_scene->getNode(nodeId);
+			if (!node)
+			{
+				m_scene->realizeNode(nodeId);
+				m_realizedNodes.insert(nodeId);
+			} else if (m_detachedNodes.remove(node))
+			{
+				m_scene->attachNode(node);
+				changedNodes.append(node);
+			}
+			m_activeNodes.insert(nodeId);
+		}
+
+		// only the nodes in view are visited, not the whole graph
+		QList<SlotId> leavingNodes;
+		for (const SlotId &nodeId: m_activeNodes)
+		{
+			if (!keptNodes.contains(nodeId))
+			{
+				leavingNodes.append(nodeId);
+			}
+		}
+		for (const SlotId &nodeId: leavingNodes)
+		{
+			m_activeNodes.remove(nodeId);
+			Node *node = m_scene->getNode(nodeId);
+			if (m_realizedNodes.contains(nodeId) && !node->isSelected())
+			{
+				m_realizedNodes.remove(nodeId);
+				m_scene->releaseNode(node);
+			} else
+			{
+				m_detachedNodes.insert(node);
+				m_scene->detachNode(node);
+				changedNodes.append(node);
+			}
+		}
+		m_scene->endBatch();
+		m_isUpdatePending = false;
+
+		updateEdges(changedNodes);
+	}
+
+	void ViewportLayer::updateEdges(const QList<Node *> &nodes)
+	{
+		// collect every edge of the changed nodes once
+		const GraphStore &graph = m_scene->getGraph();
+		QSet<PlugEdge *> plugEdges;
+		QSet<StraightEdge *> straightEdges;
+		for (Node *node: nodes)
+		{
+			for (const SlotId &plugId: graph.getNodePlugs(node->getGraphId()))
+			{
+				for (const SlotId &edgeId: graph.getPlugEdges(plugId))
+				{
+					PlugEdge *edge = m_scene->getEdge(edgeId);
+					if (edge)
+					{
+						plugEdges.insert(edge);
+					}
+				}
+			}
+			for (StraightEdge *edge: node->getStraightEdges())
+			{
+				straightEdges.insert(edge);
+			}
+		}
+
+		// an edge is only detached, if it does not touch any attached node
+		QList<QPair<BaseEdge *, bool> > edgeStates;
+		for (PlugEdge *edge: plugEdges)
+		{
+			edgeStates.append(qMakePair<BaseEdge *, bool>(edge, m_detachedNodes.contains(edge->getStartPlug()->getNode())
+			                                                    && m_detachedNodes.contains(edge->getEndPlug()->getNode())));
+		}
+		for (StraightEdge *edge: straightEdges)
+		{
+			edgeStates.append(qMakePair<BaseEdge *, bool>(edge, m_detachedNodes.contains(edge->getFromNode())
+			                                                    && m_detachedNodes.contains(edge->getToNode())));
+		}
+		for (const QPair<BaseEdge *, bool> &edgeState: edgeStates)
+		{
+			BaseEdge *edge = edgeState.first;
+			bool isDetached = m_detachedEdges.contains(edge);
+			if (edgeState.second && !isDetached)
+			{
+				m_detachedEdges.insert(edge);
+				m_scene->detachEdge(edge);
+			} else if (!edgeState.second && isDetached)
+			{
+				m_detachedEdges.remove(edge);
+				m_scene->attachEdge(edge);
+			}
+		}
+	}
+
+	QSet<SlotId> ViewportLayer::getNodesAround(const QRectF &rect, int farNodeLimit) const
+	{
+		const GraphStore &graph = m_scene->getGraph();
+		QSet<SlotId> result;
+		for (const SlotId &nodeId: graph.getNodesIn(rect))
+		{
+			result.insert(nodeId);
+		}
+
+		// edges crossing the rectangle need both of their ends, no matter how far away those are
+		int farNodeCount = 0;
+		for (const SlotId &edgeId: graph.getEdgesIn(rect))
+		{
+			for (const SlotId &nodeId: {graph.getPlugNode(graph.getEdgeFrom(edgeId)),
+			                            graph.getPlugNode(graph.getEdgeTo(edgeId))})
+			{
+				if (result.contains(nodeId))
+				{
+					continue;
+				}
+				if (!m_activeNodes.contains(nodeId))
+				{
+					if ((farNodeLimit >= 0) && (farNodeCount >= farNodeLimit))
+					{
+						continue;
+					}
+					++farNodeCount;
+				}
+				result.insert(nodeId);
+			}
+		}
+		return result;
+	}
+
+} // namespace zodiac
+
+///////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// HELPER
+//
+
+///
+/// \brief Grows a rectangle on every side by a fraction of its size.
+///
+/// \param rect        Rectangle to grow.
+/// \param fraction    Fraction of the width and height to add to every side.
+///
+/// \return            Grown rectangle.
+///
+static QRectF grownBy(const QRectF &rect, qreal fraction)
+{
+	qreal horizontal = rect.width() * fraction;
+	qreal vertical = rect.height() * fraction;
+	return rect.marginsAdded(QMarginsF(horizontal, vertical, horizontal, vertical));
+}
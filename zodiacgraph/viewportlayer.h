@@ -0,0 +1,261 @@
+//
+//    ZodiacGraph - A general-purpose, circular node graph UI module.
+//    Copyright (C) 2015  Clemens Sielaff
+//
+//    The MIT License
+//
+//    Permission is hereby granted, free of charge, to any person obtaining a copy of
+//    this software and associated documentation files (the "Software"), to deal in
+//    the Software without restriction, including without limitation the rights to
+//    use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+//    of the Software, and to permit persons to whom the Software is furnished to do so,
+//    subject to the following conditions:
+//
+//    The above copyright notice and this permission notice shall be included in all
+//    copies or substantial portions of the Software.
+//
+//    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+//    SOFTWARE.
+//
+
+#ifndef ZODIAC_VIEWPORTLAYER_H
+#define ZODIAC_VIEWPORTLAYER_H
+
+///
+/// \file viewportlayer.h
+///
+/// \brief Contains the definition of the zodiac::ViewportLayer class.
+///
+
+#include <QObject>
+#include <QRectF>
+#include <QSet>
+#include <QtGlobal>
+
+#include "slotmap.h"
+
+namespace zodiac
+{
+
+	class BaseEdge;
+
+	class Node;
+
+	class Scene;
+
+///
+/// \brief Virtualization of the Scene, only keeps the items around the visible area of the View in the Scene.
+///
+/// With every update, the GraphStore is queried for the nodes and edges around the visible rectangle.
+/// Nodes coming into view are realized with Scene::realizeNode(), if they have no items yet.
+/// Edges crossing the view get both of their ends as well, even if those lie far outside of it, so long edges do not
+/// vanish from the view.
+/// The number of such far nodes is capped, so a hub outside of the view only pulls in the nodes of the edges that
+/// actually cross it, never its whole neighbourhood.
+/// Nodes realized by the ViewportLayer are released with Scene::releaseNode() once they are further than the margin
+/// outside of the visible rectangle, so the number of items follows the size of the viewport, not the size of the
+/// graph.
+/// Only the Node%s that are currently in view are visited, not all nodes of the graph.
+///
+/// Node%s created with Scene::createNode() or realized by the user, as well as selected Node%s, are only detached
+/// from the Scene instead, because pointers to them may still be held elsewhere.
+/// Detached Node%s remain fully functional: they keep their Plug%s, edges and selection state, and the complete
+/// topology can still be queried through the GraphStore and the Scene.
+/// Edges are detached along with their Node%s, if they have no attached Node at either end.
+///
+/// While the ClusterLayer is collapsed, its aggregates stand in for the Node%s and the ViewportLayer does nothing.
+///
+/// The ViewportLayer is disabled by default.
+///
+	class Q_DECL_EXPORT ViewportLayer : public QObject
+	{
+	Q_OBJECT
+
+	public: // methods
+
+		///
+		/// \brief Constructor.
+		///
+		/// \param [in] scene   Scene to virtualize, is also the Qt parent of this ViewportLayer.
+		///
+		explicit ViewportLayer(Scene *scene);
+
+		///
+		/// \brief Enables or disables the virtualization.
+		///
+		/// Disabling the virtualization attaches all detached items again, the Node%s realized by the ViewportLayer
+		/// keep their items.
+		///
+		/// \param [in] enabled <i>true</i> to enable the virtualization -- <i>false</i> to disable it.
+		///
+		void setEnabled(bool enabled);
+
+		///
+		/// \brief Tests whether the virtualization is enabled.
+		///
+		/// \return <i>true</i> if the virtualization is enabled -- <i>false</i> otherwise.
+		///
+		inline bool isEnabled() const { return m_isEnabled; }
+
+		///
+		/// \brief Sets the margin around the visible rectangle, in which items are kept in the Scene.
+		///
+		/// Items are attached when they enter the margin and only detached again after leaving twice the margin, so
+		/// panning back and forth does not repeatedly attach and detach the same items.
+		///
+		/// \param [in] margin  New margin as a fraction of the size of the visible rectangle.
+		///
+		void setMargin(qreal margin);
+
+		///
+		/// \brief The margin around the visible rectangle, in which items are kept in the Scene.
+		///
+		/// \return Margin as a fraction of the size of the visible rectangle.
+		///
+		inline qreal getMargin() const { return m_margin; }
+
+		///
+		/// \brief Sets how many Node%s outside of the margin are realized for the edges crossing it.
+		///
+		/// Edges whose far ends are over the limit are not shown until one of their ends comes into view.
+		///
+		/// \param [in] limit   Maximum number of far Node%s.
+		///
+		void setFarNodeLimit(int limit);
+
+		///
+		/// \brief How many Node%s outside of the margin are realized for the edges crossing it.
+		///
+		/// \return Maximum number of far Node%s.
+		///
+		inline int getFarNodeLimit() const { return m_farNodeLimit; }
+
+		///
+		/// \brief Is called by a View whenever the visible part of the Scene changes.
+		///
+		/// The items are updated once, the next time control returns to the event loop.
+		/// If the Scene is shown in several View%s, the last visible rectangle reported wins.
+		///
+		/// \param [in] rect    Visible rectangle in scene coordinates.
+		///
+		void setVisibleRect(const QRectF &rect);
+
+		///
+		/// \brief Schedules a call to update(), for example after Node%s were created or moved.
+		///
+		void scheduleUpdate();
+
+		///
+		/// \brief Must be called by the Scene after a Node was created or realized.
+		///
+		/// \param [in] node    Node that was added to the Scene.
+		///
+		void registerNode(Node *node);
+
+		///
+		/// \brief Must be called by the Scene before a Node is deleted.
+		///
+		/// \param [in] node    Node that is about to be deleted.
+		///
+		void forgetNode(Node *node);
+
+		///
+		/// \brief Must be called by the Scene before an edge is deleted.
+		///
+		/// \param [in] edge    Edge that is about to be deleted.
+		///
+		void forgetEdge(BaseEdge *edge);
+
+	public slots:
+
+		///
+		/// \brief Realizes or attaches the Node%s that came into view and releases or detaches those that left it.
+		///
+		void update();
+
+	private: // methods
+
+		///
+		/// \brief Attaches or detaches the edges of Node%s that were attached or detached.
+		///
+		/// An edge is detached, if both of its ends are detached.
+		///
+		/// \param [in] nodes   Node%s that were attached or detached.
+		///
+		void updateEdges(const QList<Node *> &nodes);
+
+		///
+		/// \brief Finds the nodes around a rectangle in the GraphStore, along with the ends of all edges crossing it.
+		///
+		/// Far ends that are already active do not count towards the limit, so they are never dropped for new ones.
+		///
+		/// \param [in] rect            Rectangle in scene coordinates.
+		/// \param [in] farNodeLimit    Maximum number of new nodes outside of the rectangle, -1 for no limit.
+		///
+		/// \return                     Ids of the nodes intersecting the rectangle and of the far ends of the edges
+		///                             crossing it.
+		///
+		QSet<SlotId> getNodesAround(const QRectF &rect, int farNodeLimit) const;
+
+	private: // members
+
+		///
+		/// \brief Scene to virtualize.
+		///
+		Scene *m_scene;
+
+		///
+		/// \brief Whether the virtualization is enabled.
+		///
+		bool m_isEnabled;
+
+		///
+		/// \brief Margin around the visible rectangle as a fraction of its size.
+		///
+		qreal m_margin;
+
+		///
+		/// \brief Maximum number of Node%s outside of the margin realized for the edges crossing it.
+		///
+		int m_farNodeLimit;
+
+		///
+		/// \brief Visible rectangle in scene coordinates, last reported by a View.
+		///
+		QRectF m_visibleRect;
+
+		///
+		/// \brief Whether a call to update() is pending.
+		///
+		bool m_isUpdatePending;
+
+		///
+		/// \brief Ids of the attached Node%s that are released or detached once they leave the view.
+		///
+		QSet<SlotId> m_activeNodes;
+
+		///
+		/// \brief Ids of the Node%s realized by the ViewportLayer, which are released instead of detached.
+		///
+		QSet<SlotId> m_realizedNodes;
+
+		///
+		/// \brief Node%s detached by the ViewportLayer.
+		///
+		QSet<Node *> m_detachedNodes;
+
+		///
+		/// \brief Edges detached by the ViewportLayer.
+		///
+		QSet<BaseEdge *> m_detachedEdges;
+
+	};
+
+} // namespace zodiac
+
+#endif // ZODIAC_VIEWPORTLAYER_H